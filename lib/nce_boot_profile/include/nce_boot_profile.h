@@ -0,0 +1,104 @@
+/******************************************************************************
+ * @file    nce_boot_profile.h
+ * @brief   Boot-to-first-uplink latency profile.
+ * @details Each startup phase is stamped once per boot with the uptime at
+ *          which it completed. Modem initialization, LTE attach and L4
+ *          connectivity are stamped by the library itself; DNS, the DTLS
+ *          handshake and the first delivered uplink are stamped by the
+ *          application with nce_boot_profile_mark().
+ *
+ *          The record lives in RAM that is not cleared on a warm reset, so
+ *          the profile of the previous boot, for example one that ended in a
+ *          fault or a watchdog reset, is still available after it.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_BOOT_PROFILE_H__
+#define NCE_BOOT_PROFILE_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Startup phases, in the order they normally complete. */
+enum nce_boot_phase
+{
+    NCE_BOOT_PHASE_KERNEL,       /**< Kernel services up, stamped by the library. */
+    NCE_BOOT_PHASE_MODEM_INIT,   /**< Modem library initialized, stamped by the library. */
+    NCE_BOOT_PHASE_LTE_ATTACH,   /**< Registered to the network, stamped by the library. */
+    NCE_BOOT_PHASE_L4_UP,        /**< IP connectivity reported by conn_mgr, stamped by the library. */
+    NCE_BOOT_PHASE_DNS,          /**< Server address resolved. */
+    NCE_BOOT_PHASE_DTLS,         /**< DTLS handshake completed. */
+    NCE_BOOT_PHASE_FIRST_UPLINK, /**< First uplink acknowledged, or sent where nothing is acknowledged. */
+    NCE_BOOT_PHASE_COUNT
+};
+
+/** @brief Profile of one boot. */
+struct nce_boot_profile
+{
+    uint32_t boot_count;                        /**< Boots since the record was last lost. */
+    uint32_t phases;                            /**< Bit mask of the stamped phases. */
+    uint32_t uptime_ms[ NCE_BOOT_PHASE_COUNT ]; /**< Uptime at which each phase completed. */
+};
+
+/** @brief Size of the largest record written by nce_boot_profile_encode(). */
+#define NCE_BOOT_PROFILE_RECORD_MAX_SIZE    ( 4 + 4 * NCE_BOOT_PHASE_COUNT )
+
+/**
+ * @brief Stamp a phase of the current boot.
+ *
+ * Only the first call per phase and boot is recorded, later calls return
+ * at once. Stamping NCE_BOOT_PHASE_FIRST_UPLINK logs the profile.
+ *
+ * @param[in] phase Completed phase.
+ */
+void nce_boot_profile_mark( enum nce_boot_phase phase );
+
+/**
+ * @brief Read a profile.
+ *
+ * @param[in]  previous false for the current boot, true for the boot before it.
+ * @param[out] profile  Copy of the profile.
+ *
+ * @return true if the profile exists, false if the previous boot was not
+ *         recorded (power-on reset or first boot).
+ */
+bool nce_boot_profile_get( bool previous,
+                           struct nce_boot_profile * profile );
+
+/**
+ * @brief Encode a profile as a compact binary record.
+ *
+ * The record is a version byte (1), the boot count as big-endian uint16,
+ * the phase mask byte, then the uptime in milliseconds of every stamped
+ * phase as big-endian uint32, in phase order.
+ *
+ * @param[in]  profile Profile to encode.
+ * @param[out] buffer  Destination buffer.
+ * @param[in]  size    Size of the destination buffer.
+ *
+ * @return Record length in bytes, -ENOMEM if the buffer is too small.
+ */
+int nce_boot_profile_encode( const struct nce_boot_profile * profile,
+                             uint8_t * buffer,
+                             size_t size );
+
+/**
+ * @brief Name of a phase, for logs.
+ */
+const char * nce_boot_profile_phase_name( enum nce_boot_phase phase );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_BOOT_PROFILE_H__ */
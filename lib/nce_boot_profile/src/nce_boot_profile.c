@@ -0,0 +1,334 @@
+/******************************************************************************
+ * @file    nce_boot_profile.c
+ * @brief   Boot-to-first-uplink latency profile.
+ * @details See nce_boot_profile.h. The retained record is checked with a
+ *          magic word and a CRC on every boot, so a power-on reset with
+ *          random RAM contents starts a new record instead of reporting
+ *          garbage.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/sys/crc.h>
+#if defined( CONFIG_NRF_MODEM_LIB )
+    #include <modem/nrf_modem_lib.h>
+#endif /* if defined( CONFIG_NRF_MODEM_LIB ) */
+#if defined( CONFIG_LTE_LINK_CONTROL )
+    #include <modem/lte_lc.h>
+#endif /* if defined( CONFIG_LTE_LINK_CONTROL ) */
+#if defined( CONFIG_NET_CONNECTION_MANAGER )
+    #include <zephyr/net/net_mgmt.h>
+    #include <zephyr/net/conn_mgr_monitor.h>
+#endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+#include <nce_boot_profile.h>
+
+LOG_MODULE_REGISTER( nce_boot_profile, CONFIG_NCE_BOOT_PROFILE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define BOOT_PROFILE_MAGIC      0x4e424f54 /* "NBOT" */
+#define BOOT_PROFILE_VERSION    1
+
+/** @brief Record kept across warm resets. */
+struct boot_profile_retained
+{
+    uint32_t magic;
+    struct nce_boot_profile current;
+    struct nce_boot_profile previous;
+    bool has_previous;
+    uint32_t crc;
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct boot_profile_retained retained __noinit;
+static struct k_spinlock lock;
+
+static const char * const phase_names[ NCE_BOOT_PHASE_COUNT ] =
+{
+    [ NCE_BOOT_PHASE_KERNEL ]       = "kernel",
+    [ NCE_BOOT_PHASE_MODEM_INIT ]   = "modem init",
+    [ NCE_BOOT_PHASE_LTE_ATTACH ]   = "lte attach",
+    [ NCE_BOOT_PHASE_L4_UP ]        = "l4 up",
+    [ NCE_BOOT_PHASE_DNS ]          = "dns",
+    [ NCE_BOOT_PHASE_DTLS ]         = "dtls",
+    [ NCE_BOOT_PHASE_FIRST_UPLINK ] = "first uplink",
+};
+
+#if defined( CONFIG_NET_CONNECTION_MANAGER )
+static struct net_mgmt_event_callback l4_cb;
+#endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static uint32_t prv_crc( void )
+{
+    return crc32_ieee( ( const uint8_t * ) &retained, offsetof( struct boot_profile_retained, crc ) );
+}
+
+/** @brief Print a profile with the time spent since the previous stamped phase. */
+static void prv_print( const struct nce_boot_profile * profile,
+                       void (* print)( void * ctx,
+                                       const char * name,
+                                       uint32_t at_ms,
+                                       uint32_t delta_ms ),
+                       void * ctx )
+{
+    uint32_t last_ms = 0;
+
+    for( int i = 0; i < NCE_BOOT_PHASE_COUNT; i++ )
+    {
+        if( profile->phases & BIT( i ) )
+        {
+            print( ctx, phase_names[ i ], profile->uptime_ms[ i ], profile->uptime_ms[ i ] - last_ms );
+            last_ms = profile->uptime_ms[ i ];
+        }
+    }
+}
+
+static void prv_log_phase( void * ctx,
+                           const char * name,
+                           uint32_t at_ms,
+                           uint32_t delta_ms )
+{
+    ARG_UNUSED( ctx );
+
+    LOG_INF( "  %-12s at %6u ms (+%u ms)", name, at_ms, delta_ms );
+}
+
+#if defined( CONFIG_NRF_MODEM_LIB )
+static void prv_modem_init_cb( int ret,
+                               void * ctx )
+{
+    ARG_UNUSED( ctx );
+
+    if( ret == 0 )
+    {
+        nce_boot_profile_mark( NCE_BOOT_PHASE_MODEM_INIT );
+    }
+}
+
+NRF_MODEM_LIB_ON_INIT( nce_boot_profile_modem, prv_modem_init_cb, NULL );
+#endif /* if defined( CONFIG_NRF_MODEM_LIB ) */
+
+#if defined( CONFIG_LTE_LINK_CONTROL )
+static void prv_lte_handler( const struct lte_lc_evt * const evt )
+{
+    if( ( evt->type == LTE_LC_EVT_NW_REG_STATUS ) &&
+        ( ( evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_HOME ) ||
+          ( evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_ROAMING ) ) )
+    {
+        nce_boot_profile_mark( NCE_BOOT_PHASE_LTE_ATTACH );
+    }
+}
+#endif /* if defined( CONFIG_LTE_LINK_CONTROL ) */
+
+#if defined( CONFIG_NET_CONNECTION_MANAGER )
+static void prv_l4_handler( struct net_mgmt_event_callback * cb,
+                            uint32_t event,
+                            struct net_if * iface )
+{
+    ARG_UNUSED( cb );
+    ARG_UNUSED( iface );
+
+    if( event == NET_EVENT_L4_CONNECTED )
+    {
+        nce_boot_profile_mark( NCE_BOOT_PHASE_L4_UP );
+    }
+}
+#endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+/** @brief Keep the last boot's record and start a new one, before anything is stamped. */
+static int prv_boot_profile_init( void )
+{
+    uint32_t boot_count = 1;
+
+    if( ( retained.magic == BOOT_PROFILE_MAGIC ) && ( retained.crc == prv_crc() ) )
+    {
+        retained.previous = retained.current;
+        retained.has_previous = true;
+        boot_count = retained.current.boot_count + 1;
+    }
+    else
+    {
+        memset( &retained, 0, sizeof( retained ) );
+        retained.magic = BOOT_PROFILE_MAGIC;
+    }
+
+    memset( &retained.current, 0, sizeof( retained.current ) );
+    retained.current.boot_count = boot_count;
+    retained.crc = prv_crc();
+
+    nce_boot_profile_mark( NCE_BOOT_PHASE_KERNEL );
+
+    return 0;
+}
+
+SYS_INIT( prv_boot_profile_init, POST_KERNEL, 0 );
+
+/** @brief Hook into the link controller and conn_mgr once they accept handlers. */
+static int prv_boot_profile_hooks_init( void )
+{
+    #if defined( CONFIG_LTE_LINK_CONTROL )
+    lte_lc_register_handler( prv_lte_handler );
+    #endif /* if defined( CONFIG_LTE_LINK_CONTROL ) */
+
+    #if defined( CONFIG_NET_CONNECTION_MANAGER )
+    net_mgmt_init_event_callback( &l4_cb, prv_l4_handler, NET_EVENT_L4_CONNECTED );
+    net_mgmt_add_event_callback( &l4_cb );
+    #endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+    return 0;
+}
+
+SYS_INIT( prv_boot_profile_hooks_init, APPLICATION, 0 );
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_boot_profile_mark( enum nce_boot_phase phase )
+{
+    struct nce_boot_profile profile;
+    k_spinlock_key_t key;
+
+    if( phase >= NCE_BOOT_PHASE_COUNT )
+    {
+        return;
+    }
+
+    key = k_spin_lock( &lock );
+
+    if( retained.current.phases & BIT( phase ) )
+    {
+        k_spin_unlock( &lock, key );
+        return;
+    }
+
+    retained.current.uptime_ms[ phase ] = ( uint32_t ) k_uptime_get();
+    retained.current.phases |= BIT( phase );
+    retained.crc = prv_crc();
+    profile = retained.current;
+
+    k_spin_unlock( &lock, key );
+
+    if( phase == NCE_BOOT_PHASE_FIRST_UPLINK )
+    {
+        LOG_INF( "Boot %u reached the first uplink after %u ms:", profile.boot_count,
+                 profile.uptime_ms[ NCE_BOOT_PHASE_FIRST_UPLINK ] );
+        prv_print( &profile, prv_log_phase, NULL );
+    }
+}
+
+bool nce_boot_profile_get( bool previous,
+                           struct nce_boot_profile * profile )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    bool found = !previous || retained.has_previous;
+
+    if( found )
+    {
+        *profile = previous ? retained.previous : retained.current;
+    }
+
+    k_spin_unlock( &lock, key );
+
+    return found;
+}
+
+int nce_boot_profile_encode( const struct nce_boot_profile * profile,
+                             uint8_t * buffer,
+                             size_t size )
+{
+    size_t len = 4;
+
+    if( size < len )
+    {
+        return -ENOMEM;
+    }
+
+    buffer[ 0 ] = BOOT_PROFILE_VERSION;
+    sys_put_be16( ( uint16_t ) MIN( profile->boot_count, UINT16_MAX ), &buffer[ 1 ] );
+    buffer[ 3 ] = ( uint8_t ) profile->phases;
+
+    for( int i = 0; i < NCE_BOOT_PHASE_COUNT; i++ )
+    {
+        if( profile->phases & BIT( i ) )
+        {
+            if( size < len + sizeof( uint32_t ) )
+            {
+                return -ENOMEM;
+            }
+
+            sys_put_be32( profile->uptime_ms[ i ], &buffer[ len ] );
+            len += sizeof( uint32_t );
+        }
+    }
+
+    return ( int ) len;
+}
+
+const char * nce_boot_profile_phase_name( enum nce_boot_phase phase )
+{
+    return ( phase < NCE_BOOT_PHASE_COUNT ) ? phase_names[ phase ] : "unknown";
+}
+
+#if defined( CONFIG_NCE_BOOT_PROFILE_SHELL )
+static void prv_shell_phase( void * ctx,
+                             const char * name,
+                             uint32_t at_ms,
+                             uint32_t delta_ms )
+{
+    shell_print( ( const struct shell * ) ctx, "  %-12s at %6u ms (+%u ms)", name, at_ms, delta_ms );
+}
+
+static int cmd_boot_profile_show( const struct shell * sh,
+                                  size_t argc,
+                                  char ** argv )
+{
+    struct nce_boot_profile profile;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    ( void ) nce_boot_profile_get( false, &profile );
+    shell_print( sh, "current boot (%u):", profile.boot_count );
+    prv_print( &profile, prv_shell_phase, ( void * ) sh );
+
+    if( nce_boot_profile_get( true, &profile ) )
+    {
+        shell_print( sh, "previous boot (%u):", profile.boot_count );
+        prv_print( &profile, prv_shell_phase, ( void * ) sh );
+    }
+    else
+    {
+        shell_print( sh, "previous boot: not recorded" );
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_boot_profile,
+                                SHELL_CMD( show, NULL, "Show the startup phases of this and the previous boot",
+                                           cmd_boot_profile_show ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( boot_profile, &sub_boot_profile, "Boot-to-first-uplink profile", NULL );
+#endif /* if defined( CONFIG_NCE_BOOT_PROFILE_SHELL ) */
@@ -0,0 +1,67 @@
+/******************************************************************************
+ * @file    nce_coap_buf_pool.h
+ * @brief   Fixed-size CoAP message buffer pool.
+ * @details Buffers of CONFIG_NCE_COAP_BUF_POOL_BLOCK_SIZE bytes are taken from
+ *          a statically sized k_mem_slab, so building or acknowledging a CoAP
+ *          message never touches the system heap. Usage is tracked with
+ *          allocation, failure and high-water-mark counters.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_COAP_BUF_POOL_H__
+#define NCE_COAP_BUF_POOL_H__
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Size of every buffer handed out by the pool. */
+#define NCE_COAP_BUF_SIZE    CONFIG_NCE_COAP_BUF_POOL_BLOCK_SIZE
+
+/**
+ * @brief Pool usage counters.
+ */
+struct nce_coap_buf_pool_stats
+{
+    uint32_t allocs;     /**< Successful allocations since boot. */
+    uint32_t failures;   /**< Allocations that timed out on an empty pool. */
+    uint32_t in_use;     /**< Buffers currently allocated. */
+    uint32_t high_water; /**< Maximum number of buffers allocated at once. */
+};
+
+/**
+ * @brief Take a buffer of NCE_COAP_BUF_SIZE bytes from the pool.
+ *
+ * @param[in] timeout How long to wait for a buffer if the pool is empty.
+ *
+ * @return Buffer, or NULL if none became available in time.
+ */
+uint8_t * nce_coap_buf_alloc( k_timeout_t timeout );
+
+/**
+ * @brief Return a buffer to the pool.
+ *
+ * @param[in] buf Buffer from nce_coap_buf_alloc(), NULL is ignored.
+ */
+void nce_coap_buf_free( uint8_t * buf );
+
+/**
+ * @brief Read the pool usage counters.
+ *
+ * @param[out] stats Counters snapshot.
+ */
+void nce_coap_buf_pool_stats_get( struct nce_coap_buf_pool_stats * stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_COAP_BUF_POOL_H__ */
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * @file    nce_coap_buf_pool.c
+ * @brief   Fixed-size CoAP message buffer pool.
+ * @details See nce_coap_buf_pool.h.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+
+#include <nce_coap_buf_pool.h>
+
+LOG_MODULE_REGISTER( nce_coap_buf_pool, CONFIG_NCE_COAP_BUF_POOL_LOG_LEVEL );
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+K_MEM_SLAB_DEFINE_STATIC( coap_buf_slab, CONFIG_NCE_COAP_BUF_POOL_BLOCK_SIZE,
+                          CONFIG_NCE_COAP_BUF_POOL_BLOCK_COUNT, 4 );
+
+static struct k_spinlock stats_lock;
+static struct nce_coap_buf_pool_stats pool_stats;
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+uint8_t * nce_coap_buf_alloc( k_timeout_t timeout )
+{
+    void * block;
+    k_spinlock_key_t key;
+    int err = k_mem_slab_alloc( &coap_buf_slab, &block, timeout );
+
+    key = k_spin_lock( &stats_lock );
+
+    if( err )
+    {
+        pool_stats.failures++;
+        k_spin_unlock( &stats_lock, key );
+        LOG_WRN( "CoAP buffer pool exhausted (%d buffers)", CONFIG_NCE_COAP_BUF_POOL_BLOCK_COUNT );
+        return NULL;
+    }
+
+    pool_stats.allocs++;
+    pool_stats.in_use++;
+
+    if( pool_stats.in_use > pool_stats.high_water )
+    {
+        pool_stats.high_water = pool_stats.in_use;
+    }
+
+    k_spin_unlock( &stats_lock, key );
+
+    return block;
+}
+
+void nce_coap_buf_free( uint8_t * buf )
+{
+    k_spinlock_key_t key;
+
+    if( buf == NULL )
+    {
+        return;
+    }
+
+    k_mem_slab_free( &coap_buf_slab, ( void * ) buf );
+
+    key = k_spin_lock( &stats_lock );
+    pool_stats.in_use--;
+    k_spin_unlock( &stats_lock, key );
+}
+
+void nce_coap_buf_pool_stats_get( struct nce_coap_buf_pool_stats * stats )
+{
+    k_spinlock_key_t key = k_spin_lock( &stats_lock );
+
+    *stats = pool_stats;
+    k_spin_unlock( &stats_lock, key );
+}
+
+#if defined( CONFIG_NCE_COAP_BUF_POOL_SHELL )
+static int cmd_coap_pool_stats( const struct shell * sh,
+                                size_t argc,
+                                char ** argv )
+{
+    struct nce_coap_buf_pool_stats stats;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    nce_coap_buf_pool_stats_get( &stats );
+
+    shell_print( sh, "block size:  %d", CONFIG_NCE_COAP_BUF_POOL_BLOCK_SIZE );
+    shell_print( sh, "blocks:      %d", CONFIG_NCE_COAP_BUF_POOL_BLOCK_COUNT );
+    shell_print( sh, "in use:      %u", stats.in_use );
+    shell_print( sh, "high water:  %u", stats.high_water );
+    shell_print( sh, "allocations: %u", stats.allocs );
+    shell_print( sh, "failures:    %u", stats.failures );
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_coap_pool,
+                                SHELL_CMD( stats, NULL, "Show CoAP buffer pool usage", cmd_coap_pool_stats ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( coap_pool, &sub_coap_pool, "CoAP buffer pool", NULL );
+#endif /* if defined( CONFIG_NCE_COAP_BUF_POOL_SHELL ) */
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * @file    nce_coap_rto.h
+ * @brief   Adaptive CoAP retransmission timeout (CoCoA).
+ * @details Every destination keeps its own estimator state. Before a
+ *          confirmable request, nce_coap_rto_params() fills the transmission
+ *          parameters with the current timeout; after its response,
+ *          nce_coap_rto_sample() reports the round trip measured from the
+ *          first transmission.
+ *
+ *          As in CoCoA (draft-ietf-core-cocoa), a round trip shorter than
+ *          the initial timeout had no retransmission and feeds the strong
+ *          estimator (RFC 6298, K = 4). One that may have seen one or two
+ *          retransmissions feeds the weak estimator (K = 1), later ones are
+ *          ambiguous and dropped. The overall timeout moves halfway to a new
+ *          strong estimate and a quarter of the way to a new weak estimate.
+ *          The backoff factor is 3 below 1 s, 1.5 above 3 s and 2 otherwise.
+ *          An estimate below 1 s that was not refreshed for 16 times its
+ *          value is doubled, one above 3 s that was not refreshed for 4 times
+ *          its value moves towards 1 s. The CoAP stack dithers the initial
+ *          timeout within its ACK random factor on top.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_COAP_RTO_H__
+#define NCE_COAP_RTO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/coap.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Statistics of one destination since its last reset. */
+struct nce_coap_rto_stats
+{
+    uint32_t strong;    /**< Round trips without retransmission. */
+    uint32_t weak;      /**< Round trips with up to two retransmissions. */
+    uint32_t dropped;   /**< Ambiguous round trips that were not used. */
+    uint32_t aged;      /**< Times a stale estimate was aged. */
+};
+
+/** @brief Estimator state of one destination, treat as opaque. */
+struct nce_coap_rto
+{
+    sys_snode_t node;
+    const char * name;
+    uint32_t rto_ms;            /**< Overall estimate. */
+    uint32_t strong_srtt_ms;
+    uint32_t strong_rttvar_ms;
+    uint32_t weak_srtt_ms;
+    uint32_t weak_rttvar_ms;
+    bool strong_valid;
+    bool weak_valid;
+    int64_t updated_at;
+    struct nce_coap_rto_stats stats;
+};
+
+/**
+ * @brief Initialize an estimator and list it in the "coap_rto" shell command.
+ *
+ * Starts at CONFIG_COAP_INIT_ACK_TIMEOUT_MS.
+ *
+ * @param[out] rto  Estimator state.
+ * @param[in]  name Name in logs and the shell, must stay valid.
+ */
+void nce_coap_rto_init( struct nce_coap_rto * rto,
+                        const char * name );
+
+/**
+ * @brief Start over, e.g. when the destination address changed.
+ */
+void nce_coap_rto_reset( struct nce_coap_rto * rto );
+
+/**
+ * @brief Get the transmission parameters for the next confirmable request.
+ *
+ * Ages a stale estimate first.
+ *
+ * @param[in]  rto    Estimator state.
+ * @param[out] params Timeout, backoff and CONFIG_COAP_MAX_RETRANSMIT.
+ */
+void nce_coap_rto_params( struct nce_coap_rto * rto,
+                          struct coap_transmission_parameters * params );
+
+/**
+ * @brief Report the round trip of a confirmable request.
+ *
+ * @param[in] rto    Estimator state.
+ * @param[in] params Parameters the request was sent with.
+ * @param[in] rtt_ms Time from the first transmission to the response.
+ */
+void nce_coap_rto_sample( struct nce_coap_rto * rto,
+                          const struct coap_transmission_parameters * params,
+                          uint32_t rtt_ms );
+
+/**
+ * @brief Current overall estimate in milliseconds.
+ */
+uint32_t nce_coap_rto_get( const struct nce_coap_rto * rto );
+
+/**
+ * @brief Read the statistics of a destination.
+ */
+void nce_coap_rto_stats_get( const struct nce_coap_rto * rto,
+                             struct nce_coap_rto_stats * stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_COAP_RTO_H__ */
@@ -0,0 +1,284 @@
+/******************************************************************************
+ * @file    nce_coap_rto.c
+ * @brief   Adaptive CoAP retransmission timeout (CoCoA).
+ * @details See nce_coap_rto.h. One spinlock guards all destinations; the
+ *          estimators only do integer arithmetic in milliseconds under it.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+
+#include <nce_coap_rto.h>
+
+LOG_MODULE_REGISTER( nce_coap_rto, CONFIG_NCE_COAP_RTO_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+
+/* Variance factors of the strong and weak estimators */
+#define STRONG_K            4U
+#define WEAK_K              1U
+
+/* Below and above these the backoff factor and the aging change */
+#define RTO_SMALL_MS        1000U
+#define RTO_LARGE_MS        3000U
+
+/* Idle time, in multiples of the estimate, before a small or large estimate is aged */
+#define AGE_SMALL_FACTOR    16
+#define AGE_LARGE_FACTOR    4
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct k_spinlock lock;
+static sys_slist_t destinations = SYS_SLIST_STATIC_INIT( &destinations );
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static uint32_t prv_clamp( uint32_t rto_ms )
+{
+    return CLAMP( rto_ms, CONFIG_NCE_COAP_RTO_MIN_MS, CONFIG_NCE_COAP_RTO_MAX_MS );
+}
+
+/** @brief RFC 6298 update, returns the estimator's RTO. */
+static uint32_t prv_estimate( uint32_t * srtt_ms,
+                              uint32_t * rttvar_ms,
+                              bool * valid,
+                              uint32_t k,
+                              uint32_t rtt_ms )
+{
+    uint32_t delta;
+
+    if( !*valid )
+    {
+        *srtt_ms = rtt_ms;
+        *rttvar_ms = rtt_ms / 2;
+        *valid = true;
+    }
+    else
+    {
+        delta = ( *srtt_ms > rtt_ms ) ? *srtt_ms - rtt_ms : rtt_ms - *srtt_ms;
+        *rttvar_ms = ( 3 * *rttvar_ms + delta ) / 4;
+        *srtt_ms = ( 7 * *srtt_ms + rtt_ms ) / 8;
+    }
+
+    return *srtt_ms + k * *rttvar_ms;
+}
+
+/** @brief Age an estimate that was not refreshed for a while. */
+static void prv_age( struct nce_coap_rto * rto,
+                     int64_t now )
+{
+    int64_t idle_ms;
+
+    for( ; ; )
+    {
+        if( rto->rto_ms < RTO_SMALL_MS )
+        {
+            idle_ms = ( int64_t ) AGE_SMALL_FACTOR * rto->rto_ms;
+
+            if( now - rto->updated_at < idle_ms )
+            {
+                return;
+            }
+
+            rto->rto_ms *= 2;
+        }
+        else if( rto->rto_ms > RTO_LARGE_MS )
+        {
+            idle_ms = ( int64_t ) AGE_LARGE_FACTOR * rto->rto_ms;
+
+            if( now - rto->updated_at < idle_ms )
+            {
+                return;
+            }
+
+            rto->rto_ms = RTO_SMALL_MS + rto->rto_ms / 2;
+        }
+        else
+        {
+            return;
+        }
+
+        /* Age step by step, a long idle period ages repeatedly */
+        rto->updated_at += idle_ms;
+        rto->rto_ms = prv_clamp( rto->rto_ms );
+        rto->stats.aged++;
+    }
+}
+
+/** @brief Variable backoff factor in percent. */
+static uint16_t prv_backoff_percent( uint32_t rto_ms )
+{
+    if( rto_ms < RTO_SMALL_MS )
+    {
+        return 300;
+    }
+
+    if( rto_ms > RTO_LARGE_MS )
+    {
+        return 150;
+    }
+
+    return 200;
+}
+
+static void prv_reset( struct nce_coap_rto * rto )
+{
+    rto->rto_ms = prv_clamp( CONFIG_COAP_INIT_ACK_TIMEOUT_MS );
+    rto->strong_srtt_ms = 0;
+    rto->strong_rttvar_ms = 0;
+    rto->weak_srtt_ms = 0;
+    rto->weak_rttvar_ms = 0;
+    rto->strong_valid = false;
+    rto->weak_valid = false;
+    rto->updated_at = k_uptime_get();
+    memset( &rto->stats, 0, sizeof( rto->stats ) );
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_coap_rto_init( struct nce_coap_rto * rto,
+                        const char * name )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    rto->name = name;
+    prv_reset( rto );
+    sys_slist_append( &destinations, &rto->node );
+
+    k_spin_unlock( &lock, key );
+}
+
+void nce_coap_rto_reset( struct nce_coap_rto * rto )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    prv_reset( rto );
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "%s: reset to %u ms", rto->name, rto->rto_ms );
+}
+
+void nce_coap_rto_params( struct nce_coap_rto * rto,
+                          struct coap_transmission_parameters * params )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    prv_age( rto, k_uptime_get() );
+
+    params->ack_timeout = rto->rto_ms;
+    params->coap_backoff_percent = prv_backoff_percent( rto->rto_ms );
+    params->max_retransmission = CONFIG_COAP_MAX_RETRANSMIT;
+
+    k_spin_unlock( &lock, key );
+}
+
+void nce_coap_rto_sample( struct nce_coap_rto * rto,
+                          const struct coap_transmission_parameters * params,
+                          uint32_t rtt_ms )
+{
+    uint64_t backoff = params->coap_backoff_percent;
+    uint64_t third_retransmission_ms;
+    k_spinlock_key_t key;
+    uint32_t estimate;
+    bool strong;
+
+    /* The stack only dithers the first timeout upwards: nothing was retransmitted before
+     * ack_timeout and no third retransmission left before ack_timeout * ( 1 + b + b^2 ) */
+    third_retransmission_ms = params->ack_timeout * ( 10000 + 100 * backoff + backoff * backoff ) / 10000;
+    strong = rtt_ms < params->ack_timeout;
+
+    key = k_spin_lock( &lock );
+
+    if( strong )
+    {
+        estimate = prv_estimate( &rto->strong_srtt_ms, &rto->strong_rttvar_ms, &rto->strong_valid, STRONG_K,
+                                 rtt_ms );
+        rto->rto_ms = prv_clamp( ( estimate + rto->rto_ms ) / 2 );
+        rto->stats.strong++;
+    }
+    else if( rtt_ms < third_retransmission_ms )
+    {
+        estimate = prv_estimate( &rto->weak_srtt_ms, &rto->weak_rttvar_ms, &rto->weak_valid, WEAK_K, rtt_ms );
+        rto->rto_ms = prv_clamp( ( estimate + 3 * rto->rto_ms ) / 4 );
+        rto->stats.weak++;
+    }
+    else
+    {
+        rto->stats.dropped++;
+        k_spin_unlock( &lock, key );
+        return;
+    }
+
+    rto->updated_at = k_uptime_get();
+    estimate = rto->rto_ms;
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "%s: %s round trip %u ms, timeout %u ms", rto->name, strong ? "strong" : "weak", rtt_ms, estimate );
+}
+
+uint32_t nce_coap_rto_get( const struct nce_coap_rto * rto )
+{
+    return rto->rto_ms;
+}
+
+void nce_coap_rto_stats_get( const struct nce_coap_rto * rto,
+                             struct nce_coap_rto_stats * stats )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    *stats = rto->stats;
+
+    k_spin_unlock( &lock, key );
+}
+
+#if defined( CONFIG_NCE_COAP_RTO_SHELL )
+static int cmd_coap_rto_show( const struct shell * sh,
+                              size_t argc,
+                              char ** argv )
+{
+    struct nce_coap_rto * rto;
+    struct nce_coap_rto_stats stats;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    /* Destinations are never removed, the list can be walked without the lock */
+    SYS_SLIST_FOR_EACH_CONTAINER( &destinations, rto, node )
+    {
+        nce_coap_rto_stats_get( rto, &stats );
+        shell_print( sh, "%s: timeout %u ms, backoff %u%%, strong srtt %u ms rttvar %u ms, "
+                     "weak srtt %u ms rttvar %u ms",
+                     rto->name, nce_coap_rto_get( rto ), prv_backoff_percent( nce_coap_rto_get( rto ) ),
+                     rto->strong_srtt_ms, rto->strong_rttvar_ms, rto->weak_srtt_ms, rto->weak_rttvar_ms );
+        shell_print( sh, "  samples: strong %u, weak %u, dropped %u, aged %u",
+                     stats.strong, stats.weak, stats.dropped, stats.aged );
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_coap_rto,
+                                SHELL_CMD( show, NULL, "Show the timeout estimators of every destination",
+                                           cmd_coap_rto_show ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( coap_rto, &sub_coap_rto, "Adaptive CoAP retransmission timeout", NULL );
+#endif /* if defined( CONFIG_NCE_COAP_RTO_SHELL ) */
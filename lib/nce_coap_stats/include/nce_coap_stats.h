@@ -0,0 +1,145 @@
+/******************************************************************************
+ * @file    nce_coap_stats.h
+ * @brief   CoAP round-trip time, retransmission and handshake statistics.
+ * @details Senders report every request handed to the CoAP client and its
+ *          completion with the time it was sent. Completed requests go into
+ *          a histogram of log-scale buckets: bucket 0 holds round trips
+ *          below NCE_COAP_STATS_RTT_BUCKET0_MS, every further bucket doubles
+ *          the limit and the last one holds everything above.
+ *
+ *          The CoAP client retransmits internally, so the retransmissions of
+ *          a confirmable request are inferred from its round trip with the
+ *          CoAP schedule: the n-th retransmission is sent (2^n - 1) times
+ *          the request's initial ACK timeout after the request. A round trip
+ *          without retransmission is the actual network delay and is what
+ *          the ACK timeout should be tuned against.
+ *
+ *          nce_coap_stats_export() writes the statistics as a compact
+ *          little-endian record for upload:
+ *
+ *          | Offset | Size   | Field                                   |
+ *          |--------|--------|-----------------------------------------|
+ *          | 0      | 1      | Record version (1)                      |
+ *          | 1      | 1      | Number of RTT buckets                   |
+ *          | 2      | 4      | Uptime in seconds                       |
+ *          | 6      | 4 x 5  | Requests, responses, retransmissions,   |
+ *          |        |        | timeouts, errors                        |
+ *          | 26     | 4 x 3  | RTT min, max, average in ms             |
+ *          | 38     | 2 x 12 | RTT buckets, saturated at 65535         |
+ *          | 62     | 2 x 2  | Handshakes, failed handshakes, saturated|
+ *          | 66     | 4 x 3  | Handshake last, max, average in ms      |
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_COAP_STATS_H__
+#define NCE_COAP_STATS_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Number of RTT histogram buckets. */
+#define NCE_COAP_STATS_RTT_BUCKETS       12
+
+/** @brief Upper limit of the first RTT bucket, doubled by every further one. */
+#define NCE_COAP_STATS_RTT_BUCKET0_MS    64
+
+/** @brief Version of the exported record. */
+#define NCE_COAP_STATS_RECORD_VERSION    1
+
+/** @brief Size of the exported record. */
+#define NCE_COAP_STATS_RECORD_SIZE       78
+
+/** @brief Statistics since boot or the last reset. */
+struct nce_coap_stats
+{
+    uint32_t requests;                                /**< Requests handed to the client. */
+    uint32_t responses;                               /**< Requests completed with a response. */
+    uint32_t retransmissions;                         /**< Inferred retransmissions. */
+    uint32_t timeouts;                                /**< Requests that were never answered. */
+    uint32_t errors;                                  /**< Requests that failed otherwise. */
+    uint32_t rtt_min_ms;                              /**< Shortest round trip, 0 if none. */
+    uint32_t rtt_max_ms;                              /**< Longest round trip. */
+    uint32_t rtt_avg_ms;                              /**< Average round trip. */
+    uint32_t rtt_buckets[ NCE_COAP_STATS_RTT_BUCKETS ]; /**< Round trip histogram. */
+    uint32_t handshakes;                              /**< DTLS handshakes that completed. */
+    uint32_t handshake_failures;                      /**< DTLS handshakes that failed. */
+    uint32_t handshake_last_ms;                       /**< Duration of the latest completed handshake. */
+    uint32_t handshake_max_ms;                        /**< Longest completed handshake. */
+    uint32_t handshake_avg_ms;                        /**< Average completed handshake. */
+};
+
+/**
+ * @brief Report a request handed to the CoAP client.
+ */
+void nce_coap_stats_request( void );
+
+/**
+ * @brief Report a completed request.
+ *
+ * @param[in] sent_ms        k_uptime_get_32() when the request was handed to
+ *                           the client.
+ * @param[in] code           Response code, or the negative error passed to
+ *                           the response callback.
+ * @param[in] ack_timeout_ms Initial ACK timeout the request was sent with, 0
+ *                           for a NON request.
+ */
+void nce_coap_stats_response( uint32_t sent_ms,
+                              int code,
+                              uint32_t ack_timeout_ms );
+
+/**
+ * @brief Report a DTLS handshake.
+ *
+ * @param[in] duration_ms Time the handshake took.
+ * @param[in] ok          true if it completed.
+ */
+void nce_coap_stats_handshake( uint32_t duration_ms,
+                               bool ok );
+
+/**
+ * @brief Read the statistics.
+ *
+ * @param[out] stats Copy of the statistics.
+ */
+void nce_coap_stats_get( struct nce_coap_stats * stats );
+
+/**
+ * @brief Clear the statistics.
+ */
+void nce_coap_stats_reset( void );
+
+/**
+ * @brief Upper limit of an RTT bucket.
+ *
+ * @param[in] bucket Bucket index.
+ *
+ * @return Limit in ms, UINT32_MAX for the last bucket.
+ */
+uint32_t nce_coap_stats_bucket_limit_ms( uint32_t bucket );
+
+/**
+ * @brief Write the statistics as a binary record, see the layout above.
+ *
+ * @param[out] buf  Buffer of at least NCE_COAP_STATS_RECORD_SIZE bytes.
+ * @param[in]  size Size of the buffer.
+ *
+ * @return Length of the record, -ENOMEM if the buffer is too small.
+ */
+int nce_coap_stats_export( uint8_t * buf,
+                           size_t size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_COAP_STATS_H__ */
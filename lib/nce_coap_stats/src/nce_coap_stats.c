@@ -0,0 +1,314 @@
+/******************************************************************************
+ * @file    nce_coap_stats.c
+ * @brief   CoAP round-trip time, retransmission and handshake statistics.
+ * @details See nce_coap_stats.h. Reports come from the sender's thread and
+ *          the CoAP client thread, a spinlock keeps the statistics
+ *          consistent.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/byteorder.h>
+
+#include <nce_coap_stats.h>
+
+LOG_MODULE_REGISTER( nce_coap_stats, CONFIG_NCE_COAP_STATS_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#if defined( CONFIG_COAP_MAX_RETRANSMIT )
+    #define MAX_RETRANSMIT    CONFIG_COAP_MAX_RETRANSMIT
+#else
+    #define MAX_RETRANSMIT    4 /* RFC 7252 default */
+#endif /* if defined( CONFIG_COAP_MAX_RETRANSMIT ) */
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct k_spinlock lock;
+static struct nce_coap_stats stats;
+static uint64_t rtt_total_ms;
+static uint64_t handshake_total_ms;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static uint32_t prv_bucket( uint32_t rtt_ms )
+{
+    uint32_t bucket = 0;
+
+    while( ( bucket < NCE_COAP_STATS_RTT_BUCKETS - 1 ) && ( rtt_ms >= nce_coap_stats_bucket_limit_ms( bucket ) ) )
+    {
+        bucket++;
+    }
+
+    return bucket;
+}
+
+/** @brief Retransmission n leaves at (2^n - 1) * timeout. */
+static uint32_t prv_retransmissions( uint32_t rtt_ms,
+                                     uint32_t ack_timeout_ms )
+{
+    uint32_t retransmissions = 0;
+
+    while( ( ack_timeout_ms > 0 ) && ( retransmissions < MAX_RETRANSMIT ) &&
+           ( rtt_ms > ( uint64_t ) ack_timeout_ms * ( BIT( retransmissions + 1 ) - 1 ) ) )
+    {
+        retransmissions++;
+    }
+
+    return retransmissions;
+}
+
+static uint8_t * prv_put_le32( uint8_t * pos,
+                               uint32_t value )
+{
+    sys_put_le32( value, pos );
+
+    return pos + sizeof( uint32_t );
+}
+
+static uint8_t * prv_put_le16_sat( uint8_t * pos,
+                                   uint32_t value )
+{
+    sys_put_le16( ( uint16_t ) MIN( value, UINT16_MAX ), pos );
+
+    return pos + sizeof( uint16_t );
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_coap_stats_request( void )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    stats.requests++;
+
+    k_spin_unlock( &lock, key );
+}
+
+void nce_coap_stats_response( uint32_t sent_ms,
+                              int code,
+                              uint32_t ack_timeout_ms )
+{
+    uint32_t rtt_ms = k_uptime_get_32() - sent_ms;
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    if( code == -ETIMEDOUT )
+    {
+        stats.timeouts++;
+        stats.retransmissions += MAX_RETRANSMIT;
+    }
+    else if( code < 0 )
+    {
+        stats.errors++;
+    }
+    else
+    {
+        stats.responses++;
+        stats.rtt_buckets[ prv_bucket( rtt_ms ) ]++;
+        stats.rtt_min_ms = ( stats.responses == 1 ) ? rtt_ms : MIN( stats.rtt_min_ms, rtt_ms );
+        stats.rtt_max_ms = MAX( stats.rtt_max_ms, rtt_ms );
+        rtt_total_ms += rtt_ms;
+        stats.retransmissions += prv_retransmissions( rtt_ms, ack_timeout_ms );
+    }
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "Request completed with %d after %u ms", code, rtt_ms );
+}
+
+void nce_coap_stats_handshake( uint32_t duration_ms,
+                               bool ok )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    if( ok )
+    {
+        stats.handshakes++;
+        stats.handshake_last_ms = duration_ms;
+        stats.handshake_max_ms = MAX( stats.handshake_max_ms, duration_ms );
+        handshake_total_ms += duration_ms;
+    }
+    else
+    {
+        stats.handshake_failures++;
+    }
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "DTLS handshake %s after %u ms", ok ? "completed" : "failed", duration_ms );
+}
+
+void nce_coap_stats_get( struct nce_coap_stats * out )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    *out = stats;
+    out->rtt_avg_ms = stats.responses ? ( uint32_t ) ( rtt_total_ms / stats.responses ) : 0;
+    out->handshake_avg_ms = stats.handshakes ? ( uint32_t ) ( handshake_total_ms / stats.handshakes ) : 0;
+
+    k_spin_unlock( &lock, key );
+}
+
+void nce_coap_stats_reset( void )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    memset( &stats, 0, sizeof( stats ) );
+    rtt_total_ms = 0;
+    handshake_total_ms = 0;
+
+    k_spin_unlock( &lock, key );
+}
+
+uint32_t nce_coap_stats_bucket_limit_ms( uint32_t bucket )
+{
+    return ( bucket < NCE_COAP_STATS_RTT_BUCKETS - 1 ) ? NCE_COAP_STATS_RTT_BUCKET0_MS << bucket : UINT32_MAX;
+}
+
+int nce_coap_stats_export( uint8_t * buf,
+                           size_t size )
+{
+    struct nce_coap_stats snapshot;
+    uint8_t * pos = buf;
+
+    if( size < NCE_COAP_STATS_RECORD_SIZE )
+    {
+        return -ENOMEM;
+    }
+
+    nce_coap_stats_get( &snapshot );
+
+    *pos++ = NCE_COAP_STATS_RECORD_VERSION;
+    *pos++ = NCE_COAP_STATS_RTT_BUCKETS;
+    pos = prv_put_le32( pos, ( uint32_t ) ( k_uptime_get() / MSEC_PER_SEC ) );
+    pos = prv_put_le32( pos, snapshot.requests );
+    pos = prv_put_le32( pos, snapshot.responses );
+    pos = prv_put_le32( pos, snapshot.retransmissions );
+    pos = prv_put_le32( pos, snapshot.timeouts );
+    pos = prv_put_le32( pos, snapshot.errors );
+    pos = prv_put_le32( pos, snapshot.rtt_min_ms );
+    pos = prv_put_le32( pos, snapshot.rtt_max_ms );
+    pos = prv_put_le32( pos, snapshot.rtt_avg_ms );
+
+    for( int i = 0; i < NCE_COAP_STATS_RTT_BUCKETS; i++ )
+    {
+        pos = prv_put_le16_sat( pos, snapshot.rtt_buckets[ i ] );
+    }
+
+    pos = prv_put_le16_sat( pos, snapshot.handshakes );
+    pos = prv_put_le16_sat( pos, snapshot.handshake_failures );
+    pos = prv_put_le32( pos, snapshot.handshake_last_ms );
+    pos = prv_put_le32( pos, snapshot.handshake_max_ms );
+    pos = prv_put_le32( pos, snapshot.handshake_avg_ms );
+
+    __ASSERT_NO_MSG( pos - buf == NCE_COAP_STATS_RECORD_SIZE );
+
+    return pos - buf;
+}
+
+#if defined( CONFIG_NCE_COAP_STATS_SHELL )
+static int cmd_coap_stats( const struct shell * sh,
+                           size_t argc,
+                           char ** argv )
+{
+    struct nce_coap_stats coap;
+    uint32_t lower_ms = 0;
+    uint32_t limit_ms;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    nce_coap_stats_get( &coap );
+
+    shell_print( sh, "requests:        %u", coap.requests );
+    shell_print( sh, "responses:       %u", coap.responses );
+    shell_print( sh, "retransmissions: %u (inferred)", coap.retransmissions );
+    shell_print( sh, "timeouts:        %u", coap.timeouts );
+    shell_print( sh, "errors:          %u", coap.errors );
+    shell_print( sh, "rtt:             min %u ms, avg %u ms, max %u ms", coap.rtt_min_ms, coap.rtt_avg_ms,
+                 coap.rtt_max_ms );
+
+    for( uint32_t i = 0; i < NCE_COAP_STATS_RTT_BUCKETS; i++ )
+    {
+        limit_ms = nce_coap_stats_bucket_limit_ms( i );
+
+        if( limit_ms == UINT32_MAX )
+        {
+            shell_print( sh, "  >= %5u ms:     %u", lower_ms, coap.rtt_buckets[ i ] );
+        }
+        else
+        {
+            shell_print( sh, "  < %6u ms:     %u", limit_ms, coap.rtt_buckets[ i ] );
+        }
+
+        lower_ms = limit_ms;
+    }
+
+    shell_print( sh, "handshakes:      %u (%u failed)", coap.handshakes, coap.handshake_failures );
+    shell_print( sh, "handshake time:  last %u ms, avg %u ms, max %u ms", coap.handshake_last_ms,
+                 coap.handshake_avg_ms, coap.handshake_max_ms );
+
+    return 0;
+}
+
+static int cmd_coap_reset( const struct shell * sh,
+                           size_t argc,
+                           char ** argv )
+{
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    nce_coap_stats_reset();
+    shell_print( sh, "Statistics cleared" );
+
+    return 0;
+}
+
+static int cmd_coap_export( const struct shell * sh,
+                            size_t argc,
+                            char ** argv )
+{
+    uint8_t record[ NCE_COAP_STATS_RECORD_SIZE ];
+    int len;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    len = nce_coap_stats_export( record, sizeof( record ) );
+
+    if( len < 0 )
+    {
+        shell_error( sh, "Export failed: %d", len );
+        return len;
+    }
+
+    shell_hexdump( sh, record, len );
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_coap,
+                                SHELL_CMD( stats, NULL, "Show round-trip times, retransmissions and handshakes",
+                                           cmd_coap_stats ),
+                                SHELL_CMD( reset, NULL, "Clear the statistics", cmd_coap_reset ),
+                                SHELL_CMD( export, NULL, "Dump the statistics as binary record", cmd_coap_export ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( coap, &sub_coap, "CoAP statistics", NULL );
+#endif /* if defined( CONFIG_NCE_COAP_STATS_SHELL ) */
@@ -0,0 +1,55 @@
+/******************************************************************************
+ * @file    nce_dns_cache.h
+ * @brief   DNS resolution cache with background refresh.
+ * @details Resolved IPv4 addresses are kept for CONFIG_NCE_DNS_CACHE_TTL_SECONDS.
+ *          A fresh entry is returned without any network traffic. An expired
+ *          entry is still returned immediately and refreshed on a background
+ *          work queue, so a reconnect never waits for a DNS round trip once a
+ *          hostname has been resolved. With CONFIG_NCE_DNS_CACHE_PERSIST the
+ *          last good address survives a reboot through the settings subsystem.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_DNS_CACHE_H__
+#define NCE_DNS_CACHE_H__
+
+#include <zephyr/net/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Resolve a hostname to an IPv4 address.
+ *
+ * Only the address is written, family and port are left to the caller.
+ *
+ * @param[in]  hostname Hostname to resolve.
+ * @param[out] addr     Resolved address.
+ *
+ * @return 0 on success (cached or resolved), negative error code if the
+ *         hostname is not cached and cannot be resolved.
+ */
+int nce_dns_cache_resolve( const char * hostname,
+                           struct in_addr * addr );
+
+/**
+ * @brief Mark the cached address of a hostname as unusable.
+ *
+ * Call this when connecting to the cached address failed; the next
+ * nce_dns_cache_resolve() queries DNS before returning.
+ *
+ * @param[in] hostname Hostname to invalidate.
+ */
+void nce_dns_cache_invalidate( const char * hostname );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_DNS_CACHE_H__ */
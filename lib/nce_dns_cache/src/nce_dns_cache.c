@@ -0,0 +1,347 @@
+/******************************************************************************
+ * @file    nce_dns_cache.c
+ * @brief   DNS resolution cache with background refresh.
+ * @details See nce_dns_cache.h. Entries are looked up by hostname under a
+ *          mutex; DNS queries and flash writes run outside of it. Expired
+ *          entries are refreshed on a dedicated low-priority work queue so a
+ *          slow lookup never blocks the system work queue.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+
+#if defined( CONFIG_NCE_DNS_CACHE_PERSIST )
+    #include <zephyr/settings/settings.h>
+#endif /* if defined( CONFIG_NCE_DNS_CACHE_PERSIST ) */
+
+#include <nce_dns_cache.h>
+
+LOG_MODULE_REGISTER( nce_dns_cache, CONFIG_NCE_DNS_CACHE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define DNS_CACHE_SETTINGS_ROOT    "nce_dns"
+#define DNS_CACHE_TTL_MS           ( ( int64_t ) CONFIG_NCE_DNS_CACHE_TTL_SECONDS * MSEC_PER_SEC )
+
+/******************************************************************************
+* Types
+******************************************************************************/
+struct dns_cache_entry
+{
+    char hostname[ CONFIG_NCE_DNS_CACHE_HOSTNAME_MAX_LEN + 1 ];
+    struct in_addr addr;
+    int64_t expires_ms; /* 0 for an address restored from settings */
+    bool valid;
+    bool refreshing;
+    struct k_work refresh_work;
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static K_MUTEX_DEFINE( cache_lock );
+static struct dns_cache_entry cache[ CONFIG_NCE_DNS_CACHE_ENTRIES ];
+
+static K_THREAD_STACK_DEFINE( refresh_stack, CONFIG_NCE_DNS_CACHE_REFRESH_STACK_SIZE );
+static struct k_work_q refresh_work_q;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static int prv_query( const char * hostname,
+                      struct in_addr * addr )
+{
+    int err;
+    struct zsock_addrinfo * res = NULL;
+    struct zsock_addrinfo hints =
+    {
+        .ai_family   = AF_INET,
+        .ai_socktype = SOCK_DGRAM,
+    };
+
+    err = zsock_getaddrinfo( hostname, NULL, &hints, &res );
+
+    if( ( err != 0 ) || ( res == NULL ) || ( res->ai_addr == NULL ) )
+    {
+        LOG_WRN( "Failed to resolve %s: %d", hostname, err );
+
+        if( res != NULL )
+        {
+            zsock_freeaddrinfo( res );
+        }
+
+        return -EHOSTUNREACH;
+    }
+
+    *addr = ( ( struct sockaddr_in * ) res->ai_addr )->sin_addr;
+    zsock_freeaddrinfo( res );
+
+    return 0;
+}
+
+/** @brief Find the entry of a hostname. Call with cache_lock held. */
+static struct dns_cache_entry * prv_find( const char * hostname )
+{
+    for( size_t i = 0; i < ARRAY_SIZE( cache ); i++ )
+    {
+        if( strcmp( cache[ i ].hostname, hostname ) == 0 )
+        {
+            return &cache[ i ];
+        }
+    }
+
+    return NULL;
+}
+
+/** @brief Find or claim an entry for a hostname, evicting the oldest one. Call with cache_lock held. */
+static struct dns_cache_entry * prv_claim( const char * hostname )
+{
+    struct dns_cache_entry * entry = prv_find( hostname );
+
+    if( entry != NULL )
+    {
+        return entry;
+    }
+
+    entry = &cache[ 0 ];
+
+    for( size_t i = 0; i < ARRAY_SIZE( cache ); i++ )
+    {
+        if( cache[ i ].hostname[ 0 ] == '\0' )
+        {
+            entry = &cache[ i ];
+            break;
+        }
+
+        if( cache[ i ].expires_ms < entry->expires_ms )
+        {
+            entry = &cache[ i ];
+        }
+    }
+
+    strcpy( entry->hostname, hostname );
+    entry->valid = false;
+
+    return entry;
+}
+
+static void prv_persist( const char * hostname,
+                         const struct in_addr * addr )
+{
+    #if defined( CONFIG_NCE_DNS_CACHE_PERSIST )
+    char key[ sizeof( DNS_CACHE_SETTINGS_ROOT "/" ) + CONFIG_NCE_DNS_CACHE_HOSTNAME_MAX_LEN ];
+    int err;
+
+    snprintf( key, sizeof( key ), DNS_CACHE_SETTINGS_ROOT "/%s", hostname );
+    err = settings_save_one( key, addr, sizeof( *addr ) );
+
+    if( err )
+    {
+        LOG_WRN( "Failed to persist address of %s: %d", hostname, err );
+    }
+    #else
+    ARG_UNUSED( hostname );
+    ARG_UNUSED( addr );
+    #endif /* if defined( CONFIG_NCE_DNS_CACHE_PERSIST ) */
+}
+
+static void prv_store( const char * hostname,
+                       const struct in_addr * addr )
+{
+    struct dns_cache_entry * entry;
+    bool changed;
+
+    k_mutex_lock( &cache_lock, K_FOREVER );
+
+    entry = prv_claim( hostname );
+    changed = !entry->valid || ( entry->addr.s_addr != addr->s_addr );
+    entry->addr = *addr;
+    entry->expires_ms = k_uptime_get() + DNS_CACHE_TTL_MS;
+    entry->valid = true;
+
+    k_mutex_unlock( &cache_lock );
+
+    if( changed )
+    {
+        char addr_str[ NET_IPV4_ADDR_LEN ];
+
+        zsock_inet_ntop( AF_INET, addr, addr_str, sizeof( addr_str ) );
+        LOG_INF( "%s resolved to %s", hostname, addr_str );
+        prv_persist( hostname, addr );
+    }
+}
+
+static void prv_refresh_work_fn( struct k_work * work )
+{
+    struct dns_cache_entry * entry = CONTAINER_OF( work, struct dns_cache_entry, refresh_work );
+    char hostname[ CONFIG_NCE_DNS_CACHE_HOSTNAME_MAX_LEN + 1 ];
+    struct in_addr addr;
+
+    k_mutex_lock( &cache_lock, K_FOREVER );
+    strcpy( hostname, entry->hostname );
+    k_mutex_unlock( &cache_lock );
+
+    if( prv_query( hostname, &addr ) == 0 )
+    {
+        prv_store( hostname, &addr );
+    }
+    else
+    {
+        LOG_WRN( "Refresh of %s failed, keeping the expired address", hostname );
+    }
+
+    k_mutex_lock( &cache_lock, K_FOREVER );
+    entry->refreshing = false;
+    k_mutex_unlock( &cache_lock );
+}
+
+#if defined( CONFIG_NCE_DNS_CACHE_PERSIST )
+static int prv_settings_set( const char * name,
+                             size_t len,
+                             settings_read_cb read_cb,
+                             void * cb_arg )
+{
+    struct dns_cache_entry * entry;
+    struct in_addr addr;
+    int rc;
+
+    if( ( len != sizeof( addr ) ) || ( strlen( name ) > CONFIG_NCE_DNS_CACHE_HOSTNAME_MAX_LEN ) )
+    {
+        return -EINVAL;
+    }
+
+    rc = read_cb( cb_arg, &addr, sizeof( addr ) );
+
+    if( rc < 0 )
+    {
+        return rc;
+    }
+
+    k_mutex_lock( &cache_lock, K_FOREVER );
+
+    /* Restored as expired: used right away and refreshed on first use */
+    entry = prv_claim( name );
+    entry->addr = addr;
+    entry->expires_ms = 0;
+    entry->valid = true;
+
+    k_mutex_unlock( &cache_lock );
+
+    LOG_DBG( "Restored cached address of %s", name );
+
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE( nce_dns_cache, DNS_CACHE_SETTINGS_ROOT, NULL,
+                                prv_settings_set, NULL, NULL );
+#endif /* if defined( CONFIG_NCE_DNS_CACHE_PERSIST ) */
+
+static int prv_dns_cache_init( void )
+{
+    for( size_t i = 0; i < ARRAY_SIZE( cache ); i++ )
+    {
+        k_work_init( &cache[ i ].refresh_work, prv_refresh_work_fn );
+    }
+
+    k_work_queue_start( &refresh_work_q, refresh_stack, K_THREAD_STACK_SIZEOF( refresh_stack ),
+                        CONFIG_NCE_DNS_CACHE_REFRESH_PRIORITY, NULL );
+    k_thread_name_set( &refresh_work_q.thread, "dns_cache" );
+
+    #if defined( CONFIG_NCE_DNS_CACHE_PERSIST )
+    int err = settings_subsys_init();
+
+    if( err == 0 )
+    {
+        err = settings_load_subtree( DNS_CACHE_SETTINGS_ROOT );
+    }
+
+    if( err )
+    {
+        LOG_WRN( "Failed to load cached addresses: %d", err );
+    }
+    #endif /* if defined( CONFIG_NCE_DNS_CACHE_PERSIST ) */
+
+    return 0;
+}
+
+SYS_INIT( prv_dns_cache_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY );
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+int nce_dns_cache_resolve( const char * hostname,
+                           struct in_addr * addr )
+{
+    struct dns_cache_entry * entry;
+    int err;
+
+    if( hostname[ 0 ] == '\0' )
+    {
+        return -EINVAL;
+    }
+
+    if( strlen( hostname ) > CONFIG_NCE_DNS_CACHE_HOSTNAME_MAX_LEN )
+    {
+        LOG_WRN( "%s is too long to be cached", hostname );
+        return prv_query( hostname, addr );
+    }
+
+    k_mutex_lock( &cache_lock, K_FOREVER );
+    entry = prv_find( hostname );
+
+    if( ( entry != NULL ) && entry->valid )
+    {
+        *addr = entry->addr;
+
+        if( ( k_uptime_get() >= entry->expires_ms ) && !entry->refreshing )
+        {
+            LOG_DBG( "Serving expired address of %s, refreshing", hostname );
+            entry->refreshing = true;
+            k_work_submit_to_queue( &refresh_work_q, &entry->refresh_work );
+        }
+
+        k_mutex_unlock( &cache_lock );
+        return 0;
+    }
+
+    k_mutex_unlock( &cache_lock );
+
+    err = prv_query( hostname, addr );
+
+    if( err == 0 )
+    {
+        prv_store( hostname, addr );
+    }
+
+    return err;
+}
+
+void nce_dns_cache_invalidate( const char * hostname )
+{
+    struct dns_cache_entry * entry;
+
+    k_mutex_lock( &cache_lock, K_FOREVER );
+    entry = prv_find( hostname );
+
+    if( entry != NULL )
+    {
+        entry->valid = false;
+    }
+
+    k_mutex_unlock( &cache_lock );
+}
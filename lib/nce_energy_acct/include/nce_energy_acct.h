@@ -0,0 +1,136 @@
+/******************************************************************************
+ * @file    nce_energy_acct.h
+ * @brief   Per-message radio energy and byte accounting.
+ * @details Senders report every message with its payload and on-the-wire
+ *          size and report again when it completed. The library follows the
+ *          RRC state and modem sleep from the LTE link controller and splits
+ *          every RRC connected period, and the wake-up that started it,
+ *          among the messages sent since the previous one. A message record
+ *          is complete once the message is done and its connected period
+ *          ended.
+ *
+ *          Totals are also kept per accounting period (one hour by default)
+ *          together with the time spent connected, idle and asleep and the
+ *          modem's own byte counters (AT%XCONNSTAT). Charges are estimated
+ *          from the currents of the CONFIG_NCE_ENERGY_ACCT_* power model.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_ENERGY_ACCT_H__
+#define NCE_ENERGY_ACCT_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief IPv4 and UDP headers of a datagram. */
+#define NCE_ENERGY_ACCT_IP_UDP_OVERHEAD    28
+
+/** @brief DTLS 1.2 record header, explicit nonce and CCM-8 tag. */
+#define NCE_ENERGY_ACCT_DTLS_OVERHEAD      29
+
+/** @brief Cost of one message. */
+struct nce_energy_msg
+{
+    uint32_t id;              /**< Handle returned by nce_energy_acct_tx(). */
+    uint32_t payload_bytes;   /**< Application payload. */
+    uint32_t tx_bytes;        /**< Bytes on the wire, retransmissions included. */
+    uint32_t rx_bytes;        /**< Bytes of the response on the wire. */
+    uint32_t retransmissions; /**< Retransmissions, inferred from the completion time. */
+    uint32_t connected_ms;    /**< Share of RRC connected time. */
+    bool woke_radio;          /**< Sent while the radio was not connected. */
+    uint32_t charge_nah;      /**< Estimated charge in nAh. */
+};
+
+/** @brief Totals of one accounting period. */
+struct nce_energy_period
+{
+    uint32_t start_s;         /**< Uptime at the start of the period. */
+    uint32_t duration_s;      /**< Length of the period. */
+    uint32_t messages;        /**< Messages reported. */
+    uint32_t payload_bytes;   /**< Application payload. */
+    uint32_t tx_bytes;        /**< Bytes on the wire, retransmissions included. */
+    uint32_t rx_bytes;        /**< Response bytes on the wire. */
+    uint32_t retransmissions; /**< Inferred retransmissions. */
+    int32_t modem_tx_kb;      /**< Modem data counter delta (AT%XCONNSTAT), -1 if unknown. */
+    int32_t modem_rx_kb;      /**< Modem data counter delta (AT%XCONNSTAT), -1 if unknown. */
+    uint32_t connected_ms;    /**< Time in RRC connected. */
+    uint32_t idle_ms;         /**< Time in RRC idle or in an unknown state. */
+    uint32_t sleep_ms;        /**< Time in PSM or eDRX sleep. */
+    uint32_t wakeups;         /**< RRC connections set up. */
+    uint32_t charge_nah;      /**< Estimated charge in nAh. */
+};
+
+/**
+ * @brief Report a message handed to the network.
+ *
+ * @param[in] payload_len Application payload length.
+ * @param[in] wire_len    Length of the datagram on the wire, headers and
+ *                        security overhead included.
+ *
+ * @return Handle for nce_energy_acct_done(), never 0 and below 2^31.
+ */
+uint32_t nce_energy_acct_tx( size_t payload_len,
+                             size_t wire_len );
+
+/**
+ * @brief Withdraw a message that could not be handed to the network after all.
+ *
+ * @param[in] id Handle of the message.
+ */
+void nce_energy_acct_cancel( uint32_t id );
+
+/**
+ * @brief Report a message as completed.
+ *
+ * Retransmissions are inferred from the time since nce_energy_acct_tx()
+ * with the CoAP schedule: the n-th retransmission is sent
+ * (2^n - 1) * @p first_timeout_ms after the request.
+ *
+ * @param[in] id               Handle of the message.
+ * @param[in] rx_wire_len      Length of the response on the wire, 0 if none.
+ * @param[in] first_timeout_ms Initial retransmission timeout, 0 for a message
+ *                             that is never retransmitted.
+ */
+void nce_energy_acct_done( uint32_t id,
+                           size_t rx_wire_len,
+                           uint32_t first_timeout_ms );
+
+/**
+ * @brief Read a completed message record.
+ *
+ * @param[in]  index 0 for the latest record, 1 for the one before, ...
+ * @param[out] msg   Copy of the record.
+ *
+ * @return true if the record exists.
+ */
+bool nce_energy_acct_msg_get( uint32_t index,
+                              struct nce_energy_msg * msg );
+
+/**
+ * @brief Read the totals of an accounting period.
+ *
+ * @param[in]  previous false for the running period, true for the last
+ *                      completed one.
+ * @param[out] period   Copy of the totals. The running period is counted up
+ *                      to now, its modem counters are unknown.
+ *
+ * @return true if the period exists.
+ */
+bool nce_energy_acct_period_get( bool previous,
+                                 struct nce_energy_period * period );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_ENERGY_ACCT_H__ */
@@ -0,0 +1,568 @@
+/******************************************************************************
+ * @file    nce_energy_acct.c
+ * @brief   Per-message radio energy and byte accounting.
+ * @details See nce_energy_acct.h. Messages wait in a small table until their
+ *          record is complete; when it is full, the oldest entry is closed
+ *          with what is known about it. Without the LTE link controller,
+ *          records are complete as soon as the message is done and carry no
+ *          radio time.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#if defined( CONFIG_LTE_LINK_CONTROL )
+    #include <modem/lte_lc.h>
+#endif /* if defined( CONFIG_LTE_LINK_CONTROL ) */
+#if defined( CONFIG_NRF_MODEM_LIB )
+    #include <modem/nrf_modem_lib.h>
+    #include <nrf_modem_at.h>
+#endif /* if defined( CONFIG_NRF_MODEM_LIB ) */
+
+#include <nce_energy_acct.h>
+
+LOG_MODULE_REGISTER( nce_energy_acct, CONFIG_NCE_ENERGY_ACCT_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define RADIO_TRACKED    IS_ENABLED( CONFIG_LTE_LINK_CONTROL )
+
+/* Charges are summed in uA * ms, 3600 of them make one nAh */
+#define UAMS_PER_NAH     3600U
+
+#if defined( CONFIG_COAP_MAX_RETRANSMIT )
+    #define MAX_RETRANSMIT    CONFIG_COAP_MAX_RETRANSMIT
+#else
+    #define MAX_RETRANSMIT    4 /* RFC 7252 default */
+#endif /* if defined( CONFIG_COAP_MAX_RETRANSMIT ) */
+
+/******************************************************************************
+* Types
+******************************************************************************/
+enum radio_state
+{
+    RADIO_IDLE, /* Also before the first event and while not registered */
+    RADIO_CONNECTED,
+    RADIO_SLEEP,
+};
+
+struct open_msg
+{
+    struct nce_energy_msg rec;
+    bool used;
+    bool done;
+    bool radio_closed; /* The connected period the message was sent in ended */
+    uint32_t radio_seq;
+    int64_t sent_at;
+    uint32_t wire_len;
+    uint64_t wakeup_uams;
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct k_spinlock lock;
+static struct open_msg open_msgs[ CONFIG_NCE_ENERGY_ACCT_MAX_OPEN ];
+static struct nce_energy_msg history[ CONFIG_NCE_ENERGY_ACCT_HISTORY ];
+static uint32_t history_count;
+static uint32_t next_id = 1;
+
+static enum radio_state radio_state;
+static int64_t radio_since;
+static int64_t connected_at;
+static uint32_t radio_seq;
+
+static struct nce_energy_period current;
+static struct nce_energy_period previous;
+static bool has_previous;
+static int32_t modem_tx_kb = -1;
+static int32_t modem_rx_kb = -1;
+
+static void prv_period_work_fn( struct k_work * work );
+static K_WORK_DELAYABLE_DEFINE( period_work, prv_period_work_fn );
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static uint64_t prv_tx_uams( uint32_t tx_bytes )
+{
+    return ( ( uint64_t ) tx_bytes * CONFIG_NCE_ENERGY_ACCT_TX_UAS_PER_KB * MSEC_PER_SEC ) / 1024U;
+}
+
+/** @brief Charge of a message: its share of the connection and wake-up, and its own bytes. */
+static uint32_t prv_msg_charge_nah( const struct open_msg * msg )
+{
+    uint64_t uams = ( uint64_t ) msg->rec.connected_ms * CONFIG_NCE_ENERGY_ACCT_CONNECTED_UA +
+                    msg->wakeup_uams + prv_tx_uams( msg->rec.tx_bytes );
+
+    return ( uint32_t ) ( uams / UAMS_PER_NAH );
+}
+
+static uint32_t prv_period_charge_nah( const struct nce_energy_period * period )
+{
+    uint64_t uams = ( uint64_t ) period->connected_ms * CONFIG_NCE_ENERGY_ACCT_CONNECTED_UA +
+                    ( uint64_t ) period->idle_ms * CONFIG_NCE_ENERGY_ACCT_IDLE_UA +
+                    ( uint64_t ) period->sleep_ms * CONFIG_NCE_ENERGY_ACCT_SLEEP_UA +
+                    ( uint64_t ) period->wakeups * CONFIG_NCE_ENERGY_ACCT_WAKEUP_UAS * MSEC_PER_SEC +
+                    prv_tx_uams( period->tx_bytes );
+
+    return ( uint32_t ) ( uams / UAMS_PER_NAH );
+}
+
+/** @brief Add the time since the last radio event to the running period. Lock held. */
+static void prv_radio_time_add( int64_t now )
+{
+    uint32_t elapsed = ( uint32_t ) ( now - radio_since );
+
+    switch( radio_state )
+    {
+        case RADIO_CONNECTED:
+            current.connected_ms += elapsed;
+            break;
+
+        case RADIO_SLEEP:
+            current.sleep_ms += elapsed;
+            break;
+
+        default:
+            current.idle_ms += elapsed;
+            break;
+    }
+
+    radio_since = now;
+}
+
+/** @brief Move a complete message to the history and free its slot. Lock held. */
+static void prv_msg_close( struct open_msg * msg )
+{
+    msg->rec.charge_nah = prv_msg_charge_nah( msg );
+    history[ history_count % ARRAY_SIZE( history ) ] = msg->rec;
+    history_count++;
+    msg->used = false;
+
+    LOG_INF( "Message %u: %u B payload, %u B sent, %u B received, %u retx, %u ms connected%s, %u.%03u uAh",
+             msg->rec.id, msg->rec.payload_bytes, msg->rec.tx_bytes, msg->rec.rx_bytes,
+             msg->rec.retransmissions, msg->rec.connected_ms, msg->rec.woke_radio ? " (woke radio)" : "",
+             msg->rec.charge_nah / 1000U, msg->rec.charge_nah % 1000U );
+}
+
+#if defined( CONFIG_LTE_LINK_CONTROL )
+/** @brief A connection ended, split it among the messages sent since the previous one. Lock held. */
+static void prv_connection_split( uint32_t connected_ms )
+{
+    uint32_t count = 0;
+
+    for( int i = 0; i < ARRAY_SIZE( open_msgs ); i++ )
+    {
+        if( open_msgs[ i ].used && !open_msgs[ i ].radio_closed && ( open_msgs[ i ].radio_seq == radio_seq ) )
+        {
+            count++;
+        }
+    }
+
+    for( int i = 0; ( count > 0 ) && ( i < ARRAY_SIZE( open_msgs ) ); i++ )
+    {
+        struct open_msg * msg = &open_msgs[ i ];
+
+        if( !msg->used || msg->radio_closed || ( msg->radio_seq != radio_seq ) )
+        {
+            continue;
+        }
+
+        msg->rec.connected_ms += connected_ms / count;
+        msg->wakeup_uams += ( ( uint64_t ) CONFIG_NCE_ENERGY_ACCT_WAKEUP_UAS * MSEC_PER_SEC ) / count;
+        msg->radio_closed = true;
+
+        if( msg->done )
+        {
+            prv_msg_close( msg );
+        }
+    }
+
+    radio_seq++;
+}
+
+static void prv_radio_state_set( enum radio_state state )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    int64_t now = k_uptime_get();
+    enum radio_state old_state = radio_state;
+
+    if( state == old_state )
+    {
+        k_spin_unlock( &lock, key );
+        return;
+    }
+
+    prv_radio_time_add( now );
+    radio_state = state;
+
+    if( state == RADIO_CONNECTED )
+    {
+        current.wakeups++;
+        connected_at = now;
+    }
+    else if( old_state == RADIO_CONNECTED )
+    {
+        prv_connection_split( ( uint32_t ) ( now - connected_at ) );
+    }
+
+    k_spin_unlock( &lock, key );
+}
+
+static void prv_lte_handler( const struct lte_lc_evt * const evt )
+{
+    switch( evt->type )
+    {
+        case LTE_LC_EVT_RRC_UPDATE:
+            prv_radio_state_set( ( evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED ) ? RADIO_CONNECTED : RADIO_IDLE );
+            break;
+
+        case LTE_LC_EVT_MODEM_SLEEP_ENTER:
+            prv_radio_state_set( RADIO_SLEEP );
+            break;
+
+        case LTE_LC_EVT_MODEM_SLEEP_EXIT:
+            prv_radio_state_set( RADIO_IDLE );
+            break;
+
+        default:
+            break;
+    }
+}
+#endif /* if defined( CONFIG_LTE_LINK_CONTROL ) */
+
+#if defined( CONFIG_NRF_MODEM_LIB )
+static void prv_modem_init_cb( int ret,
+                               void * ctx )
+{
+    ARG_UNUSED( ctx );
+
+    if( ( ret == 0 ) && ( nrf_modem_at_printf( "AT%%XCONNSTAT=1" ) != 0 ) )
+    {
+        LOG_WRN( "Failed to start the modem connectivity statistics" );
+    }
+}
+
+NRF_MODEM_LIB_ON_INIT( nce_energy_acct_modem, prv_modem_init_cb, NULL );
+
+/** @brief Read the modem's data counters and return the change since the last read. */
+static void prv_modem_counters_read( int32_t * tx_delta_kb,
+                                     int32_t * rx_delta_kb )
+{
+    int tx_kb;
+    int rx_kb;
+
+    *tx_delta_kb = -1;
+    *rx_delta_kb = -1;
+
+    if( nrf_modem_at_scanf( "AT%XCONNSTAT?", "%%XCONNSTAT: %*d,%*d,%d,%d", &tx_kb, &rx_kb ) != 2 )
+    {
+        return;
+    }
+
+    /* The counters restart with the modem, the first read after that is the delta */
+    if( ( modem_tx_kb >= 0 ) && ( tx_kb >= modem_tx_kb ) && ( rx_kb >= modem_rx_kb ) )
+    {
+        *tx_delta_kb = tx_kb - modem_tx_kb;
+        *rx_delta_kb = rx_kb - modem_rx_kb;
+    }
+    else if( modem_tx_kb >= 0 )
+    {
+        *tx_delta_kb = tx_kb;
+        *rx_delta_kb = rx_kb;
+    }
+
+    modem_tx_kb = tx_kb;
+    modem_rx_kb = rx_kb;
+}
+#endif /* if defined( CONFIG_NRF_MODEM_LIB ) */
+
+/** @brief End of an accounting period. */
+static void prv_period_work_fn( struct k_work * work )
+{
+    int32_t tx_delta_kb = -1;
+    int32_t rx_delta_kb = -1;
+    k_spinlock_key_t key;
+    int64_t now;
+
+    ARG_UNUSED( work );
+
+    /* The AT command blocks, read before taking the lock */
+    #if defined( CONFIG_NRF_MODEM_LIB )
+    prv_modem_counters_read( &tx_delta_kb, &rx_delta_kb );
+    #endif /* if defined( CONFIG_NRF_MODEM_LIB ) */
+
+    key = k_spin_lock( &lock );
+    now = k_uptime_get();
+    prv_radio_time_add( now );
+
+    current.duration_s = ( uint32_t ) ( now / MSEC_PER_SEC ) - current.start_s;
+    current.modem_tx_kb = tx_delta_kb;
+    current.modem_rx_kb = rx_delta_kb;
+    current.charge_nah = prv_period_charge_nah( &current );
+    previous = current;
+    has_previous = true;
+
+    memset( &current, 0, sizeof( current ) );
+    current.start_s = ( uint32_t ) ( now / MSEC_PER_SEC );
+    current.modem_tx_kb = -1;
+    current.modem_rx_kb = -1;
+
+    k_spin_unlock( &lock, key );
+
+    LOG_INF( "Period of %u s: %u messages, %u B sent, %u B received, %u retx, modem %d/%d kB, "
+             "%u ms connected, %u wake-ups, %u.%03u uAh",
+             previous.duration_s, previous.messages, previous.tx_bytes, previous.rx_bytes,
+             previous.retransmissions, previous.modem_tx_kb, previous.modem_rx_kb,
+             previous.connected_ms, previous.wakeups,
+             previous.charge_nah / 1000U, previous.charge_nah % 1000U );
+
+    k_work_reschedule( &period_work, K_SECONDS( CONFIG_NCE_ENERGY_ACCT_PERIOD_SECONDS ) );
+}
+
+static int prv_energy_acct_init( void )
+{
+    current.modem_tx_kb = -1;
+    current.modem_rx_kb = -1;
+
+    #if defined( CONFIG_LTE_LINK_CONTROL )
+    lte_lc_register_handler( prv_lte_handler );
+    #endif /* if defined( CONFIG_LTE_LINK_CONTROL ) */
+
+    k_work_reschedule( &period_work, K_SECONDS( CONFIG_NCE_ENERGY_ACCT_PERIOD_SECONDS ) );
+
+    return 0;
+}
+
+SYS_INIT( prv_energy_acct_init, APPLICATION, 0 );
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+uint32_t nce_energy_acct_tx( size_t payload_len,
+                             size_t wire_len )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    struct open_msg * msg = NULL;
+    struct open_msg * oldest = &open_msgs[ 0 ];
+    uint32_t id;
+
+    for( int i = 0; i < ARRAY_SIZE( open_msgs ); i++ )
+    {
+        if( !open_msgs[ i ].used )
+        {
+            msg = &open_msgs[ i ];
+            break;
+        }
+
+        if( open_msgs[ i ].sent_at < oldest->sent_at )
+        {
+            oldest = &open_msgs[ i ];
+        }
+    }
+
+    if( !msg )
+    {
+        /* Never completed or its connection was never reported, close it with what is known */
+        msg = oldest;
+        prv_msg_close( msg );
+    }
+
+    id = next_id++;
+
+    /* Keep the top bit clear so callers can tag the handle */
+    if( next_id > INT32_MAX )
+    {
+        next_id = 1;
+    }
+
+    memset( msg, 0, sizeof( *msg ) );
+    msg->used = true;
+    msg->sent_at = k_uptime_get();
+    msg->radio_seq = radio_seq;
+    msg->wire_len = ( uint32_t ) wire_len;
+    msg->rec.id = id;
+    msg->rec.payload_bytes = ( uint32_t ) payload_len;
+    msg->rec.tx_bytes = ( uint32_t ) wire_len;
+    msg->rec.woke_radio = RADIO_TRACKED && ( radio_state != RADIO_CONNECTED );
+
+    current.messages++;
+    current.payload_bytes += ( uint32_t ) payload_len;
+    current.tx_bytes += ( uint32_t ) wire_len;
+
+    k_spin_unlock( &lock, key );
+
+    return id;
+}
+
+void nce_energy_acct_cancel( uint32_t id )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    for( int i = 0; i < ARRAY_SIZE( open_msgs ); i++ )
+    {
+        struct open_msg * msg = &open_msgs[ i ];
+
+        if( msg->used && !msg->done && ( msg->rec.id == id ) )
+        {
+            current.messages--;
+            current.payload_bytes -= msg->rec.payload_bytes;
+            current.tx_bytes -= msg->rec.tx_bytes;
+            msg->used = false;
+            break;
+        }
+    }
+
+    k_spin_unlock( &lock, key );
+}
+
+void nce_energy_acct_done( uint32_t id,
+                           size_t rx_wire_len,
+                           uint32_t first_timeout_ms )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    uint32_t retransmissions = 0;
+    int64_t elapsed;
+
+    for( int i = 0; i < ARRAY_SIZE( open_msgs ); i++ )
+    {
+        struct open_msg * msg = &open_msgs[ i ];
+
+        if( !msg->used || msg->done || ( msg->rec.id != id ) )
+        {
+            continue;
+        }
+
+        elapsed = k_uptime_get() - msg->sent_at;
+
+        /* Retransmission n leaves at (2^n - 1) * timeout */
+        while( ( first_timeout_ms > 0 ) && ( retransmissions < MAX_RETRANSMIT ) &&
+               ( elapsed > ( int64_t ) first_timeout_ms * ( BIT( retransmissions + 1 ) - 1 ) ) )
+        {
+            retransmissions++;
+        }
+
+        msg->done = true;
+        msg->rec.rx_bytes = ( uint32_t ) rx_wire_len;
+        msg->rec.retransmissions = retransmissions;
+        msg->rec.tx_bytes += retransmissions * msg->wire_len;
+
+        current.rx_bytes += ( uint32_t ) rx_wire_len;
+        current.retransmissions += retransmissions;
+        current.tx_bytes += retransmissions * msg->wire_len;
+
+        if( msg->radio_closed || !RADIO_TRACKED )
+        {
+            prv_msg_close( msg );
+        }
+
+        break;
+    }
+
+    k_spin_unlock( &lock, key );
+}
+
+bool nce_energy_acct_msg_get( uint32_t index,
+                              struct nce_energy_msg * msg )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    bool found = ( index < history_count ) && ( index < ARRAY_SIZE( history ) );
+
+    if( found )
+    {
+        *msg = history[ ( history_count - 1 - index ) % ARRAY_SIZE( history ) ];
+    }
+
+    k_spin_unlock( &lock, key );
+
+    return found;
+}
+
+bool nce_energy_acct_period_get( bool last,
+                                 struct nce_energy_period * period )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    bool found = !last || has_previous;
+    int64_t now;
+
+    if( last && found )
+    {
+        *period = previous;
+    }
+    else if( found )
+    {
+        now = k_uptime_get();
+        prv_radio_time_add( now );
+        *period = current;
+        period->duration_s = ( uint32_t ) ( now / MSEC_PER_SEC ) - current.start_s;
+        period->charge_nah = prv_period_charge_nah( period );
+    }
+
+    k_spin_unlock( &lock, key );
+
+    return found;
+}
+
+#if defined( CONFIG_NCE_ENERGY_ACCT_SHELL )
+static void prv_shell_period( const struct shell * sh,
+                              const char * name,
+                              const struct nce_energy_period * period )
+{
+    shell_print( sh, "%s period: %u s from %u s, %u messages, %u B payload, %u B sent, %u B received, %u retx",
+                 name, period->duration_s, period->start_s, period->messages, period->payload_bytes,
+                 period->tx_bytes, period->rx_bytes, period->retransmissions );
+    shell_print( sh, "  modem %d kB sent, %d kB received", period->modem_tx_kb, period->modem_rx_kb );
+    shell_print( sh, "  %u ms connected, %u ms idle, %u ms asleep, %u wake-ups, %u.%03u uAh",
+                 period->connected_ms, period->idle_ms, period->sleep_ms, period->wakeups,
+                 period->charge_nah / 1000U, period->charge_nah % 1000U );
+}
+
+static int cmd_energy_show( const struct shell * sh,
+                            size_t argc,
+                            char ** argv )
+{
+    struct nce_energy_period period;
+    struct nce_energy_msg msg;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    ( void ) nce_energy_acct_period_get( false, &period );
+    prv_shell_period( sh, "running", &period );
+
+    if( nce_energy_acct_period_get( true, &period ) )
+    {
+        prv_shell_period( sh, "last", &period );
+    }
+
+    for( uint32_t i = 0; nce_energy_acct_msg_get( i, &msg ); i++ )
+    {
+        shell_print( sh, "message %u: %u B payload, %u B sent, %u B received, %u retx, %u ms connected%s, %u.%03u uAh",
+                     msg.id, msg.payload_bytes, msg.tx_bytes, msg.rx_bytes, msg.retransmissions,
+                     msg.connected_ms, msg.woke_radio ? " (woke radio)" : "",
+                     msg.charge_nah / 1000U, msg.charge_nah % 1000U );
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_energy,
+                                SHELL_CMD( show, NULL, "Show the period totals and the latest message records",
+                                           cmd_energy_show ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( energy, &sub_energy, "Radio energy and byte accounting", NULL );
+#endif /* if defined( CONFIG_NCE_ENERGY_ACCT_SHELL ) */
@@ -0,0 +1,93 @@
+/******************************************************************************
+ * @file    nce_lz.h
+ * @brief   LZSS payload compression with a pre-shared dictionary.
+ * @details The compressed stream is a sequence of groups: one flag byte
+ *          followed by up to eight items, the least significant flag bit
+ *          describing the first item. A clear bit is a literal byte, a set
+ *          bit a two-byte back-reference:
+ *
+ *              byte 0: (distance - 1) >> 4
+ *              byte 1: ((distance - 1) & 0x0f) << 4 | (length - 3)
+ *
+ *          with a distance of 1 to 4096 bytes and a length of 3 to 18
+ *          bytes. References may overlap the bytes they produce and may
+ *          reach back into CONFIG_NCE_LZ_DICTIONARY, which the receiver
+ *          places in front of the output. The stream ends with the input;
+ *          unused bits of the last flag byte are zero.
+ *
+ *          Both directions work on caller buffers and use no heap. The
+ *          compressor does an exhaustive window search, which is meant for
+ *          payloads of a few hundred bytes.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_LZ_H__
+#define NCE_LZ_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compression statistics since boot.
+ */
+struct nce_lz_stats
+{
+    uint32_t payloads;   /**< Payloads passed to nce_lz_compress(). */
+    uint32_t compressed; /**< Payloads that got smaller. */
+    uint32_t bytes_in;   /**< Input bytes of the compressed payloads. */
+    uint32_t bytes_out;  /**< Output bytes of the compressed payloads. */
+};
+
+/**
+ * @brief Compress a payload.
+ *
+ * @param[in]  in       Payload.
+ * @param[in]  in_len   Payload length.
+ * @param[out] out      Destination buffer.
+ * @param[in]  out_size Size of the destination buffer. Pass less than
+ *                      @p in_len to only accept a smaller result.
+ *
+ * @return Compressed length, -ENOSPC if it does not fit in @p out_size.
+ */
+int nce_lz_compress( const uint8_t * in,
+                     size_t in_len,
+                     uint8_t * out,
+                     size_t out_size );
+
+/**
+ * @brief Decompress a payload.
+ *
+ * @param[in]  in       Compressed payload.
+ * @param[in]  in_len   Compressed length.
+ * @param[out] out      Destination buffer.
+ * @param[in]  out_size Size of the destination buffer.
+ *
+ * @return Decompressed length, -ENOSPC if it does not fit in @p out_size,
+ *         -EINVAL if the stream is malformed.
+ */
+int nce_lz_decompress( const uint8_t * in,
+                       size_t in_len,
+                       uint8_t * out,
+                       size_t out_size );
+
+/**
+ * @brief Get the compression statistics.
+ *
+ * @param[out] stats Statistics.
+ */
+void nce_lz_stats_get( struct nce_lz_stats * stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_LZ_H__ */
@@ -0,0 +1,229 @@
+/******************************************************************************
+ * @file    nce_lz.c
+ * @brief   LZSS payload compression with a pre-shared dictionary.
+ * @details See nce_lz.h. The dictionary and the payload are addressed as one
+ *          contiguous history, so matches cross the boundary without copying
+ *          the payload behind the dictionary.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include <nce_lz.h>
+
+LOG_MODULE_REGISTER( nce_lz, CONFIG_NCE_LZ_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define LZ_WINDOW_SIZE    4096
+#define LZ_MIN_MATCH      3
+#define LZ_MAX_MATCH      ( LZ_MIN_MATCH + 15 )
+#define LZ_GROUP_ITEMS    8
+
+/* Only the tail of the dictionary is reachable */
+#define LZ_DICT_LEN       MIN( sizeof( CONFIG_NCE_LZ_DICTIONARY ) - 1, LZ_WINDOW_SIZE )
+#define LZ_DICT           ( &CONFIG_NCE_LZ_DICTIONARY[ sizeof( CONFIG_NCE_LZ_DICTIONARY ) - 1 - LZ_DICT_LEN ] )
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static K_MUTEX_DEFINE( stats_lock );
+static struct nce_lz_stats lz_stats;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Byte @p pos of the dictionary followed by the payload. */
+static inline uint8_t prv_history( const uint8_t * in,
+                                   size_t pos )
+{
+    return ( pos < LZ_DICT_LEN ) ? ( uint8_t ) LZ_DICT[ pos ] : in[ pos - LZ_DICT_LEN ];
+}
+
+/** @brief Find the longest match for the bytes at history position @p pos. */
+static size_t prv_longest_match( const uint8_t * in,
+                                 size_t pos,
+                                 size_t end,
+                                 size_t * distance )
+{
+    size_t max_len = MIN( LZ_MAX_MATCH, end - pos );
+    size_t start = ( pos > LZ_WINDOW_SIZE ) ? pos - LZ_WINDOW_SIZE : 0;
+    size_t best_len = 0;
+
+    /* Nearest candidates first, a tie keeps the shorter distance */
+    for( size_t cand = pos; cand-- > start; )
+    {
+        size_t len = 0;
+
+        while( ( len < max_len ) && ( prv_history( in, cand + len ) == prv_history( in, pos + len ) ) )
+        {
+            len++;
+        }
+
+        if( len > best_len )
+        {
+            best_len = len;
+            *distance = pos - cand;
+
+            if( len == max_len )
+            {
+                break;
+            }
+        }
+    }
+
+    return best_len;
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+int nce_lz_compress( const uint8_t * in,
+                     size_t in_len,
+                     uint8_t * out,
+                     size_t out_size )
+{
+    size_t end = LZ_DICT_LEN + in_len;
+    size_t pos = LZ_DICT_LEN;
+    size_t out_len = 0;
+    size_t flags_pos = 0;
+    uint8_t item = LZ_GROUP_ITEMS;
+
+    while( pos < end )
+    {
+        size_t distance = 0;
+        size_t len = prv_longest_match( in, pos, end, &distance );
+        size_t item_len = ( len >= LZ_MIN_MATCH ) ? 2 : 1;
+
+        if( item == LZ_GROUP_ITEMS )
+        {
+            if( out_len >= out_size )
+            {
+                goto exit_nospace;
+            }
+
+            flags_pos = out_len++;
+            out[ flags_pos ] = 0;
+            item = 0;
+        }
+
+        if( out_len + item_len > out_size )
+        {
+            goto exit_nospace;
+        }
+
+        if( item_len == 2 )
+        {
+            out[ flags_pos ] |= BIT( item );
+            out[ out_len++ ] = ( uint8_t ) ( ( distance - 1 ) >> 4 );
+            out[ out_len++ ] = ( uint8_t ) ( ( ( distance - 1 ) & 0x0f ) << 4 | ( len - LZ_MIN_MATCH ) );
+            pos += len;
+        }
+        else
+        {
+            out[ out_len++ ] = in[ pos - LZ_DICT_LEN ];
+            pos++;
+        }
+
+        item++;
+    }
+
+    k_mutex_lock( &stats_lock, K_FOREVER );
+    lz_stats.payloads++;
+    lz_stats.compressed++;
+    lz_stats.bytes_in += in_len;
+    lz_stats.bytes_out += out_len;
+    k_mutex_unlock( &stats_lock );
+
+    LOG_DBG( "Compressed %u to %u bytes", in_len, out_len );
+
+    return out_len;
+
+exit_nospace:
+    k_mutex_lock( &stats_lock, K_FOREVER );
+    lz_stats.payloads++;
+    k_mutex_unlock( &stats_lock );
+
+    return -ENOSPC;
+}
+
+int nce_lz_decompress( const uint8_t * in,
+                       size_t in_len,
+                       uint8_t * out,
+                       size_t out_size )
+{
+    size_t in_pos = 0;
+    size_t out_len = 0;
+
+    while( in_pos < in_len )
+    {
+        uint8_t flags = in[ in_pos++ ];
+        size_t distance;
+        size_t len;
+
+        for( int item = 0; ( item < LZ_GROUP_ITEMS ) && ( in_pos < in_len ); item++ )
+        {
+            if( ( flags & BIT( item ) ) == 0 )
+            {
+                if( out_len >= out_size )
+                {
+                    return -ENOSPC;
+                }
+
+                out[ out_len++ ] = in[ in_pos++ ];
+                continue;
+            }
+
+            if( in_pos + 2 > in_len )
+            {
+                return -EINVAL;
+            }
+
+            distance = ( ( ( size_t ) in[ in_pos ] << 4 ) | ( in[ in_pos + 1 ] >> 4 ) ) + 1;
+            len = ( in[ in_pos + 1 ] & 0x0f ) + LZ_MIN_MATCH;
+
+            in_pos += 2;
+
+            if( distance > LZ_DICT_LEN + out_len )
+            {
+                return -EINVAL;
+            }
+
+            if( out_len + len > out_size )
+            {
+                return -ENOSPC;
+            }
+
+            /* Byte by byte, the reference may overlap its own output */
+            for( size_t i = 0; i < len; i++, out_len++ )
+            {
+                size_t src = LZ_DICT_LEN + out_len - distance;
+
+                out[ out_len ] = ( src < LZ_DICT_LEN ) ? ( uint8_t ) LZ_DICT[ src ] : out[ src - LZ_DICT_LEN ];
+            }
+        }
+    }
+
+    return out_len;
+}
+
+void nce_lz_stats_get( struct nce_lz_stats * stats )
+{
+    k_mutex_lock( &stats_lock, K_FOREVER );
+    *stats = lz_stats;
+    k_mutex_unlock( &stats_lock );
+}
@@ -0,0 +1,144 @@
+/******************************************************************************
+ * @file    nce_net_io.h
+ * @brief   Poll-driven network I/O thread.
+ * @details One thread owns all application sockets and timers. It sleeps
+ *          until a registered socket is ready, the earliest timer of a
+ *          deadline min-heap expires, or another thread submits work, and
+ *          then runs the corresponding callback. There are no periodic
+ *          wake-ups, so the CPU stays idle between network events. nRF91
+ *          modem sockets get a poll callback (SO_POLLCB) and must not have
+ *          one set by the application.
+ *
+ *          Sockets and timers may only be changed before nce_net_io_start()
+ *          or from callbacks running on the I/O thread. Other threads hand
+ *          work to the I/O thread with nce_net_io_submit().
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_NET_IO_H__
+#define NCE_NET_IO_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct nce_net_io_timer;
+
+/** @brief Timer expiry callback, runs on the I/O thread. */
+typedef void (* nce_net_io_timer_fn_t)( struct nce_net_io_timer * timer );
+
+/** @brief Socket readiness callback, runs on the I/O thread. */
+typedef void (* nce_net_io_socket_fn_t)( int fd,
+                                         int revents,
+                                         void * user_data );
+
+/** @brief Submitted work callback, runs on the I/O thread. */
+typedef void (* nce_net_io_submit_fn_t)( void * user_data );
+
+/**
+ * @brief One-shot timer. Embed it in a larger struct to carry context.
+ */
+struct nce_net_io_timer
+{
+    nce_net_io_timer_fn_t fn;
+    int64_t deadline_ms;
+    int heap_index; /**< Position in the deadline heap, -1 when not pending. */
+};
+
+/**
+ * @brief Initialize a timer.
+ *
+ * @param[out] timer Timer to initialize.
+ * @param[in]  fn    Expiry callback.
+ */
+void nce_net_io_timer_init( struct nce_net_io_timer * timer,
+                            nce_net_io_timer_fn_t fn );
+
+/**
+ * @brief Start or restart a timer.
+ *
+ * @param[in] timer Timer to start. A pending timer is rescheduled.
+ * @param[in] delay Delay from now, K_FOREVER is not allowed.
+ *
+ * @return 0 on success, -ENOMEM if CONFIG_NCE_NET_IO_MAX_TIMERS are pending,
+ *         -EINVAL for K_FOREVER.
+ */
+int nce_net_io_timer_start( struct nce_net_io_timer * timer,
+                            k_timeout_t delay );
+
+/**
+ * @brief Stop a timer. Stopping a timer that is not pending has no effect.
+ *
+ * @param[in] timer Timer to stop.
+ */
+void nce_net_io_timer_stop( struct nce_net_io_timer * timer );
+
+/**
+ * @brief Check whether a timer is pending.
+ *
+ * @param[in] timer Timer to check.
+ *
+ * @return true if the timer is scheduled.
+ */
+static inline bool nce_net_io_timer_is_pending( const struct nce_net_io_timer * timer )
+{
+    return timer->heap_index >= 0;
+}
+
+/**
+ * @brief Watch a socket.
+ *
+ * @param[in] fd        Socket.
+ * @param[in] events    ZSOCK_POLLIN and/or ZSOCK_POLLOUT.
+ * @param[in] fn        Callback run when the socket is ready or has an error.
+ * @param[in] user_data Passed to @p fn.
+ *
+ * @return 0 on success, -ENOMEM if CONFIG_NCE_NET_IO_MAX_SOCKETS are watched,
+ *         -EALREADY if the socket is already watched.
+ */
+int nce_net_io_socket_add( int fd,
+                           short events,
+                           nce_net_io_socket_fn_t fn,
+                           void * user_data );
+
+/**
+ * @brief Stop watching a socket. Call before closing it.
+ *
+ * @param[in] fd Socket.
+ *
+ * @return 0 on success, -ENOENT if the socket is not watched.
+ */
+int nce_net_io_socket_remove( int fd );
+
+/**
+ * @brief Run a function on the I/O thread. Safe to call from any thread.
+ *
+ * @param[in] fn        Function to run.
+ * @param[in] user_data Passed to @p fn.
+ *
+ * @return 0 on success, -ENOMEM if the submission queue is full.
+ */
+int nce_net_io_submit( nce_net_io_submit_fn_t fn,
+                       void * user_data );
+
+/**
+ * @brief Start the I/O thread.
+ *
+ * @return 0 on success, negative error code if the doorbell cannot be created.
+ */
+int nce_net_io_start( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_NET_IO_H__ */
@@ -0,0 +1,529 @@
+/******************************************************************************
+ * @file    nce_net_io.c
+ * @brief   Poll-driven network I/O thread.
+ * @details See nce_net_io.h. Submissions are queued in a k_msgq and raise
+ *          a k_poll_signal. nRF91 modem sockets cannot be polled together
+ *          with a native file descriptor, so with them the thread waits in
+ *          k_poll() on the signal, which the modem library raises as well
+ *          through a poll callback on every socket, and then looks up the
+ *          ready sockets with a zsock_poll() that does not block. Native
+ *          sockets are polled together with an eventfd that submissions
+ *          write to. Timers are kept in a binary min-heap on their deadline;
+ *          the wait ends when the root expires.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <limits.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/socket.h>
+
+#if defined( CONFIG_NET_SOCKETS_OFFLOAD ) && defined( CONFIG_NRF_MODEM_LIB )
+    #define NET_IO_MODEM_SOCKETS    1
+    #include <zephyr/net/socket_ncs.h>
+    #include <nrf_socket.h>
+#else
+    #include <zephyr/zvfs/eventfd.h>
+#endif /* if defined( CONFIG_NET_SOCKETS_OFFLOAD ) && defined( CONFIG_NRF_MODEM_LIB ) */
+
+#include <nce_net_io.h>
+
+LOG_MODULE_REGISTER( nce_net_io, CONFIG_NCE_NET_IO_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#if defined( NET_IO_MODEM_SOCKETS )
+    #define FIRST_SOCKET_FD    0
+#else
+    #define FIRST_SOCKET_FD    1 /* fds[ 0 ] is the doorbell */
+#endif /* if defined( NET_IO_MODEM_SOCKETS ) */
+
+#define POLL_FDS_MAX           ( CONFIG_NCE_NET_IO_MAX_SOCKETS + FIRST_SOCKET_FD )
+
+/******************************************************************************
+* Types
+******************************************************************************/
+struct net_io_socket
+{
+    int fd;
+    short events;
+    nce_net_io_socket_fn_t fn;
+    void * user_data;
+};
+
+struct net_io_submission
+{
+    nce_net_io_submit_fn_t fn;
+    void * user_data;
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+K_THREAD_STACK_DEFINE( net_io_stack, CONFIG_NCE_NET_IO_STACK_SIZE );
+static struct k_thread net_io_thread;
+static k_tid_t net_io_tid;
+
+K_MSGQ_DEFINE( net_io_submit_q, sizeof( struct net_io_submission ),
+               CONFIG_NCE_NET_IO_SUBMIT_QUEUE_DEPTH, 4 );
+static struct k_poll_signal net_io_signal = K_POLL_SIGNAL_INITIALIZER( net_io_signal );
+#if !defined( NET_IO_MODEM_SOCKETS )
+static int doorbell_fd = -1;
+#endif /* if !defined( NET_IO_MODEM_SOCKETS ) */
+
+static struct net_io_socket sockets[ CONFIG_NCE_NET_IO_MAX_SOCKETS ] =
+{
+    [ 0 ... CONFIG_NCE_NET_IO_MAX_SOCKETS - 1 ] = { .fd = -1 }
+};
+
+static struct nce_net_io_timer * timer_heap[ CONFIG_NCE_NET_IO_MAX_TIMERS ];
+static int timer_count;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+/** @brief Sockets and timers belong to the I/O thread once it runs. */
+static inline void prv_assert_owner( void )
+{
+    __ASSERT( ( net_io_tid == NULL ) || ( k_current_get() == net_io_tid ),
+              "nce_net_io sockets and timers must be changed from the I/O thread" );
+}
+
+static void prv_heap_place( int index,
+                            struct nce_net_io_timer * timer )
+{
+    timer_heap[ index ] = timer;
+    timer->heap_index = index;
+}
+
+static void prv_heap_sift_up( int index )
+{
+    struct nce_net_io_timer * timer = timer_heap[ index ];
+
+    while( index > 0 )
+    {
+        int parent = ( index - 1 ) / 2;
+
+        if( timer_heap[ parent ]->deadline_ms <= timer->deadline_ms )
+        {
+            break;
+        }
+
+        prv_heap_place( index, timer_heap[ parent ] );
+        index = parent;
+    }
+
+    prv_heap_place( index, timer );
+}
+
+static void prv_heap_sift_down( int index )
+{
+    struct nce_net_io_timer * timer = timer_heap[ index ];
+
+    for( ; ; )
+    {
+        int child = ( 2 * index ) + 1;
+
+        if( child >= timer_count )
+        {
+            break;
+        }
+
+        if( ( child + 1 < timer_count ) &&
+            ( timer_heap[ child + 1 ]->deadline_ms < timer_heap[ child ]->deadline_ms ) )
+        {
+            child++;
+        }
+
+        if( timer->deadline_ms <= timer_heap[ child ]->deadline_ms )
+        {
+            break;
+        }
+
+        prv_heap_place( index, timer_heap[ child ] );
+        index = child;
+    }
+
+    prv_heap_place( index, timer );
+}
+
+static void prv_heap_remove( struct nce_net_io_timer * timer )
+{
+    int index = timer->heap_index;
+    struct nce_net_io_timer * last = timer_heap[ --timer_count ];
+
+    timer->heap_index = -1;
+
+    if( last == timer )
+    {
+        return;
+    }
+
+    prv_heap_place( index, last );
+    prv_heap_sift_up( index );
+    prv_heap_sift_down( last->heap_index );
+}
+
+static int prv_poll_timeout_ms( void )
+{
+    int64_t remaining;
+
+    if( timer_count == 0 )
+    {
+        return -1; /* Sleep until a socket or a submission wakes us up */
+    }
+
+    remaining = timer_heap[ 0 ]->deadline_ms - k_uptime_get();
+
+    return ( int ) CLAMP( remaining, 0, INT_MAX );
+}
+
+/** @brief Wait for a submission or a modem poll callback, at most @p timeout_ms (-1 forever). */
+static void prv_wait_signal( int timeout_ms )
+{
+    struct k_poll_event event = K_POLL_EVENT_INITIALIZER( K_POLL_TYPE_SIGNAL, K_POLL_MODE_NOTIFY_ONLY,
+                                                          &net_io_signal );
+
+    ( void ) k_poll( &event, 1, ( timeout_ms < 0 ) ? K_FOREVER : K_MSEC( timeout_ms ) );
+
+    /* Raised again by anything that arrives from here on */
+    k_poll_signal_reset( &net_io_signal );
+}
+
+#if defined( NET_IO_MODEM_SOCKETS )
+/** @brief Modem library poll callback, may run in interrupt context. */
+static void prv_modem_pollcb( struct nrf_pollfd * pollfd )
+{
+    ARG_UNUSED( pollfd );
+
+    /* The I/O thread looks up which socket is ready */
+    k_poll_signal_raise( &net_io_signal, 0 );
+}
+#endif /* if defined( NET_IO_MODEM_SOCKETS ) */
+
+static void prv_run_submissions( void )
+{
+    struct net_io_submission submission;
+
+    #if !defined( NET_IO_MODEM_SOCKETS )
+    zvfs_eventfd_t value;
+
+    ( void ) zvfs_eventfd_read( doorbell_fd, &value );
+    #endif /* if !defined( NET_IO_MODEM_SOCKETS ) */
+
+    while( k_msgq_get( &net_io_submit_q, &submission, K_NO_WAIT ) == 0 )
+    {
+        submission.fn( submission.user_data );
+    }
+}
+
+static void prv_run_timers( void )
+{
+    int64_t now = k_uptime_get();
+
+    /* Only run the timers that were due on entry, so a callback restarting
+     * its timer with no delay cannot starve the sockets */
+    for( int budget = timer_count; ( budget > 0 ) && ( timer_count > 0 ); budget-- )
+    {
+        struct nce_net_io_timer * timer = timer_heap[ 0 ];
+
+        if( timer->deadline_ms > now )
+        {
+            break;
+        }
+
+        prv_heap_remove( timer );
+        timer->fn( timer );
+    }
+}
+
+/** @brief Add the registered sockets to the poll set from index FIRST_SOCKET_FD on. */
+static int prv_fill_fds( struct zsock_pollfd * fds,
+                         int * slot_of )
+{
+    int nfds = FIRST_SOCKET_FD;
+
+    for( int i = 0; i < CONFIG_NCE_NET_IO_MAX_SOCKETS; i++ )
+    {
+        if( sockets[ i ].fd < 0 )
+        {
+            continue;
+        }
+
+        fds[ nfds ].fd = sockets[ i ].fd;
+        fds[ nfds ].events = sockets[ i ].events;
+        fds[ nfds ].revents = 0;
+        slot_of[ nfds ] = i;
+        nfds++;
+    }
+
+    return nfds;
+}
+
+/** @brief Run the callbacks of the ready sockets, returns true if any was ready. */
+static bool prv_run_sockets( const struct zsock_pollfd * fds,
+                             const int * slot_of,
+                             int nfds )
+{
+    bool ready = false;
+
+    for( int i = FIRST_SOCKET_FD; i < nfds; i++ )
+    {
+        struct net_io_socket * sock = &sockets[ slot_of[ i ] ];
+
+        /* Skip sockets removed by an earlier callback of this round */
+        if( ( fds[ i ].revents == 0 ) || ( sock->fd != fds[ i ].fd ) )
+        {
+            continue;
+        }
+
+        ready = true;
+        sock->fn( sock->fd, fds[ i ].revents, sock->user_data );
+    }
+
+    return ready;
+}
+
+static void prv_net_io_thread_fn( void * p1,
+                                  void * p2,
+                                  void * p3 )
+{
+    struct zsock_pollfd fds[ POLL_FDS_MAX ];
+    int slot_of[ POLL_FDS_MAX ];
+    bool ready = false;
+
+    ARG_UNUSED( p1 );
+    ARG_UNUSED( p2 );
+    ARG_UNUSED( p3 );
+
+    for( ; ; )
+    {
+        int nfds;
+        int ret;
+
+        #if defined( NET_IO_MODEM_SOCKETS )
+        /* A callback may leave data behind, look again before sleeping */
+        prv_wait_signal( ready ? 0 : prv_poll_timeout_ms() );
+        nfds = prv_fill_fds( fds, slot_of );
+        ret = ( nfds > 0 ) ? zsock_poll( fds, nfds, 0 ) : 0;
+        #else
+        fds[ 0 ].fd = doorbell_fd;
+        fds[ 0 ].events = ZSOCK_POLLIN;
+        fds[ 0 ].revents = 0;
+        nfds = prv_fill_fds( fds, slot_of );
+        ret = zsock_poll( fds, nfds, prv_poll_timeout_ms() );
+        #endif /* if defined( NET_IO_MODEM_SOCKETS ) */
+
+        ready = false;
+
+        if( ret < 0 )
+        {
+            LOG_ERR( "zsock_poll() failed, errno: %d", errno );
+
+            #if !defined( NET_IO_MODEM_SOCKETS )
+            /* Sockets are skipped this round, submissions and timers still run */
+            prv_wait_signal( prv_poll_timeout_ms() );
+            #endif /* if !defined( NET_IO_MODEM_SOCKETS ) */
+        }
+
+        prv_run_submissions();
+
+        if( ret > 0 )
+        {
+            ready = prv_run_sockets( fds, slot_of, nfds );
+        }
+
+        prv_run_timers();
+    }
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_net_io_timer_init( struct nce_net_io_timer * timer,
+                            nce_net_io_timer_fn_t fn )
+{
+    timer->fn = fn;
+    timer->deadline_ms = 0;
+    timer->heap_index = -1;
+}
+
+int nce_net_io_timer_start( struct nce_net_io_timer * timer,
+                            k_timeout_t delay )
+{
+    prv_assert_owner();
+
+    if( K_TIMEOUT_EQ( delay, K_FOREVER ) )
+    {
+        return -EINVAL;
+    }
+
+    if( nce_net_io_timer_is_pending( timer ) )
+    {
+        prv_heap_remove( timer );
+    }
+
+    if( timer_count >= CONFIG_NCE_NET_IO_MAX_TIMERS )
+    {
+        LOG_ERR( "Timer heap full, increase CONFIG_NCE_NET_IO_MAX_TIMERS" );
+        return -ENOMEM;
+    }
+
+    timer->deadline_ms = k_uptime_get() + k_ticks_to_ms_ceil64( delay.ticks );
+    timer_heap[ timer_count ] = timer;
+    timer->heap_index = timer_count;
+    timer_count++;
+    prv_heap_sift_up( timer->heap_index );
+
+    return 0;
+}
+
+void nce_net_io_timer_stop( struct nce_net_io_timer * timer )
+{
+    prv_assert_owner();
+
+    if( nce_net_io_timer_is_pending( timer ) )
+    {
+        prv_heap_remove( timer );
+    }
+}
+
+int nce_net_io_socket_add( int fd,
+                           short events,
+                           nce_net_io_socket_fn_t fn,
+                           void * user_data )
+{
+    struct net_io_socket * free_slot = NULL;
+
+    prv_assert_owner();
+
+    for( int i = 0; i < CONFIG_NCE_NET_IO_MAX_SOCKETS; i++ )
+    {
+        if( sockets[ i ].fd == fd )
+        {
+            return -EALREADY;
+        }
+
+        if( ( sockets[ i ].fd < 0 ) && ( free_slot == NULL ) )
+        {
+            free_slot = &sockets[ i ];
+        }
+    }
+
+    if( free_slot == NULL )
+    {
+        LOG_ERR( "Socket table full, increase CONFIG_NCE_NET_IO_MAX_SOCKETS" );
+        return -ENOMEM;
+    }
+
+    #if defined( NET_IO_MODEM_SOCKETS )
+    /* Wakes the thread from k_poll(), stays registered until the socket is closed */
+    struct nrf_modem_pollcb pollcb =
+    {
+        .callback = prv_modem_pollcb,
+        .events   = events,
+        .oneshot  = false,
+    };
+
+    if( zsock_setsockopt( fd, SOL_SOCKET, SO_POLLCB, &pollcb, sizeof( pollcb ) ) < 0 )
+    {
+        LOG_ERR( "Failed to set the poll callback of socket %d, errno: %d", fd, errno );
+        return -errno;
+    }
+    #endif /* if defined( NET_IO_MODEM_SOCKETS ) */
+
+    free_slot->events = events;
+    free_slot->fn = fn;
+    free_slot->user_data = user_data;
+    free_slot->fd = fd;
+
+    return 0;
+}
+
+int nce_net_io_socket_remove( int fd )
+{
+    prv_assert_owner();
+
+    for( int i = 0; i < CONFIG_NCE_NET_IO_MAX_SOCKETS; i++ )
+    {
+        if( sockets[ i ].fd == fd )
+        {
+            sockets[ i ].fd = -1;
+            return 0;
+        }
+    }
+
+    return -ENOENT;
+}
+
+int nce_net_io_submit( nce_net_io_submit_fn_t fn,
+                       void * user_data )
+{
+    struct net_io_submission submission =
+    {
+        .fn        = fn,
+        .user_data = user_data,
+    };
+
+    if( k_msgq_put( &net_io_submit_q, &submission, K_NO_WAIT ) )
+    {
+        LOG_WRN( "Submission queue full" );
+        return -ENOMEM;
+    }
+
+    k_poll_signal_raise( &net_io_signal, 0 );
+
+    #if !defined( NET_IO_MODEM_SOCKETS )
+    if( doorbell_fd >= 0 )
+    {
+        ( void ) zvfs_eventfd_write( doorbell_fd, 1 );
+    }
+    #endif /* if !defined( NET_IO_MODEM_SOCKETS ) */
+
+    return 0;
+}
+
+int nce_net_io_start( void )
+{
+    if( net_io_tid != NULL )
+    {
+        return -EALREADY;
+    }
+
+    #if !defined( NET_IO_MODEM_SOCKETS )
+    doorbell_fd = zvfs_eventfd( 0, ZVFS_EFD_NONBLOCK );
+
+    if( doorbell_fd < 0 )
+    {
+        LOG_ERR( "Failed to create the I/O thread doorbell, errno: %d", errno );
+        return -errno;
+    }
+    #endif /* if !defined( NET_IO_MODEM_SOCKETS ) */
+
+    net_io_tid = k_thread_create( &net_io_thread, net_io_stack,
+                                  K_THREAD_STACK_SIZEOF( net_io_stack ),
+                                  prv_net_io_thread_fn, NULL, NULL, NULL,
+                                  CONFIG_NCE_NET_IO_THREAD_PRIORITY, 0, K_FOREVER );
+    k_thread_name_set( net_io_tid, "net_io" );
+    k_thread_start( net_io_tid );
+
+    #if !defined( NET_IO_MODEM_SOCKETS )
+    /* Work submitted before the doorbell existed */
+    if( k_msgq_num_used_get( &net_io_submit_q ) > 0 )
+    {
+        ( void ) zvfs_eventfd_write( doorbell_fd, 1 );
+    }
+    #endif /* if !defined( NET_IO_MODEM_SOCKETS ) */
+
+    return 0;
+}
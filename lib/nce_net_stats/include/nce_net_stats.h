@@ -0,0 +1,141 @@
+/******************************************************************************
+ * @file    nce_net_stats.h
+ * @brief   Networking counters and hot-path log tier.
+ * @details Hot paths count messages, bytes, errors and retries with atomic
+ *          increments instead of logging every message. The per-message log
+ *          lines and payload dumps go through NCE_NET_LOG_INF() and
+ *          NCE_NET_LOG_HEXDUMP_INF(): without CONFIG_NCE_NET_LOG_VERBOSE they
+ *          are compiled out, otherwise they are emitted while the runtime
+ *          switch is on. The macros expand to the caller's log module.
+ *
+ *          The CPU time of a hot path is measured in hardware cycles between
+ *          nce_net_stats_time_begin() and nce_net_stats_time_end(), which
+ *          includes the time the thread is preempted.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_NET_STATS_H__
+#define NCE_NET_STATS_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Counters. */
+enum nce_net_stat
+{
+    NCE_NET_STAT_TX_MSGS,   /**< Messages handed to the network. */
+    NCE_NET_STAT_TX_BYTES,  /**< Payload bytes of those messages. */
+    NCE_NET_STAT_TX_ERRORS, /**< Sends that failed or were not acknowledged. */
+    NCE_NET_STAT_RX_MSGS,   /**< Messages received. */
+    NCE_NET_STAT_RX_BYTES,  /**< Bytes of those messages. */
+    NCE_NET_STAT_RX_ERRORS, /**< Receive or parse errors. */
+    NCE_NET_STAT_RETRIES,   /**< Connection attempts after a failure. */
+    NCE_NET_STAT_RX_DUPS,   /**< Duplicate requests that were not handled again. */
+    NCE_NET_STAT_COUNT
+};
+
+/** @brief Timing of a measured hot path. */
+struct nce_net_stats_timing
+{
+    uint32_t count;  /**< Measured runs. */
+    uint32_t avg_us; /**< Average duration in microseconds. */
+    uint32_t max_us; /**< Longest duration in microseconds. */
+};
+
+#if defined( CONFIG_NCE_NET_LOG_VERBOSE )
+    #define NCE_NET_LOG_VERBOSE_ENABLED()    nce_net_log_verbose()
+#else
+    #define NCE_NET_LOG_VERBOSE_ENABLED()    false
+#endif /* if defined( CONFIG_NCE_NET_LOG_VERBOSE ) */
+
+/** @brief LOG_INF() of the verbose tier. */
+#define NCE_NET_LOG_INF( ... )                     \
+        do {                                       \
+            if( NCE_NET_LOG_VERBOSE_ENABLED() )    \
+            {                                      \
+                LOG_INF( __VA_ARGS__ );            \
+            }                                      \
+        } while( 0 )
+
+/** @brief LOG_HEXDUMP_INF() of the verbose tier. */
+#define NCE_NET_LOG_HEXDUMP_INF( data, len, str )    \
+        do {                                         \
+            if( NCE_NET_LOG_VERBOSE_ENABLED() )      \
+            {                                        \
+                LOG_HEXDUMP_INF( data, len, str );   \
+            }                                        \
+        } while( 0 )
+
+/**
+ * @brief Add to a counter.
+ *
+ * @param[in] stat  Counter.
+ * @param[in] value Value to add.
+ */
+void nce_net_stats_add( enum nce_net_stat stat,
+                        uint32_t value );
+
+/** @brief Increment a counter. */
+static inline void nce_net_stats_inc( enum nce_net_stat stat )
+{
+    nce_net_stats_add( stat, 1 );
+}
+
+/**
+ * @brief Read a counter.
+ *
+ * @param[in] stat Counter.
+ *
+ * @return Counter value since boot or the last reset.
+ */
+uint32_t nce_net_stats_get( enum nce_net_stat stat );
+
+/** @brief Start measuring a hot path. */
+static inline uint32_t nce_net_stats_time_begin( void )
+{
+    return k_cycle_get_32();
+}
+
+/**
+ * @brief Stop measuring a hot path.
+ *
+ * @param[in] start Value returned by nce_net_stats_time_begin().
+ */
+void nce_net_stats_time_end( uint32_t start );
+
+/**
+ * @brief Get the timing of the measured hot path.
+ *
+ * @param[out] timing Timing.
+ */
+void nce_net_stats_timing_get( struct nce_net_stats_timing * timing );
+
+/** @brief Clear all counters and the timing. */
+void nce_net_stats_reset( void );
+
+/** @brief Check whether the verbose logs are switched on. */
+bool nce_net_log_verbose( void );
+
+/**
+ * @brief Switch the verbose logs on or off.
+ *
+ * @param[in] on New state, ignored without CONFIG_NCE_NET_LOG_VERBOSE.
+ */
+void nce_net_log_verbose_set( bool on );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_NET_STATS_H__ */
@@ -0,0 +1,183 @@
+/******************************************************************************
+ * @file    nce_net_stats.c
+ * @brief   Networking counters and hot-path log tier.
+ * @details See nce_net_stats.h. Counters are plain atomics, so they can be
+ *          updated from any thread without a lock.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/shell/shell.h>
+
+#include <nce_net_stats.h>
+
+LOG_MODULE_REGISTER( nce_net_stats, CONFIG_NCE_NET_STATS_LOG_LEVEL );
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static atomic_t counters[ NCE_NET_STAT_COUNT ];
+static atomic_t verbose = ATOMIC_INIT( IS_ENABLED( CONFIG_NCE_NET_LOG_VERBOSE_DEFAULT ) );
+
+static struct k_spinlock timing_lock;
+static uint64_t timing_total_cycles;
+static uint32_t timing_max_cycles;
+static uint32_t timing_count;
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_net_stats_add( enum nce_net_stat stat,
+                        uint32_t value )
+{
+    if( stat < NCE_NET_STAT_COUNT )
+    {
+        ( void ) atomic_add( &counters[ stat ], ( atomic_val_t ) value );
+    }
+}
+
+uint32_t nce_net_stats_get( enum nce_net_stat stat )
+{
+    return ( stat < NCE_NET_STAT_COUNT ) ? ( uint32_t ) atomic_get( &counters[ stat ] ) : 0;
+}
+
+void nce_net_stats_time_end( uint32_t start )
+{
+    uint32_t cycles = k_cycle_get_32() - start;
+    k_spinlock_key_t key = k_spin_lock( &timing_lock );
+
+    timing_total_cycles += cycles;
+    timing_max_cycles = MAX( timing_max_cycles, cycles );
+    timing_count++;
+
+    k_spin_unlock( &timing_lock, key );
+}
+
+void nce_net_stats_timing_get( struct nce_net_stats_timing * timing )
+{
+    k_spinlock_key_t key = k_spin_lock( &timing_lock );
+    uint64_t avg = ( timing_count > 0 ) ? timing_total_cycles / timing_count : 0;
+
+    timing->count = timing_count;
+    timing->avg_us = k_cyc_to_us_floor32( ( uint32_t ) avg );
+    timing->max_us = k_cyc_to_us_floor32( timing_max_cycles );
+
+    k_spin_unlock( &timing_lock, key );
+}
+
+void nce_net_stats_reset( void )
+{
+    k_spinlock_key_t key;
+
+    for( int i = 0; i < NCE_NET_STAT_COUNT; i++ )
+    {
+        atomic_clear( &counters[ i ] );
+    }
+
+    key = k_spin_lock( &timing_lock );
+    timing_total_cycles = 0;
+    timing_max_cycles = 0;
+    timing_count = 0;
+    k_spin_unlock( &timing_lock, key );
+}
+
+bool nce_net_log_verbose( void )
+{
+    return atomic_get( &verbose ) != 0;
+}
+
+void nce_net_log_verbose_set( bool on )
+{
+    if( IS_ENABLED( CONFIG_NCE_NET_LOG_VERBOSE ) )
+    {
+        atomic_set( &verbose, on );
+    }
+}
+
+#if defined( CONFIG_NCE_NET_STATS_SHELL )
+static int cmd_net_stats_show( const struct shell * sh,
+                               size_t argc,
+                               char ** argv )
+{
+    struct nce_net_stats_timing timing;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    nce_net_stats_timing_get( &timing );
+
+    shell_print( sh, "tx messages: %u", nce_net_stats_get( NCE_NET_STAT_TX_MSGS ) );
+    shell_print( sh, "tx bytes:    %u", nce_net_stats_get( NCE_NET_STAT_TX_BYTES ) );
+    shell_print( sh, "tx errors:   %u", nce_net_stats_get( NCE_NET_STAT_TX_ERRORS ) );
+    shell_print( sh, "rx messages: %u", nce_net_stats_get( NCE_NET_STAT_RX_MSGS ) );
+    shell_print( sh, "rx bytes:    %u", nce_net_stats_get( NCE_NET_STAT_RX_BYTES ) );
+    shell_print( sh, "rx errors:   %u", nce_net_stats_get( NCE_NET_STAT_RX_ERRORS ) );
+    shell_print( sh, "retries:     %u", nce_net_stats_get( NCE_NET_STAT_RETRIES ) );
+    shell_print( sh, "rx dups:     %u", nce_net_stats_get( NCE_NET_STAT_RX_DUPS ) );
+    shell_print( sh, "uplink cpu:  avg %u us, max %u us (%u runs)", timing.avg_us, timing.max_us, timing.count );
+    shell_print( sh, "verbose:     %s", nce_net_log_verbose() ? "on" : "off" );
+
+    return 0;
+}
+
+static int cmd_net_stats_reset( const struct shell * sh,
+                                size_t argc,
+                                char ** argv )
+{
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    nce_net_stats_reset();
+    shell_print( sh, "Counters cleared" );
+
+    return 0;
+}
+
+static int cmd_net_stats_verbose( const struct shell * sh,
+                                  size_t argc,
+                                  char ** argv )
+{
+    ARG_UNUSED( argc );
+
+    if( !IS_ENABLED( CONFIG_NCE_NET_LOG_VERBOSE ) )
+    {
+        shell_error( sh, "Verbose logs are not compiled in (CONFIG_NCE_NET_LOG_VERBOSE)" );
+        return -ENOTSUP;
+    }
+
+    if( strcmp( argv[ 1 ], "on" ) == 0 )
+    {
+        nce_net_log_verbose_set( true );
+    }
+    else if( strcmp( argv[ 1 ], "off" ) == 0 )
+    {
+        nce_net_log_verbose_set( false );
+    }
+    else
+    {
+        shell_error( sh, "Expected on or off" );
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_net_stats,
+                                SHELL_CMD( show, NULL, "Show networking counters", cmd_net_stats_show ),
+                                SHELL_CMD( reset, NULL, "Clear networking counters", cmd_net_stats_reset ),
+                                SHELL_CMD_ARG( verbose, NULL, "Switch verbose hot-path logs <on|off>",
+                                               cmd_net_stats_verbose, 2, 0 ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( net_stats, &sub_net_stats, "Networking counters", NULL );
+#endif /* if defined( CONFIG_NCE_NET_STATS_SHELL ) */
@@ -0,0 +1,111 @@
+/******************************************************************************
+ * @file    nce_radio_sched.h
+ * @brief   Transmission scheduling aligned with the modem's radio windows.
+ * @details Tracks the RRC state, modem sleep and the negotiated PSM and eDRX
+ *          timers from the LTE link controller. A send while the modem is in
+ *          PSM or eDRX sleep wakes it and sets up a new RRC connection; a send
+ *          while it is connected, or right when it wakes for a TAU or paging
+ *          window, rides on radio activity that happens anyway.
+ *
+ *          nce_radio_sched_delay() tells a sender how long to hold a
+ *          deferrable transmission back: not at all while the radio is
+ *          awake, until the modem leaves sleep if that is soon enough, and
+ *          at most the sender's own limit. Listeners are told when a window
+ *          opens early, e.g. for a downlink or another sender's traffic, so
+ *          held back transmissions can go with it. Urgent transmissions do
+ *          not ask and are sent at once.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_RADIO_SCHED_H__
+#define NCE_RADIO_SCHED_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Radio state as reported by the link controller. */
+enum nce_radio_state
+{
+    NCE_RADIO_STATE_UNKNOWN,   /**< Not registered, or no event seen yet. */
+    NCE_RADIO_STATE_CONNECTED, /**< RRC connected, sending is cheap. */
+    NCE_RADIO_STATE_IDLE,      /**< RRC idle, receiver on (PSM active time or between eDRX sleeps). */
+    NCE_RADIO_STATE_SLEEP,     /**< PSM or eDRX sleep, sending wakes the modem. */
+};
+
+/** @brief Radio state, timers and statistics. */
+struct nce_radio_sched_info
+{
+    enum nce_radio_state state;
+    int64_t wake_in_ms;     /**< Time until the modem leaves sleep, -1 if not sleeping. */
+    int psm_tau_s;          /**< Granted periodic TAU (T3412), -1 if PSM is not granted. */
+    int psm_active_s;       /**< Granted active time (T3324), -1 if PSM is not granted. */
+    uint32_t edrx_ms;       /**< Granted eDRX cycle, 0 if eDRX is not granted. */
+    uint32_t ptw_ms;        /**< Granted paging time window. */
+    uint32_t windows;       /**< Radio windows opened since boot. */
+    uint32_t deferrals;     /**< Transmissions held back since boot. */
+    uint32_t deferred_ms;   /**< Total delay handed out. */
+};
+
+struct nce_radio_sched_listener;
+
+/**
+ * @brief A radio window opened.
+ *
+ * Runs in the context of the link controller event. Hand the work to the
+ * sender's thread.
+ */
+typedef void (* nce_radio_sched_window_t)( struct nce_radio_sched_listener * listener );
+
+/** @brief Window listener, treat as opaque apart from the callback. */
+struct nce_radio_sched_listener
+{
+    sys_snode_t node;
+    nce_radio_sched_window_t window;
+};
+
+/**
+ * @brief Register a listener for opening radio windows.
+ *
+ * Listeners are never removed.
+ *
+ * @param[in] listener Listener with the callback set, must stay valid.
+ */
+void nce_radio_sched_listen( struct nce_radio_sched_listener * listener );
+
+/**
+ * @brief Get the delay before a deferrable transmission.
+ *
+ * @param[in] max_defer_ms Longest the sender accepts to wait.
+ *
+ * @return K_NO_WAIT if the radio is awake or its state is unknown, else the
+ *         time until the modem leaves sleep, limited to @p max_defer_ms.
+ */
+k_timeout_t nce_radio_sched_delay( uint32_t max_defer_ms );
+
+/**
+ * @brief Read the radio state, timers and statistics.
+ */
+void nce_radio_sched_info_get( struct nce_radio_sched_info * info );
+
+/**
+ * @brief Name of a radio state, for logs.
+ */
+const char * nce_radio_sched_state_name( enum nce_radio_state state );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_RADIO_SCHED_H__ */
@@ -0,0 +1,244 @@
+/******************************************************************************
+ * @file    nce_radio_sched.c
+ * @brief   Transmission scheduling aligned with the modem's radio windows.
+ * @details See nce_radio_sched.h. The state is only written by the link
+ *          controller handler and read under a spinlock by the senders.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <modem/lte_lc.h>
+
+#include <nce_radio_sched.h>
+
+LOG_MODULE_REGISTER( nce_radio_sched, CONFIG_NCE_RADIO_SCHED_LOG_LEVEL );
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct k_spinlock lock;
+static sys_slist_t listeners = SYS_SLIST_STATIC_INIT( &listeners );
+static enum nce_radio_state state;
+static int64_t wake_at;
+static struct nce_radio_sched_info info =
+{
+    .psm_tau_s    = -1,
+    .psm_active_s = -1,
+};
+
+static const char * const state_names[] =
+{
+    [ NCE_RADIO_STATE_UNKNOWN ]   = "unknown",
+    [ NCE_RADIO_STATE_CONNECTED ] = "connected",
+    [ NCE_RADIO_STATE_IDLE ]      = "idle",
+    [ NCE_RADIO_STATE_SLEEP ]     = "sleep",
+};
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Set the radio state, tell the listeners if a window opened. */
+static void prv_state_set( enum nce_radio_state new_state,
+                           int64_t sleep_ms )
+{
+    struct nce_radio_sched_listener * listener;
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    enum nce_radio_state old_state = state;
+    bool window;
+
+    state = new_state;
+    wake_at = ( new_state == NCE_RADIO_STATE_SLEEP ) ? k_uptime_get() + sleep_ms : 0;
+
+    /* Leaving sleep or setting up a connection: the radio is active anyway */
+    window = ( ( new_state == NCE_RADIO_STATE_CONNECTED ) && ( old_state != NCE_RADIO_STATE_CONNECTED ) ) ||
+             ( ( old_state == NCE_RADIO_STATE_SLEEP ) && ( new_state != NCE_RADIO_STATE_SLEEP ) );
+
+    if( window )
+    {
+        info.windows++;
+    }
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "Radio %s -> %s", state_names[ old_state ], state_names[ new_state ] );
+
+    if( !window )
+    {
+        return;
+    }
+
+    /* Listeners are only appended, the list can be walked without the lock */
+    SYS_SLIST_FOR_EACH_CONTAINER( &listeners, listener, node )
+    {
+        listener->window( listener );
+    }
+}
+
+static void prv_lte_handler( const struct lte_lc_evt * const evt )
+{
+    k_spinlock_key_t key;
+
+    switch( evt->type )
+    {
+        case LTE_LC_EVT_NW_REG_STATUS:
+
+            if( ( evt->nw_reg_status != LTE_LC_NW_REG_REGISTERED_HOME ) &&
+                ( evt->nw_reg_status != LTE_LC_NW_REG_REGISTERED_ROAMING ) )
+            {
+                prv_state_set( NCE_RADIO_STATE_UNKNOWN, 0 );
+            }
+
+            break;
+
+        case LTE_LC_EVT_RRC_UPDATE:
+            prv_state_set( ( evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED ) ?
+                           NCE_RADIO_STATE_CONNECTED : NCE_RADIO_STATE_IDLE, 0 );
+            break;
+
+        case LTE_LC_EVT_MODEM_SLEEP_ENTER:
+
+            /* Flight mode and limited service are no radio windows, the network is gone */
+            if( ( evt->modem_sleep.type == LTE_LC_MODEM_SLEEP_PSM ) ||
+                ( evt->modem_sleep.type == LTE_LC_MODEM_SLEEP_PROPRIETARY_PSM ) ||
+                ( evt->modem_sleep.type == LTE_LC_MODEM_SLEEP_RF_INACTIVITY ) )
+            {
+                prv_state_set( NCE_RADIO_STATE_SLEEP, evt->modem_sleep.time );
+            }
+            else
+            {
+                prv_state_set( NCE_RADIO_STATE_UNKNOWN, 0 );
+            }
+
+            break;
+
+        case LTE_LC_EVT_MODEM_SLEEP_EXIT:
+            prv_state_set( NCE_RADIO_STATE_IDLE, 0 );
+            break;
+
+        case LTE_LC_EVT_PSM_UPDATE:
+            key = k_spin_lock( &lock );
+            info.psm_tau_s = evt->psm_cfg.tau;
+            info.psm_active_s = evt->psm_cfg.active_time;
+            k_spin_unlock( &lock, key );
+            LOG_INF( "PSM: TAU %d s, active time %d s", evt->psm_cfg.tau, evt->psm_cfg.active_time );
+            break;
+
+        case LTE_LC_EVT_EDRX_UPDATE:
+            key = k_spin_lock( &lock );
+            info.edrx_ms = ( uint32_t ) ( evt->edrx_cfg.edrx * MSEC_PER_SEC );
+            info.ptw_ms = ( uint32_t ) ( evt->edrx_cfg.ptw * MSEC_PER_SEC );
+            k_spin_unlock( &lock, key );
+            LOG_INF( "eDRX: cycle %.2f s, PTW %.2f s", ( double ) evt->edrx_cfg.edrx, ( double ) evt->edrx_cfg.ptw );
+            break;
+
+        default:
+            break;
+    }
+}
+
+static int prv_radio_sched_init( void )
+{
+    lte_lc_register_handler( prv_lte_handler );
+
+    return 0;
+}
+
+SYS_INIT( prv_radio_sched_init, APPLICATION, 0 );
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_radio_sched_listen( struct nce_radio_sched_listener * listener )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    sys_slist_append( &listeners, &listener->node );
+
+    k_spin_unlock( &lock, key );
+}
+
+k_timeout_t nce_radio_sched_delay( uint32_t max_defer_ms )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    int64_t wake_in_ms = wake_at - k_uptime_get();
+    uint32_t delay_ms;
+
+    /* A missed exit event must not hold traffic back forever */
+    if( ( state != NCE_RADIO_STATE_SLEEP ) || ( wake_in_ms <= 0 ) || ( max_defer_ms == 0 ) )
+    {
+        k_spin_unlock( &lock, key );
+        return K_NO_WAIT;
+    }
+
+    delay_ms = ( uint32_t ) MIN( wake_in_ms, ( int64_t ) max_defer_ms );
+    info.deferrals++;
+    info.deferred_ms += delay_ms;
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "Modem asleep for %lld ms, deferring by %u ms", wake_in_ms, delay_ms );
+
+    return K_MSEC( delay_ms );
+}
+
+void nce_radio_sched_info_get( struct nce_radio_sched_info * out )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    *out = info;
+    out->state = state;
+    out->wake_in_ms = ( state == NCE_RADIO_STATE_SLEEP ) ? MAX( wake_at - k_uptime_get(), 0 ) : -1;
+
+    k_spin_unlock( &lock, key );
+}
+
+const char * nce_radio_sched_state_name( enum nce_radio_state radio_state )
+{
+    return ( radio_state < ARRAY_SIZE( state_names ) ) ? state_names[ radio_state ] : "invalid";
+}
+
+#if defined( CONFIG_NCE_RADIO_SCHED_SHELL )
+static int cmd_radio_sched_show( const struct shell * sh,
+                                 size_t argc,
+                                 char ** argv )
+{
+    struct nce_radio_sched_info radio;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    nce_radio_sched_info_get( &radio );
+
+    shell_print( sh, "state:     %s", nce_radio_sched_state_name( radio.state ) );
+
+    if( radio.wake_in_ms >= 0 )
+    {
+        shell_print( sh, "wake in:   %lld ms", radio.wake_in_ms );
+    }
+
+    shell_print( sh, "psm:       TAU %d s, active time %d s", radio.psm_tau_s, radio.psm_active_s );
+    shell_print( sh, "edrx:      cycle %u ms, PTW %u ms", radio.edrx_ms, radio.ptw_ms );
+    shell_print( sh, "windows:   %u", radio.windows );
+    shell_print( sh, "deferrals: %u (%u ms in total)", radio.deferrals, radio.deferred_ms );
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_radio_sched,
+                                SHELL_CMD( show, NULL, "Show the radio state and the deferral counters",
+                                           cmd_radio_sched_show ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( radio_sched, &sub_radio_sched, "Radio-window aware scheduling", NULL );
+#endif /* if defined( CONFIG_NCE_RADIO_SCHED_SHELL ) */
@@ -0,0 +1,158 @@
+/******************************************************************************
+ * @file    nce_retry.h
+ * @brief   Retry policy with capped exponential backoff and jitter.
+ * @details Every user keeps its own policy state. After a failure,
+ *          nce_retry_failed() returns the delay before the next attempt,
+ *          drawn with decorrelated jitter between the base delay and three
+ *          times the previous delay, capped at the maximum. Devices that lost
+ *          the network together therefore spread their retries instead of
+ *          hitting the server in lockstep. nce_retry_succeeded() restarts
+ *          the backoff at the base delay.
+ *
+ *          While the network is down (conn_mgr L4 state, or the LTE
+ *          registration without conn_mgr), failures do not count: the policy
+ *          pauses and calls the user's resume callback once the network is
+ *          back. An optional budget limits the number of retries per period,
+ *          so a peer that keeps failing cannot drain the battery.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_RETRY_H__
+#define NCE_RETRY_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Policy parameters. */
+struct nce_retry_config
+{
+    uint32_t base_ms;          /**< First delay, lower bound of every delay. */
+    uint32_t cap_ms;           /**< Upper bound of every delay. */
+    uint32_t max_attempts;     /**< Consecutive failures before giving up, 0 never gives up. */
+    uint32_t budget;           /**< Retries per budget period, 0 for no budget. */
+    uint32_t budget_period_ms; /**< Period over which the budget refills. */
+};
+
+/** @brief Policy with the CONFIG_NCE_RETRY_DEFAULT_* values. */
+#define NCE_RETRY_CONFIG_DEFAULT                                                \
+        {                                                                       \
+            .base_ms          = CONFIG_NCE_RETRY_DEFAULT_BASE_MS,               \
+            .cap_ms           = CONFIG_NCE_RETRY_DEFAULT_CAP_MS,                \
+            .max_attempts     = CONFIG_NCE_RETRY_DEFAULT_MAX_ATTEMPTS,          \
+            .budget           = CONFIG_NCE_RETRY_DEFAULT_BUDGET,                \
+            .budget_period_ms = CONFIG_NCE_RETRY_DEFAULT_BUDGET_PERIOD_SECONDS * \
+                                MSEC_PER_SEC,                                   \
+        }
+
+/** @brief Statistics of one user since boot. */
+struct nce_retry_stats
+{
+    uint32_t failures;     /**< Reported failures. */
+    uint32_t successes;    /**< Reported successes. */
+    uint32_t retries;      /**< Retries scheduled. */
+    uint32_t paused;       /**< Failures while the network was down. */
+    uint32_t budget_waits; /**< Retries delayed because the budget was spent. */
+    uint32_t gave_up;      /**< Times max_attempts was reached. */
+    uint32_t max_delay_ms; /**< Longest delay handed out. */
+};
+
+struct nce_retry;
+
+/**
+ * @brief Network is back for a paused user.
+ *
+ * Runs in the context of the connectivity event. Hand the work to the
+ * user's thread and restart it after nce_retry_resume().
+ */
+typedef void (* nce_retry_resume_t)( struct nce_retry * retry );
+
+/** @brief Policy state of one user, treat as opaque. */
+struct nce_retry
+{
+    sys_snode_t node;
+    const char * name;
+    struct nce_retry_config config;
+    nce_retry_resume_t resume;
+    uint32_t attempts;
+    uint32_t delay_ms;
+    uint32_t tokens;
+    int64_t refill_at;
+    bool paused;
+    struct nce_retry_stats stats;
+};
+
+/**
+ * @brief Initialize a policy and list it in the "retry" shell command.
+ *
+ * @param[out] retry  Policy state.
+ * @param[in]  name   Name in logs and the shell, must stay valid.
+ * @param[in]  config Parameters, copied.
+ * @param[in]  resume Called when the network is back after a pause, may be NULL.
+ */
+void nce_retry_init( struct nce_retry * retry,
+                     const char * name,
+                     const struct nce_retry_config * config,
+                     nce_retry_resume_t resume );
+
+/**
+ * @brief Report a failed attempt and get the delay before the next one.
+ *
+ * @param[in]  retry Policy state.
+ * @param[out] delay Delay before the next attempt.
+ *
+ * @return 0 to retry after @p delay, -ENETDOWN while the network is down
+ *         (the resume callback runs once it is back), -ECANCELED once
+ *         max_attempts consecutive attempts failed.
+ */
+int nce_retry_failed( struct nce_retry * retry,
+                      k_timeout_t * delay );
+
+/**
+ * @brief Report a successful attempt, the backoff restarts at the base delay.
+ */
+void nce_retry_succeeded( struct nce_retry * retry );
+
+/**
+ * @brief Start over after a pause or after giving up.
+ *
+ * Clears the failure count. Returns a random delay of up to the base delay
+ * if the user was failing, so devices coming back from the same outage do
+ * not retry at the same moment, or K_NO_WAIT otherwise.
+ */
+k_timeout_t nce_retry_resume( struct nce_retry * retry );
+
+/**
+ * @brief Consecutive failures since the last success.
+ */
+uint32_t nce_retry_attempts( const struct nce_retry * retry );
+
+/**
+ * @brief Read the statistics of a user.
+ */
+void nce_retry_stats_get( const struct nce_retry * retry,
+                          struct nce_retry_stats * stats );
+
+/**
+ * @brief Connectivity as seen by the policy.
+ *
+ * @return true if the network is up, or if connectivity is not tracked.
+ */
+bool nce_retry_network_up( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_RETRY_H__ */
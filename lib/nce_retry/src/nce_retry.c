@@ -0,0 +1,347 @@
+/******************************************************************************
+ * @file    nce_retry.c
+ * @brief   Retry policy with capped exponential backoff and jitter.
+ * @details See nce_retry.h. One spinlock guards all users; the policy
+ *          functions only do arithmetic under it.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/random/random.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/atomic.h>
+#if defined( CONFIG_NET_CONNECTION_MANAGER )
+    #include <zephyr/net/net_mgmt.h>
+    #include <zephyr/net/conn_mgr_monitor.h>
+#elif defined( CONFIG_LTE_LINK_CONTROL )
+    #include <modem/lte_lc.h>
+#endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+#include <nce_retry.h>
+
+LOG_MODULE_REGISTER( nce_retry, CONFIG_NCE_RETRY_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define RETRY_TRACKS_NETWORK    ( IS_ENABLED( CONFIG_NET_CONNECTION_MANAGER ) || \
+                                  IS_ENABLED( CONFIG_LTE_LINK_CONTROL ) )
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct k_spinlock lock;
+static sys_slist_t users = SYS_SLIST_STATIC_INIT( &users );
+static atomic_t network_up = ATOMIC_INIT( !RETRY_TRACKS_NETWORK );
+
+#if defined( CONFIG_NET_CONNECTION_MANAGER )
+static struct net_mgmt_event_callback l4_cb;
+#endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Uniform random value in [low, high]. */
+static uint32_t prv_random_between( uint32_t low,
+                                    uint32_t high )
+{
+    if( high <= low )
+    {
+        return low;
+    }
+
+    return low + ( sys_rand32_get() % ( high - low + 1 ) );
+}
+
+/** @brief Take a budget token, or return how long until one is available. */
+static uint32_t prv_budget_wait_ms( struct nce_retry * retry )
+{
+    uint32_t refill_ms;
+    uint32_t wait_ms;
+    int64_t now;
+
+    if( retry->config.budget == 0 )
+    {
+        return 0;
+    }
+
+    refill_ms = MAX( retry->config.budget_period_ms / retry->config.budget, 1U );
+    now = k_uptime_get();
+
+    /* refill_at is when the next token is added while the bucket is not full */
+    while( ( retry->tokens < retry->config.budget ) && ( now >= retry->refill_at ) )
+    {
+        retry->tokens++;
+        retry->refill_at += refill_ms;
+    }
+
+    if( retry->tokens > 0 )
+    {
+        if( retry->tokens == retry->config.budget )
+        {
+            retry->refill_at = now + refill_ms;
+        }
+
+        retry->tokens--;
+        return 0;
+    }
+
+    /* Empty: wait for the next token and spend it right away */
+    wait_ms = ( uint32_t ) ( retry->refill_at - now );
+    retry->refill_at += refill_ms;
+
+    return wait_ms;
+}
+
+/** @brief Network state changed, wake the paused users when it is back. */
+static void prv_network_changed( bool up )
+{
+    struct nce_retry * retry;
+    k_spinlock_key_t key;
+
+    if( atomic_set( &network_up, up ) == up )
+    {
+        return;
+    }
+
+    LOG_DBG( "Network %s", up ? "up" : "down" );
+
+    if( !up )
+    {
+        return;
+    }
+
+    key = k_spin_lock( &lock );
+
+    SYS_SLIST_FOR_EACH_CONTAINER( &users, retry, node )
+    {
+        bool paused = retry->paused;
+
+        retry->paused = false;
+
+        if( paused && retry->resume )
+        {
+            /* The list is only appended to, the callback may call back into the policy */
+            k_spin_unlock( &lock, key );
+            retry->resume( retry );
+            key = k_spin_lock( &lock );
+        }
+    }
+
+    k_spin_unlock( &lock, key );
+}
+
+#if defined( CONFIG_NET_CONNECTION_MANAGER )
+static void prv_l4_handler( struct net_mgmt_event_callback * cb,
+                            uint32_t event,
+                            struct net_if * iface )
+{
+    ARG_UNUSED( cb );
+    ARG_UNUSED( iface );
+
+    if( ( event == NET_EVENT_L4_CONNECTED ) || ( event == NET_EVENT_L4_DISCONNECTED ) )
+    {
+        prv_network_changed( event == NET_EVENT_L4_CONNECTED );
+    }
+}
+#elif defined( CONFIG_LTE_LINK_CONTROL )
+static void prv_lte_handler( const struct lte_lc_evt * const evt )
+{
+    if( evt->type == LTE_LC_EVT_NW_REG_STATUS )
+    {
+        prv_network_changed( ( evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_HOME ) ||
+                             ( evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_ROAMING ) );
+    }
+}
+#endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+static int prv_retry_init( void )
+{
+    #if defined( CONFIG_NET_CONNECTION_MANAGER )
+    net_mgmt_init_event_callback( &l4_cb, prv_l4_handler, NET_EVENT_L4_CONNECTED | NET_EVENT_L4_DISCONNECTED );
+    net_mgmt_add_event_callback( &l4_cb );
+    #elif defined( CONFIG_LTE_LINK_CONTROL )
+    lte_lc_register_handler( prv_lte_handler );
+    #endif /* if defined( CONFIG_NET_CONNECTION_MANAGER ) */
+
+    return 0;
+}
+
+SYS_INIT( prv_retry_init, APPLICATION, 0 );
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void nce_retry_init( struct nce_retry * retry,
+                     const char * name,
+                     const struct nce_retry_config * config,
+                     nce_retry_resume_t resume )
+{
+    k_spinlock_key_t key;
+
+    memset( retry, 0, sizeof( *retry ) );
+    retry->name = name;
+    retry->config = *config;
+    retry->config.base_ms = MAX( retry->config.base_ms, 1U );
+    retry->config.cap_ms = MAX( retry->config.cap_ms, retry->config.base_ms );
+    retry->resume = resume;
+    retry->delay_ms = retry->config.base_ms;
+    retry->tokens = retry->config.budget;
+
+    key = k_spin_lock( &lock );
+    sys_slist_append( &users, &retry->node );
+    k_spin_unlock( &lock, key );
+}
+
+int nce_retry_failed( struct nce_retry * retry,
+                      k_timeout_t * delay )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    uint32_t budget_wait_ms;
+    uint32_t delay_ms;
+
+    retry->stats.failures++;
+
+    if( !atomic_get( &network_up ) )
+    {
+        retry->paused = true;
+        retry->stats.paused++;
+        k_spin_unlock( &lock, key );
+        return -ENETDOWN;
+    }
+
+    if( ( retry->config.max_attempts > 0 ) && ( retry->attempts >= retry->config.max_attempts ) )
+    {
+        k_spin_unlock( &lock, key );
+        return -ECANCELED;
+    }
+
+    retry->attempts++;
+
+    if( ( retry->config.max_attempts > 0 ) && ( retry->attempts >= retry->config.max_attempts ) )
+    {
+        /* Like a pause: the resume callback runs when the network comes back */
+        retry->paused = true;
+        retry->stats.gave_up++;
+        k_spin_unlock( &lock, key );
+        LOG_WRN( "%s: giving up after %u attempts", retry->name, retry->attempts );
+        return -ECANCELED;
+    }
+
+    /* Decorrelated jitter: the next delay depends on the previous one, not on the attempt */
+    delay_ms = prv_random_between( retry->config.base_ms,
+                                   ( uint32_t ) MIN( ( uint64_t ) retry->delay_ms * 3U, UINT32_MAX ) );
+    delay_ms = MIN( delay_ms, retry->config.cap_ms );
+    retry->delay_ms = delay_ms;
+
+    budget_wait_ms = prv_budget_wait_ms( retry );
+
+    if( budget_wait_ms > delay_ms )
+    {
+        retry->stats.budget_waits++;
+        delay_ms = budget_wait_ms;
+    }
+
+    retry->stats.retries++;
+    retry->stats.max_delay_ms = MAX( retry->stats.max_delay_ms, delay_ms );
+
+    k_spin_unlock( &lock, key );
+
+    LOG_DBG( "%s: attempt %u failed, retrying in %u ms", retry->name, retry->attempts, delay_ms );
+    *delay = K_MSEC( delay_ms );
+
+    return 0;
+}
+
+void nce_retry_succeeded( struct nce_retry * retry )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    retry->stats.successes++;
+    retry->attempts = 0;
+    retry->delay_ms = retry->config.base_ms;
+    retry->paused = false;
+
+    k_spin_unlock( &lock, key );
+}
+
+k_timeout_t nce_retry_resume( struct nce_retry * retry )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+    bool failing = ( retry->attempts > 0 ) || retry->paused;
+
+    retry->attempts = 0;
+    retry->delay_ms = retry->config.base_ms;
+    retry->paused = false;
+
+    k_spin_unlock( &lock, key );
+
+    return failing ? K_MSEC( prv_random_between( 0, retry->config.base_ms ) ) : K_NO_WAIT;
+}
+
+uint32_t nce_retry_attempts( const struct nce_retry * retry )
+{
+    return retry->attempts;
+}
+
+void nce_retry_stats_get( const struct nce_retry * retry,
+                          struct nce_retry_stats * stats )
+{
+    k_spinlock_key_t key = k_spin_lock( &lock );
+
+    *stats = retry->stats;
+
+    k_spin_unlock( &lock, key );
+}
+
+bool nce_retry_network_up( void )
+{
+    return atomic_get( &network_up ) != 0;
+}
+
+#if defined( CONFIG_NCE_RETRY_SHELL )
+static int cmd_retry_stats( const struct shell * sh,
+                            size_t argc,
+                            char ** argv )
+{
+    struct nce_retry * retry;
+    struct nce_retry_stats stats;
+
+    ARG_UNUSED( argc );
+    ARG_UNUSED( argv );
+
+    shell_print( sh, "network: %s", nce_retry_network_up() ? "up" : "down" );
+
+    /* Users are never removed, the list can be walked without the lock */
+    SYS_SLIST_FOR_EACH_CONTAINER( &users, retry, node )
+    {
+        nce_retry_stats_get( retry, &stats );
+        shell_print( sh, "%s: attempts %u%s, failures %u, successes %u, retries %u, paused %u, "
+                     "budget waits %u, gave up %u, max delay %u ms",
+                     retry->name, nce_retry_attempts( retry ), retry->paused ? " (paused)" : "",
+                     stats.failures, stats.successes, stats.retries, stats.paused,
+                     stats.budget_waits, stats.gave_up, stats.max_delay_ms );
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE( sub_retry,
+                                SHELL_CMD( stats, NULL, "Show the retry statistics of every user", cmd_retry_stats ),
+                                SHELL_SUBCMD_SET_END );
+SHELL_CMD_REGISTER( retry, &sub_retry, "Retry policies", NULL );
+#endif /* if defined( CONFIG_NCE_RETRY_SHELL ) */
@@ -0,0 +1,153 @@
+/******************************************************************************
+ * @file    nce_uplink_queue.h
+ * @brief   Flash-backed store-and-forward queue for uplink payloads.
+ * @details Payloads are appended to a flash circular buffer (FCB) on the
+ *          nce_uplink_queue partition and read back in order. An entry is
+ *          removed with nce_uplink_queue_pop() once the server has received
+ *          it; a flash sector is erased when all of its entries are removed,
+ *          so writes and erases move around the whole partition. When the
+ *          partition is full, the oldest sector is erased and its entries
+ *          are dropped.
+ *
+ *          The read position is kept in RAM. After a reboot, entries of the
+ *          oldest sector that were already sent are sent again, so delivery
+ *          is at least once.
+ *
+ *          Every entry carries the uptime its payload refers to, e.g. when
+ *          its first sample was taken, so a sender can work out its age when
+ *          it is finally sent. Uptime restarts with a reboot: entries queued
+ *          before the last reboot report NCE_UPLINK_QUEUE_TIME_UNKNOWN.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef NCE_UPLINK_QUEUE_H__
+#define NCE_UPLINK_QUEUE_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Time of an entry queued before the last reboot. */
+#define NCE_UPLINK_QUEUE_TIME_UNKNOWN    ( -1LL )
+
+/**
+ * @brief Queue statistics.
+ */
+struct nce_uplink_queue_stats
+{
+    uint32_t pending; /**< Entries waiting to be sent. */
+    uint32_t pushed;  /**< Entries queued since boot. */
+    uint32_t sent;    /**< Entries removed after delivery since boot. */
+    uint32_t dropped; /**< Entries erased unsent because the queue was full. */
+};
+
+/**
+ * @brief Append a payload to the queue.
+ *
+ * @param[in] data    Payload.
+ * @param[in] len     Payload length, at most CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE
+ *                    and what fits one flash sector.
+ * @param[in] time_ms k_uptime_get() time the payload refers to.
+ *
+ * @return 0 on success, -EMSGSIZE if the payload is too large (nothing is
+ *         dropped then), -ENODEV if the partition could not be initialized,
+ *         other negative error code on flash errors.
+ */
+int nce_uplink_queue_push( const uint8_t * data,
+                           size_t len,
+                           int64_t time_ms );
+
+/**
+ * @brief Read the oldest payload without removing it.
+ *
+ * @param[out] buffer  Destination buffer.
+ * @param[in]  size    Size of the destination buffer.
+ * @param[out] len     Payload length.
+ * @param[out] time_ms Time given to nce_uplink_queue_push(), or
+ *                     NCE_UPLINK_QUEUE_TIME_UNKNOWN. May be NULL.
+ *
+ * @return 0 on success, -ENOENT if the queue is empty, -ENOBUFS if the
+ *         buffer is too small, other negative error code on flash errors.
+ */
+int nce_uplink_queue_peek( uint8_t * buffer,
+                           size_t size,
+                           size_t * len,
+                           int64_t * time_ms );
+
+/**
+ * @brief Read a payload behind the oldest one without removing it.
+ *
+ * Lets the caller send several entries before the oldest is acknowledged.
+ * Entries are still removed oldest first with nce_uplink_queue_pop().
+ *
+ * @param[in]  index   Position from the oldest payload, 0 is the oldest.
+ * @param[out] buffer  Destination buffer.
+ * @param[in]  size    Size of the destination buffer.
+ * @param[out] len     Payload length.
+ * @param[out] time_ms Time given to nce_uplink_queue_push(), or
+ *                     NCE_UPLINK_QUEUE_TIME_UNKNOWN. May be NULL.
+ *
+ * @return 0 on success, -ENOENT if the queue holds @p index payloads or
+ *         fewer, -ENOBUFS if the buffer is too small, other negative error
+ *         code on flash errors.
+ */
+int nce_uplink_queue_peek_at( uint32_t index,
+                              uint8_t * buffer,
+                              size_t size,
+                              size_t * len,
+                              int64_t * time_ms );
+
+/**
+ * @brief Read part of a payload without removing it.
+ *
+ * Lets the caller stream a payload from flash instead of holding all of it
+ * in RAM.
+ *
+ * @param[in]  index  Position from the oldest payload, 0 is the oldest.
+ * @param[in]  offset Offset into the payload.
+ * @param[out] buffer Destination buffer.
+ * @param[in]  size   Number of bytes to read at most.
+ *
+ * @return Number of bytes read, 0 if @p offset is at or past the end,
+ *         -ENOENT if the queue holds @p index payloads or fewer, other
+ *         negative error code on flash errors.
+ */
+int nce_uplink_queue_read( uint32_t index,
+                           size_t offset,
+                           uint8_t * buffer,
+                           size_t size );
+
+/**
+ * @brief Remove the oldest payload after it has been delivered.
+ *
+ * @return 0 on success, -ENOENT if the queue is empty.
+ */
+int nce_uplink_queue_pop( void );
+
+/**
+ * @brief Get the number of payloads waiting to be sent.
+ *
+ * @return Number of queued payloads.
+ */
+uint32_t nce_uplink_queue_count( void );
+
+/**
+ * @brief Get the queue statistics.
+ *
+ * @param[out] stats Statistics.
+ */
+void nce_uplink_queue_stats_get( struct nce_uplink_queue_stats * stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NCE_UPLINK_QUEUE_H__ */
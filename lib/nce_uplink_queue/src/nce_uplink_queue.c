@@ -0,0 +1,476 @@
+/******************************************************************************
+ * @file    nce_uplink_queue.c
+ * @brief   Flash-backed store-and-forward queue for uplink payloads.
+ * @details See nce_uplink_queue.h. The FCB only erases whole sectors, so the
+ *          read position is tracked in RAM and a sector is rotated out once
+ *          the read position has left it. When the last entry is removed all
+ *          used sectors are erased and the next payload starts a new sector.
+ *          Every entry starts with a header holding a random id of the boot
+ *          it was queued in and its time.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/fs/fcb.h>
+#include <zephyr/random/random.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/byteorder.h>
+
+#if defined( CONFIG_PARTITION_MANAGER_ENABLED )
+    #include <pm_config.h>
+#endif /* if defined( CONFIG_PARTITION_MANAGER_ENABLED ) */
+
+#include <nce_uplink_queue.h>
+
+LOG_MODULE_REGISTER( nce_uplink_queue, CONFIG_NCE_UPLINK_QUEUE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#if defined( CONFIG_PARTITION_MANAGER_ENABLED )
+    #define UPLINK_QUEUE_AREA_ID    PM_NCE_UPLINK_QUEUE_ID
+#else
+    #define UPLINK_QUEUE_AREA_ID    FIXED_PARTITION_ID( nce_uplink_queue_partition )
+#endif /* if defined( CONFIG_PARTITION_MANAGER_ENABLED ) */
+
+#define UPLINK_QUEUE_MAGIC      0x4e434551 /* "NCEQ" */
+#define UPLINK_QUEUE_VERSION    2 /* 2: entry header */
+
+/* Boot id and time in ms, little endian */
+#define UPLINK_QUEUE_HDR_LEN    ( sizeof( uint32_t ) + sizeof( uint64_t ) )
+
+/* FCB sector header: magic, version, flags and sector id */
+#define UPLINK_QUEUE_FCB_SECTOR_HDR_LEN    8
+/* FCB entry framing: a length field of up to 2 bytes and a 1 byte CRC */
+#define UPLINK_QUEUE_FCB_LEN_SIZE          2
+#define UPLINK_QUEUE_FCB_CRC_SIZE          1
+
+/* Room to pad the last write up to the flash write block size */
+#define UPLINK_QUEUE_WRITE_BUF_SIZE    ROUND_UP( UPLINK_QUEUE_HDR_LEN + CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE, 16 )
+
+/******************************************************************************
+* Types
+******************************************************************************/
+struct sector_count_ctx
+{
+    const struct fcb_entry * after; /* Count only entries behind this one */
+    uint32_t count;
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static K_MUTEX_DEFINE( queue_lock );
+static struct fcb queue_fcb;
+static struct flash_sector queue_sectors[ CONFIG_NCE_UPLINK_QUEUE_MAX_SECTORS ];
+static bool queue_ready;
+
+/* Last removed entry, fe_sector is NULL when reading starts at the oldest sector */
+static struct fcb_entry read_loc;
+static struct nce_uplink_queue_stats queue_stats;
+static uint8_t write_buf[ UPLINK_QUEUE_WRITE_BUF_SIZE ] __aligned( 4 );
+static uint32_t boot_id;
+/* Largest payload whose entry fits the smallest sector, 0 until initialized */
+static size_t max_entry_len;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static int prv_count_cb( struct fcb_entry_ctx * loc_ctx,
+                         void * arg )
+{
+    struct sector_count_ctx * ctx = arg;
+
+    if( ( ctx->after == NULL ) ||
+        ( loc_ctx->loc.fe_sector != ctx->after->fe_sector ) ||
+        ( loc_ctx->loc.fe_elem_off > ctx->after->fe_elem_off ) )
+    {
+        ctx->count++;
+    }
+
+    return 0;
+}
+
+/** @brief Erase the oldest sector to make room. Call with queue_lock held. */
+static int prv_drop_oldest( void )
+{
+    struct sector_count_ctx ctx =
+    {
+        .after = ( read_loc.fe_sector == queue_fcb.f_oldest ) ? &read_loc : NULL,
+    };
+    int err;
+
+    ( void ) fcb_walk( &queue_fcb, queue_fcb.f_oldest, prv_count_cb, &ctx );
+
+    err = fcb_rotate( &queue_fcb );
+
+    if( err )
+    {
+        return err;
+    }
+
+    /* The read position is never behind the oldest sector */
+    read_loc.fe_sector = NULL;
+    queue_stats.pending -= MIN( ctx.count, queue_stats.pending );
+    queue_stats.dropped += ctx.count;
+
+    LOG_WRN( "Queue full, dropped %u oldest entries", ctx.count );
+
+    return 0;
+}
+
+/** @brief Erase every sector once the queue is drained. Call with queue_lock held. */
+static void prv_erase_drained( void )
+{
+    for( int i = 0; ( i < queue_fcb.f_sector_cnt ) && !fcb_is_empty( &queue_fcb ); i++ )
+    {
+        if( fcb_rotate( &queue_fcb ) )
+        {
+            break;
+        }
+    }
+
+    read_loc.fe_sector = NULL;
+}
+
+/** @brief Largest payload whose entry, with its header and FCB framing, fits every sector. */
+static size_t prv_max_entry_len( void )
+{
+    size_t align = flash_area_align( queue_fcb.fap );
+    size_t overhead = ROUND_UP( UPLINK_QUEUE_FCB_SECTOR_HDR_LEN, align ) +
+                      ROUND_UP( UPLINK_QUEUE_FCB_LEN_SIZE, align ) +
+                      ROUND_UP( UPLINK_QUEUE_FCB_CRC_SIZE, align ) + UPLINK_QUEUE_HDR_LEN;
+    size_t sector_size = SIZE_MAX;
+
+    for( int i = 0; i < queue_fcb.f_sector_cnt; i++ )
+    {
+        sector_size = MIN( sector_size, queue_sectors[ i ].fs_size );
+    }
+
+    if( sector_size <= overhead )
+    {
+        return 0;
+    }
+
+    return MIN( ROUND_DOWN( sector_size - overhead, align ), CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE );
+}
+
+/** @brief Find the entry @p index places behind the read position. Call with queue_lock held. */
+static int prv_entry_at( uint32_t index,
+                         struct fcb_entry * loc )
+{
+    int err = 0;
+
+    *loc = read_loc;
+
+    for( uint32_t i = 0; ( i <= index ) && ( err == 0 ); i++ )
+    {
+        err = fcb_getnext( &queue_fcb, loc );
+    }
+
+    if( err || ( loc->fe_data_len < UPLINK_QUEUE_HDR_LEN ) )
+    {
+        return -ENOENT;
+    }
+
+    return 0;
+}
+
+static int prv_uplink_queue_init( void )
+{
+    uint32_t sector_cnt = ARRAY_SIZE( queue_sectors );
+    struct sector_count_ctx ctx = { 0 };
+    int err;
+
+    err = flash_area_get_sectors( UPLINK_QUEUE_AREA_ID, &sector_cnt, queue_sectors );
+
+    if( err )
+    {
+        LOG_ERR( "Failed to get the queue partition layout: %d", err );
+        return 0;
+    }
+
+    boot_id = sys_rand32_get();
+
+    queue_fcb.f_magic = UPLINK_QUEUE_MAGIC;
+    queue_fcb.f_version = UPLINK_QUEUE_VERSION;
+    queue_fcb.f_sector_cnt = sector_cnt;
+    queue_fcb.f_scratch_cnt = 0;
+    queue_fcb.f_sectors = queue_sectors;
+
+    err = fcb_init( UPLINK_QUEUE_AREA_ID, &queue_fcb );
+
+    if( err )
+    {
+        /* Written by another layout or firmware, start over */
+        const struct flash_area * fa;
+
+        LOG_WRN( "Queue partition unreadable (%d), erasing it", err );
+        err = flash_area_open( UPLINK_QUEUE_AREA_ID, &fa );
+
+        if( err == 0 )
+        {
+            err = flash_area_erase( fa, 0, fa->fa_size );
+            flash_area_close( fa );
+        }
+
+        if( err == 0 )
+        {
+            err = fcb_init( UPLINK_QUEUE_AREA_ID, &queue_fcb );
+        }
+
+        if( err )
+        {
+            LOG_ERR( "Failed to initialize the queue partition: %d", err );
+            return 0;
+        }
+    }
+
+    max_entry_len = prv_max_entry_len();
+
+    if( max_entry_len < CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE )
+    {
+        LOG_WRN( "Flash sectors hold payloads of up to %u bytes", max_entry_len );
+    }
+
+    ( void ) fcb_walk( &queue_fcb, NULL, prv_count_cb, &ctx );
+    queue_stats.pending = ctx.count;
+    queue_ready = true;
+
+    if( ctx.count > 0 )
+    {
+        LOG_INF( "%u uplinks queued from before the reboot", ctx.count );
+    }
+
+    return 0;
+}
+
+SYS_INIT( prv_uplink_queue_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY );
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+int nce_uplink_queue_push( const uint8_t * data,
+                           size_t len,
+                           int64_t time_ms )
+{
+    struct fcb_entry loc;
+    size_t write_len;
+    int err;
+
+    if( !queue_ready )
+    {
+        return -ENODEV;
+    }
+
+    /* Checked before anything is dropped, a payload no sector holds never fits */
+    if( ( len == 0 ) || ( len > max_entry_len ) )
+    {
+        return -EMSGSIZE;
+    }
+
+    k_mutex_lock( &queue_lock, K_FOREVER );
+
+    err = fcb_append( &queue_fcb, UPLINK_QUEUE_HDR_LEN + len, &loc );
+
+    if( err == -ENOSPC )
+    {
+        err = prv_drop_oldest();
+
+        if( err == 0 )
+        {
+            err = fcb_append( &queue_fcb, UPLINK_QUEUE_HDR_LEN + len, &loc );
+        }
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Failed to reserve %u bytes in the queue: %d", len, err );
+        goto end;
+    }
+
+    sys_put_le32( boot_id, write_buf );
+    sys_put_le64( ( uint64_t ) time_ms, &write_buf[ sizeof( uint32_t ) ] );
+    memcpy( &write_buf[ UPLINK_QUEUE_HDR_LEN ], data, len );
+    len += UPLINK_QUEUE_HDR_LEN;
+
+    /* The flash driver only accepts whole write blocks */
+    write_len = ROUND_UP( len, flash_area_align( queue_fcb.fap ) );
+    memset( &write_buf[ len ], queue_fcb.f_erase_value, write_len - len );
+
+    err = flash_area_write( queue_fcb.fap, FCB_ENTRY_FA_DATA_OFF( loc ), write_buf, write_len );
+
+    if( err == 0 )
+    {
+        err = fcb_append_finish( &queue_fcb, &loc );
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Failed to write a queue entry: %d", err );
+        goto end;
+    }
+
+    queue_stats.pending++;
+    queue_stats.pushed++;
+
+end:
+    k_mutex_unlock( &queue_lock );
+    return err;
+}
+
+int nce_uplink_queue_peek( uint8_t * buffer,
+                           size_t size,
+                           size_t * len,
+                           int64_t * time_ms )
+{
+    return nce_uplink_queue_peek_at( 0, buffer, size, len, time_ms );
+}
+
+int nce_uplink_queue_peek_at( uint32_t index,
+                              uint8_t * buffer,
+                              size_t size,
+                              size_t * len,
+                              int64_t * time_ms )
+{
+    uint8_t hdr[ UPLINK_QUEUE_HDR_LEN ];
+    struct fcb_entry loc;
+    int err;
+
+    if( !queue_ready )
+    {
+        return -ENOENT;
+    }
+
+    k_mutex_lock( &queue_lock, K_FOREVER );
+
+    err = prv_entry_at( index, &loc );
+
+    if( ( err == 0 ) && ( loc.fe_data_len - UPLINK_QUEUE_HDR_LEN > size ) )
+    {
+        err = -ENOBUFS;
+    }
+
+    if( err == 0 )
+    {
+        err = flash_area_read( queue_fcb.fap, FCB_ENTRY_FA_DATA_OFF( loc ), hdr, sizeof( hdr ) );
+    }
+
+    if( err == 0 )
+    {
+        *len = loc.fe_data_len - UPLINK_QUEUE_HDR_LEN;
+        err = flash_area_read( queue_fcb.fap, FCB_ENTRY_FA_DATA_OFF( loc ) + UPLINK_QUEUE_HDR_LEN, buffer, *len );
+    }
+
+    if( ( err == 0 ) && time_ms )
+    {
+        *time_ms = ( sys_get_le32( hdr ) == boot_id ) ? ( int64_t ) sys_get_le64( &hdr[ sizeof( uint32_t ) ] ) :
+                   NCE_UPLINK_QUEUE_TIME_UNKNOWN;
+    }
+
+    k_mutex_unlock( &queue_lock );
+    return err;
+}
+
+int nce_uplink_queue_read( uint32_t index,
+                           size_t offset,
+                           uint8_t * buffer,
+                           size_t size )
+{
+    struct fcb_entry loc;
+    size_t len = 0;
+    int err;
+
+    if( !queue_ready )
+    {
+        return -ENOENT;
+    }
+
+    k_mutex_lock( &queue_lock, K_FOREVER );
+
+    err = prv_entry_at( index, &loc );
+
+    if( ( err == 0 ) && ( offset < loc.fe_data_len - UPLINK_QUEUE_HDR_LEN ) )
+    {
+        len = MIN( size, loc.fe_data_len - UPLINK_QUEUE_HDR_LEN - offset );
+        err = flash_area_read( queue_fcb.fap, FCB_ENTRY_FA_DATA_OFF( loc ) + UPLINK_QUEUE_HDR_LEN + offset,
+                               buffer, len );
+    }
+
+    k_mutex_unlock( &queue_lock );
+    return err ? err : ( int ) len;
+}
+
+int nce_uplink_queue_pop( void )
+{
+    struct fcb_entry loc;
+
+    if( !queue_ready )
+    {
+        return -ENOENT;
+    }
+
+    k_mutex_lock( &queue_lock, K_FOREVER );
+
+    loc = read_loc;
+
+    if( fcb_getnext( &queue_fcb, &loc ) )
+    {
+        k_mutex_unlock( &queue_lock );
+        return -ENOENT;
+    }
+
+    queue_stats.pending -= MIN( 1, queue_stats.pending );
+    queue_stats.sent++;
+
+    if( queue_stats.pending == 0 )
+    {
+        prv_erase_drained();
+    }
+    else
+    {
+        /* Sectors behind the read position hold only sent entries */
+        while( queue_fcb.f_oldest != loc.fe_sector )
+        {
+            if( fcb_rotate( &queue_fcb ) )
+            {
+                break;
+            }
+        }
+
+        read_loc = loc;
+    }
+
+    k_mutex_unlock( &queue_lock );
+    return 0;
+}
+
+uint32_t nce_uplink_queue_count( void )
+{
+    uint32_t count;
+
+    k_mutex_lock( &queue_lock, K_FOREVER );
+    count = queue_stats.pending;
+    k_mutex_unlock( &queue_lock );
+
+    return count;
+}
+
+void nce_uplink_queue_stats_get( struct nce_uplink_queue_stats * stats )
+{
+    k_mutex_lock( &queue_lock, K_FOREVER );
+    *stats = queue_stats;
+    k_mutex_unlock( &queue_lock );
+}
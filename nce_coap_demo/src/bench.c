@@ -0,0 +1,574 @@
+/******************************************************************************
+ * @file    bench.c
+ * @brief   Loopback benchmark of the uplink and downlink paths on native_sim.
+ * @details See bench.h. Latencies are taken with k_cycle_get_32(), which runs
+ *          on simulated time on native_sim. The CPU time comes from the host
+ *          process clock (bench_host.c), as simulated time does not advance
+ *          while code runs.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/coap.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/sys_heap.h>
+#if defined( CONFIG_NCE_BENCH_DTLS )
+    #include <zephyr/net/tls_credentials.h>
+#endif /* if defined( CONFIG_NCE_BENCH_DTLS ) */
+
+#include <nce_net_stats.h>
+
+#include "bench.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define BENCH_MAX_IN_FLIGHT      CONFIG_COAP_CLIENT_MAX_REQUESTS
+#define BENCH_MAX_OPTIONS        8
+#define BENCH_BUFFER_SIZE        ( CONFIG_COAP_CLIENT_MESSAGE_SIZE + CONFIG_COAP_CLIENT_MESSAGE_HEADER_SIZE )
+#define BENCH_DOWNLINK_PATH      "example"
+
+#if defined( CONFIG_NCE_BENCH_DOWNLINK_INTERVAL_MS )
+    #define BENCH_DOWNLINKS      ( CONFIG_NCE_BENCH_DOWNLINK_INTERVAL_MS > 0 )
+#else
+    #define BENCH_DOWNLINKS      0
+#endif /* if defined( CONFIG_NCE_BENCH_DOWNLINK_INTERVAL_MS ) */
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+/* Provided by bench_host.c, which runs on the host side of native_sim */
+extern uint64_t bench_host_cpu_time_ns( void );
+
+#if defined( CONFIG_SYS_HEAP_RUNTIME_STATS ) && ( CONFIG_HEAP_MEM_POOL_SIZE > 0 )
+extern struct sys_heap _system_heap;
+#endif /* if defined( CONFIG_SYS_HEAP_RUNTIME_STATS ) && ( CONFIG_HEAP_MEM_POOL_SIZE > 0 ) */
+
+static void prv_report_fn( struct k_work * work );
+
+K_THREAD_STACK_DEFINE( server_stack, CONFIG_NCE_BENCH_SERVER_STACK_SIZE );
+static struct k_thread server_thread;
+static K_WORK_DEFINE( report_work, prv_report_fn );
+
+/** @brief Benchmark state, shared by the I/O, CoAP client and server threads. */
+static struct k_spinlock bench_lock;
+static uint32_t in_flight[ BENCH_MAX_IN_FLIGHT ];
+static size_t in_flight_head;
+static size_t in_flight_count;
+static uint32_t uplink_latency_us[ CONFIG_NCE_BENCH_MESSAGES ];
+static uint32_t uplink_acked;
+static uint32_t uplink_lost;
+static uint32_t downlink_latency_us[ CONFIG_NCE_BENCH_MESSAGES ];
+static uint32_t downlink_acked;
+static uint32_t downlink_lost;
+static uint32_t payload_seq;
+static int64_t start_ms;
+static uint64_t start_cpu_ns;
+static bool started;
+static bool done;
+
+static uint8_t server_buffer[ BENCH_BUFFER_SIZE ];
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Sort the samples in place, insertion sort is enough for a few hundred. */
+static void prv_sort( uint32_t * samples,
+                      size_t count )
+{
+    for( size_t i = 1; i < count; i++ )
+    {
+        uint32_t value = samples[ i ];
+        size_t j = i;
+
+        while( ( j > 0 ) && ( samples[ j - 1 ] > value ) )
+        {
+            samples[ j ] = samples[ j - 1 ];
+            j--;
+        }
+
+        samples[ j ] = value;
+    }
+}
+
+/** @brief Percentile of sorted samples, nearest rank. */
+static uint32_t prv_percentile( const uint32_t * samples,
+                                size_t count,
+                                unsigned int percent )
+{
+    if( count == 0 )
+    {
+        return 0;
+    }
+
+    return samples[ ( ( count - 1 ) * percent + 50 ) / 100 ];
+}
+
+#if defined( CONFIG_THREAD_STACK_INFO ) && defined( CONFIG_INIT_STACKS )
+static void prv_stack_report( const struct k_thread * thread,
+                              void * user_data )
+{
+    size_t unused;
+    const char * name = k_thread_name_get( ( k_tid_t ) thread );
+
+    ARG_UNUSED( user_data );
+
+    if( k_thread_stack_space_get( thread, &unused ) == 0 )
+    {
+        LOG_INF( "Stack %s: %u of %u bytes used", ( name && name[ 0 ] ) ? name : "?",
+                 ( unsigned int ) ( thread->stack_info.size - unused ), ( unsigned int ) thread->stack_info.size );
+    }
+}
+#endif /* if defined( CONFIG_THREAD_STACK_INFO ) && defined( CONFIG_INIT_STACKS ) */
+
+static void prv_report_fn( struct k_work * work )
+{
+    uint32_t elapsed_ms = ( uint32_t ) ( k_uptime_get() - start_ms );
+    uint64_t cpu_ns = bench_host_cpu_time_ns() - start_cpu_ns;
+    uint32_t messages = uplink_acked + downlink_acked;
+    struct nce_net_stats_timing timing;
+
+    ARG_UNUSED( work );
+
+    prv_sort( uplink_latency_us, uplink_acked );
+    prv_sort( downlink_latency_us, downlink_acked );
+    nce_net_stats_timing_get( &timing );
+
+    LOG_INF( "Benchmark: %d uplinks of %d bytes every %d ms over %s",
+             CONFIG_NCE_BENCH_MESSAGES, CONFIG_NCE_BENCH_PAYLOAD_SIZE, CONFIG_NCE_BENCH_UPLINK_INTERVAL_MS,
+             IS_ENABLED( CONFIG_NCE_BENCH_DTLS ) ? "DTLS-PSK" : "UDP" );
+    LOG_INF( "Uplink: %u.%02u msg/s, latency p50 %u us, p99 %u us, %u lost",
+             uplink_acked * 1000 / MAX( elapsed_ms, 1 ), ( uplink_acked * 100000 / MAX( elapsed_ms, 1 ) ) % 100,
+             prv_percentile( uplink_latency_us, uplink_acked, 50 ),
+             prv_percentile( uplink_latency_us, uplink_acked, 99 ), uplink_lost );
+    LOG_INF( "Downlink: %u requests, latency p50 %u us, p99 %u us, %u lost", downlink_acked,
+             prv_percentile( downlink_latency_us, downlink_acked, 50 ),
+             prv_percentile( downlink_latency_us, downlink_acked, 99 ), downlink_lost );
+    LOG_INF( "CPU: %u us per message (host process time), uplink path avg %u us, max %u us",
+             ( uint32_t ) ( cpu_ns / 1000 / MAX( messages, 1 ) ), timing.avg_us, timing.max_us );
+
+    #if defined( CONFIG_SYS_HEAP_RUNTIME_STATS ) && ( CONFIG_HEAP_MEM_POOL_SIZE > 0 )
+    struct sys_memory_stats heap;
+
+    if( sys_heap_runtime_stats_get( &_system_heap, &heap ) == 0 )
+    {
+        LOG_INF( "Heap: %u of %u bytes used at most", ( unsigned int ) heap.max_allocated_bytes,
+                 ( unsigned int ) ( heap.allocated_bytes + heap.free_bytes ) );
+    }
+    #endif /* if defined( CONFIG_SYS_HEAP_RUNTIME_STATS ) && ( CONFIG_HEAP_MEM_POOL_SIZE > 0 ) */
+
+    #if defined( CONFIG_THREAD_STACK_INFO ) && defined( CONFIG_INIT_STACKS )
+    k_thread_foreach( prv_stack_report, NULL );
+    #endif /* if defined( CONFIG_THREAD_STACK_INFO ) && defined( CONFIG_INIT_STACKS ) */
+
+    LOG_INF( "Benchmark done" );
+}
+
+/** @brief Acknowledge an uplink request with 2.04 Changed. */
+static void prv_server_handle_uplink( int fd )
+{
+    struct coap_packet request;
+    struct coap_packet response;
+    struct coap_option options[ BENCH_MAX_OPTIONS ];
+    struct sockaddr peer;
+    socklen_t peer_len = sizeof( peer );
+    uint8_t token[ COAP_TOKEN_MAX_LEN ];
+    uint8_t response_data[ 32 ];
+    uint8_t tkl;
+    ssize_t len;
+    int err;
+
+    len = zsock_recvfrom( fd, server_buffer, sizeof( server_buffer ), ZSOCK_MSG_DONTWAIT, &peer, &peer_len );
+
+    if( len <= 0 )
+    {
+        return;
+    }
+
+    if( coap_packet_parse( &request, server_buffer, len, options, BENCH_MAX_OPTIONS ) < 0 )
+    {
+        LOG_WRN( "Benchmark server: malformed uplink" );
+        return;
+    }
+
+    if( coap_header_get_type( &request ) == COAP_TYPE_CON )
+    {
+        err = coap_ack_init( &response, &request, response_data, sizeof( response_data ),
+                             COAP_RESPONSE_CODE_CHANGED );
+    }
+    else
+    {
+        tkl = coap_header_get_token( &request, token );
+        err = coap_packet_init( &response, response_data, sizeof( response_data ), COAP_VERSION_1,
+                                COAP_TYPE_NON_CON, tkl, token, COAP_RESPONSE_CODE_CHANGED, coap_next_id() );
+    }
+
+    if( err == 0 )
+    {
+        ( void ) zsock_sendto( fd, response.data, response.offset, 0, &peer, peer_len );
+    }
+}
+
+#if BENCH_DOWNLINKS
+/** @brief Downlink in flight, one at a time. */
+static uint16_t downlink_id;
+static uint32_t downlink_sent_at;
+static bool downlink_pending;
+
+/** @brief Send a Device Controller request to the demo's listening port. */
+static void prv_server_send_downlink( int fd )
+{
+    static uint8_t payload[ CONFIG_NCE_BENCH_DOWNLINK_PAYLOAD_SIZE ];
+    struct sockaddr_in device =
+    {
+        .sin_family = AF_INET,
+        .sin_port   = htons( CONFIG_NCE_RECV_PORT ),
+        .sin_addr   = INADDR_LOOPBACK_INIT,
+    };
+    struct coap_packet request;
+    int err;
+
+    if( downlink_pending )
+    {
+        k_spinlock_key_t key = k_spin_lock( &bench_lock );
+
+        downlink_lost++;
+        k_spin_unlock( &bench_lock, key );
+    }
+
+    memset( payload, 'd', sizeof( payload ) );
+    downlink_id = coap_next_id();
+
+    err = coap_packet_init( &request, server_buffer, sizeof( server_buffer ), COAP_VERSION_1, COAP_TYPE_CON,
+                            COAP_TOKEN_MAX_LEN, coap_next_token(), COAP_METHOD_POST, downlink_id );
+
+    if( err == 0 )
+    {
+        err = coap_packet_append_option( &request, COAP_OPTION_URI_PATH, BENCH_DOWNLINK_PATH,
+                                         sizeof( BENCH_DOWNLINK_PATH ) - 1 );
+    }
+
+    if( err == 0 )
+    {
+        err = coap_packet_append_payload_marker( &request );
+    }
+
+    if( err == 0 )
+    {
+        err = coap_packet_append_payload( &request, payload, sizeof( payload ) );
+    }
+
+    if( err < 0 )
+    {
+        LOG_ERR( "Benchmark server: failed to build downlink: %d", err );
+        return;
+    }
+
+    downlink_sent_at = k_cycle_get_32();
+    downlink_pending = zsock_sendto( fd, request.data, request.offset, 0, ( struct sockaddr * ) &device,
+                                     sizeof( device ) ) > 0;
+}
+
+/** @brief Match the demo's response to the downlink in flight. */
+static void prv_server_handle_downlink_response( int fd )
+{
+    struct coap_packet response;
+    struct coap_option options[ BENCH_MAX_OPTIONS ];
+    uint32_t latency_us;
+    k_spinlock_key_t key;
+    ssize_t len;
+
+    len = zsock_recv( fd, server_buffer, sizeof( server_buffer ), ZSOCK_MSG_DONTWAIT );
+
+    if( ( len <= 0 ) || ( coap_packet_parse( &response, server_buffer, len, options, BENCH_MAX_OPTIONS ) < 0 ) )
+    {
+        return;
+    }
+
+    if( !downlink_pending || ( coap_header_get_id( &response ) != downlink_id ) )
+    {
+        return;
+    }
+
+    downlink_pending = false;
+    latency_us = k_cyc_to_us_floor32( k_cycle_get_32() - downlink_sent_at );
+
+    key = k_spin_lock( &bench_lock );
+
+    if( !done && ( downlink_acked < ARRAY_SIZE( downlink_latency_us ) ) )
+    {
+        downlink_latency_us[ downlink_acked++ ] = latency_us;
+    }
+
+    k_spin_unlock( &bench_lock, key );
+}
+#endif /* if BENCH_DOWNLINKS */
+
+/** @brief Open the uplink server socket on the loopback address. */
+static int prv_server_socket( void )
+{
+    struct sockaddr_in addr =
+    {
+        .sin_family = AF_INET,
+        .sin_port   = htons( CONFIG_COAP_SAMPLE_SERVER_PORT ),
+        .sin_addr   = INADDR_LOOPBACK_INIT,
+    };
+    int fd;
+
+    #if defined( CONFIG_NCE_BENCH_DTLS )
+    static const sec_tag_t sec_tag[] = { CONFIG_NCE_BENCH_SECURITY_TAG };
+    int role = TLS_DTLS_ROLE_SERVER;
+    int verify = TLS_PEER_VERIFY_NONE;
+
+    fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_DTLS_1_2 );
+
+    if( ( fd >= 0 ) &&
+        ( ( zsock_setsockopt( fd, SOL_TLS, TLS_SEC_TAG_LIST, sec_tag, sizeof( sec_tag ) ) < 0 ) ||
+          ( zsock_setsockopt( fd, SOL_TLS, TLS_DTLS_ROLE, &role, sizeof( role ) ) < 0 ) ||
+          ( zsock_setsockopt( fd, SOL_TLS, TLS_PEER_VERIFY, &verify, sizeof( verify ) ) < 0 ) ) )
+    {
+        zsock_close( fd );
+        return -errno;
+    }
+    #else
+    fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+    #endif /* if defined( CONFIG_NCE_BENCH_DTLS ) */
+
+    if( fd < 0 )
+    {
+        return -errno;
+    }
+
+    if( zsock_bind( fd, ( struct sockaddr * ) &addr, sizeof( addr ) ) < 0 )
+    {
+        zsock_close( fd );
+        return -errno;
+    }
+
+    return fd;
+}
+
+static void prv_server_thread( void * p1,
+                               void * p2,
+                               void * p3 )
+{
+    struct zsock_pollfd fds[ 2 ] =
+    {
+        { .fd = -1, .events = ZSOCK_POLLIN },
+        { .fd = -1, .events = ZSOCK_POLLIN },
+    };
+    int nfds = 1;
+    int timeout = -1;
+
+    ARG_UNUSED( p1 );
+    ARG_UNUSED( p2 );
+    ARG_UNUSED( p3 );
+
+    fds[ 0 ].fd = prv_server_socket();
+
+    if( fds[ 0 ].fd < 0 )
+    {
+        LOG_ERR( "Benchmark server: no socket on port %d: %d", CONFIG_COAP_SAMPLE_SERVER_PORT, fds[ 0 ].fd );
+        return;
+    }
+
+    #if BENCH_DOWNLINKS
+    int64_t next_downlink = k_uptime_get() + CONFIG_NCE_BENCH_DOWNLINK_INTERVAL_MS;
+
+    fds[ 1 ].fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+
+    if( fds[ 1 ].fd >= 0 )
+    {
+        nfds = 2;
+    }
+    #endif /* if BENCH_DOWNLINKS */
+
+    LOG_INF( "Benchmark server listening on 127.0.0.1:%d", CONFIG_COAP_SAMPLE_SERVER_PORT );
+
+    while( true )
+    {
+        #if BENCH_DOWNLINKS
+        /* Downlinks start once the first uplink went through */
+        if( nfds == 2 )
+        {
+            timeout = MAX( next_downlink - k_uptime_get(), 0 );
+        }
+        #endif /* if BENCH_DOWNLINKS */
+
+        if( zsock_poll( fds, nfds, timeout ) < 0 )
+        {
+            LOG_ERR( "Benchmark server: poll failed: %d", errno );
+            break;
+        }
+
+        if( fds[ 0 ].revents & ZSOCK_POLLIN )
+        {
+            prv_server_handle_uplink( fds[ 0 ].fd );
+        }
+
+        #if BENCH_DOWNLINKS
+        if( ( nfds == 2 ) && ( fds[ 1 ].revents & ZSOCK_POLLIN ) )
+        {
+            prv_server_handle_downlink_response( fds[ 1 ].fd );
+        }
+
+        if( ( nfds == 2 ) && ( k_uptime_get() >= next_downlink ) )
+        {
+            next_downlink += CONFIG_NCE_BENCH_DOWNLINK_INTERVAL_MS;
+
+            if( uplink_acked > 0 )
+            {
+                prv_server_send_downlink( fds[ 1 ].fd );
+            }
+        }
+        #endif /* if BENCH_DOWNLINKS */
+    }
+
+    zsock_close( fds[ 0 ].fd );
+
+    if( fds[ 1 ].fd >= 0 )
+    {
+        zsock_close( fds[ 1 ].fd );
+    }
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+int bench_start( void )
+{
+    #if defined( CONFIG_NCE_BENCH_DTLS )
+    int err;
+
+    err = tls_credential_add( CONFIG_NCE_BENCH_SECURITY_TAG, TLS_CREDENTIAL_PSK, CONFIG_NCE_BENCH_PSK,
+                              sizeof( CONFIG_NCE_BENCH_PSK ) - 1 );
+
+    if( err == 0 )
+    {
+        err = tls_credential_add( CONFIG_NCE_BENCH_SECURITY_TAG, TLS_CREDENTIAL_PSK_ID,
+                                  CONFIG_NCE_BENCH_PSK_IDENTITY, sizeof( CONFIG_NCE_BENCH_PSK_IDENTITY ) - 1 );
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Failed to add the benchmark PSK: %d", err );
+        return err;
+    }
+    #endif /* if defined( CONFIG_NCE_BENCH_DTLS ) */
+
+    k_thread_create( &server_thread, server_stack, K_THREAD_STACK_SIZEOF( server_stack ), prv_server_thread,
+                     NULL, NULL, NULL, CONFIG_NCE_BENCH_SERVER_PRIORITY, 0, K_NO_WAIT );
+    k_thread_name_set( &server_thread, "bench_server" );
+
+    return 0;
+}
+
+int bench_build_payload( char * buffer,
+                         size_t size )
+{
+    char seq[ 11 ];
+    int len;
+
+    if( size < CONFIG_NCE_BENCH_PAYLOAD_SIZE )
+    {
+        return -ENOMEM;
+    }
+
+    /* Sequence number in front, so consecutive payloads differ */
+    len = snprintk( seq, sizeof( seq ), "%u", payload_seq++ );
+    memset( buffer, 'u', CONFIG_NCE_BENCH_PAYLOAD_SIZE );
+    memcpy( buffer, seq, MIN( len, CONFIG_NCE_BENCH_PAYLOAD_SIZE ) );
+
+    return CONFIG_NCE_BENCH_PAYLOAD_SIZE;
+}
+
+void bench_uplink_sent( void )
+{
+    k_spinlock_key_t key = k_spin_lock( &bench_lock );
+
+    if( !started )
+    {
+        started = true;
+        start_ms = k_uptime_get();
+        start_cpu_ns = bench_host_cpu_time_ns();
+    }
+
+    if( in_flight_count == BENCH_MAX_IN_FLIGHT )
+    {
+        /* The client never reported the oldest one */
+        in_flight_head = ( in_flight_head + 1 ) % BENCH_MAX_IN_FLIGHT;
+        in_flight_count--;
+        uplink_lost++;
+    }
+
+    in_flight[ ( in_flight_head + in_flight_count ) % BENCH_MAX_IN_FLIGHT ] = k_cycle_get_32();
+    in_flight_count++;
+
+    k_spin_unlock( &bench_lock, key );
+}
+
+void bench_uplink_done( bool acked )
+{
+    bool finished = false;
+    uint32_t sent_at;
+    k_spinlock_key_t key = k_spin_lock( &bench_lock );
+
+    if( ( in_flight_count == 0 ) || done )
+    {
+        k_spin_unlock( &bench_lock, key );
+        return;
+    }
+
+    sent_at = in_flight[ in_flight_head ];
+    in_flight_head = ( in_flight_head + 1 ) % BENCH_MAX_IN_FLIGHT;
+    in_flight_count--;
+
+    if( acked )
+    {
+        uplink_latency_us[ uplink_acked++ ] = k_cyc_to_us_floor32( k_cycle_get_32() - sent_at );
+        finished = ( uplink_acked == CONFIG_NCE_BENCH_MESSAGES );
+        done = finished;
+    }
+    else
+    {
+        uplink_lost++;
+    }
+
+    k_spin_unlock( &bench_lock, key );
+
+    if( finished )
+    {
+        k_work_submit( &report_work );
+    }
+}
+
+#if defined( CONFIG_NCE_BENCH_DTLS )
+int bench_dtls_setup( int fd )
+{
+    static const sec_tag_t sec_tag[] = { CONFIG_NCE_BENCH_SECURITY_TAG };
+    int verify = TLS_PEER_VERIFY_NONE;
+
+    if( ( zsock_setsockopt( fd, SOL_TLS, TLS_SEC_TAG_LIST, sec_tag, sizeof( sec_tag ) ) < 0 ) ||
+        ( zsock_setsockopt( fd, SOL_TLS, TLS_PEER_VERIFY, &verify, sizeof( verify ) ) < 0 ) )
+    {
+        return -errno;
+    }
+
+    return 0;
+}
+#endif /* if defined( CONFIG_NCE_BENCH_DTLS ) */
@@ -0,0 +1,68 @@
+/******************************************************************************
+ * @file    bench.h
+ * @brief   Loopback benchmark of the uplink and downlink paths on native_sim.
+ * @details A CoAP server thread on the loopback interface stands in for the
+ *          1NCE endpoint: it acknowledges every uplink POST, over plain UDP or
+ *          DTLS-PSK, and sends Device Controller requests to NCE_RECV_PORT at
+ *          a fixed interval. The demo sends uplinks of a fixed size at a fixed
+ *          interval through its normal path. Once NCE_BENCH_MESSAGES uplinks
+ *          are acknowledged, the benchmark logs the message rate, the p50 and
+ *          p99 latencies of both directions, the host CPU time per message and
+ *          the heap and stack high-water marks, followed by "Benchmark done".
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef BENCH_H__
+#define BENCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Add the DTLS credentials and start the server thread.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int bench_start( void );
+
+/**
+ * @brief Build the next uplink payload of NCE_BENCH_PAYLOAD_SIZE bytes.
+ *
+ * @param[out] buffer Destination buffer.
+ * @param[in]  size   Size of the destination buffer.
+ *
+ * @return Payload length in bytes, -ENOMEM if the buffer is too small.
+ */
+int bench_build_payload( char * buffer,
+                         size_t size );
+
+/**
+ * @brief Record that a CON uplink was handed to the CoAP client.
+ */
+void bench_uplink_sent( void );
+
+/**
+ * @brief Record the outcome of the oldest CON uplink in flight.
+ *
+ * @param[in] acked true if a response was received, false on timeout or error.
+ */
+void bench_uplink_done( bool acked );
+
+#if defined( CONFIG_NCE_BENCH_DTLS )
+
+/**
+ * @brief Configure an uplink socket for DTLS-PSK with the benchmark credentials.
+ *
+ * @param[in] fd Socket created with IPPROTO_DTLS_1_2.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int bench_dtls_setup( int fd );
+#endif /* if defined( CONFIG_NCE_BENCH_DTLS ) */
+
+#endif /* BENCH_H__ */
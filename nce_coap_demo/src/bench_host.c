@@ -0,0 +1,34 @@
+/******************************************************************************
+ * @file    bench_host.c
+ * @brief   Host side of the loopback benchmark.
+ * @details Built into the native_sim runner instead of the Zephyr image, so it
+ *          can read the CPU time of the host process. Simulated time does not
+ *          advance while code runs and cannot measure it.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <stdint.h>
+#include <time.h>
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+uint64_t bench_host_cpu_time_ns( void )
+{
+    struct timespec ts;
+
+    if( clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &ts ) != 0 )
+    {
+        return 0;
+    }
+
+    return ( uint64_t ) ts.tv_sec * 1000000000ULL + ( uint64_t ) ts.tv_nsec;
+}
@@ -0,0 +1,310 @@
+/******************************************************************************
+ * @file    block1_uplink.c
+ * @brief   Block-wise (RFC 7959 Block1) uplink streamed from a producer.
+ * @details See block1_uplink.h. Each block is a separate CoAP client request
+ *          carrying its own Block1 option. Blocks never exceed
+ *          COAP_CLIENT_BLOCK_SIZE, so the CoAP client sends every one of them
+ *          as a single message. The CoAP client callbacks do not expose the
+ *          response options, so the block size only follows the server
+ *          through 4.13 responses and not through the SZX of a 2.31.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/coap.h>
+#include <zephyr/sys/atomic.h>
+
+#include <nce_net_io.h>
+#include <nce_net_stats.h>
+
+#include "block1_uplink.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define BLOCK1_MAX_SZX            6 /* 1024 bytes */
+#define BLOCK1_SIZE( szx )        ( 16U << ( szx ) )
+#define BLOCK1_MAX_BLOCK_SIZE     MIN( MIN( BLOCK1_SIZE( BLOCK1_MAX_SZX ), CONFIG_COAP_CLIENT_BLOCK_SIZE ), \
+                                       CONFIG_COAP_CLIENT_MESSAGE_SIZE )
+
+/* IPv4 and UDP headers, then DTLS 1.2 record header, explicit nonce and CCM-8 tag */
+#define BLOCK1_IP_UDP_OVERHEAD    28
+#define BLOCK1_DTLS_OVERHEAD      29
+#define BLOCK1_DATAGRAM_OVERHEAD  ( BLOCK1_IP_UDP_OVERHEAD + CONFIG_COAP_CLIENT_MESSAGE_HEADER_SIZE + \
+                                    ( IS_ENABLED( CONFIG_NCE_ENABLE_DTLS ) ||                          \
+                                      IS_ENABLED( CONFIG_NCE_BENCH_DTLS ) ? BLOCK1_DTLS_OVERHEAD : 0 ) )
+
+#define BLOCK1_OPTION_BLOCK       0
+#define BLOCK1_OPTION_SIZE        1
+
+#define COAP_CODE_CLASS( code )   ( ( code ) >> 5 )
+
+BUILD_ASSERT( BLOCK1_MAX_BLOCK_SIZE >= BLOCK1_SIZE( 0 ), "CoAP client block size below 16 bytes" );
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static void prv_response_cb( int16_t code,
+                             size_t offset,
+                             const uint8_t * payload,
+                             size_t len,
+                             bool last_block,
+                             void * user_data );
+
+/** @brief Transfer state, changed on the I/O thread while busy is set. */
+static atomic_t busy;
+static struct block1_uplink_request transfer;
+static struct coap_client * transfer_client;
+static int transfer_fd;
+static int transfer_result;
+static uint32_t block_num;
+static bool block_more;
+static int8_t block_szx = -1;
+
+static uint8_t block_buffer[ BLOCK1_MAX_BLOCK_SIZE ];
+static struct coap_client_option block_options[ 2 ];
+static struct coap_client_request block_req =
+{
+    .method      = COAP_METHOD_POST,
+    .confirmable = true,
+    .cb          = prv_response_cb,
+    .options     = block_options,
+};
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Largest block whose datagram fits the path MTU. */
+static int8_t prv_szx_for_mtu( void )
+{
+    int8_t szx = BLOCK1_MAX_SZX;
+
+    while( ( szx > 0 ) &&
+           ( ( BLOCK1_SIZE( szx ) > BLOCK1_MAX_BLOCK_SIZE ) ||
+             ( BLOCK1_SIZE( szx ) + BLOCK1_DATAGRAM_OVERHEAD > CONFIG_NCE_BLOCK1_PATH_MTU ) ) )
+    {
+        szx--;
+    }
+
+    return szx;
+}
+
+/** @brief Encode an unsigned option value in as few bytes as possible. */
+static void prv_option_uint( struct coap_client_option * option,
+                             uint16_t code,
+                             uint32_t value )
+{
+    option->code = code;
+    option->len = 0;
+
+    for( int shift = 24; shift >= 0; shift -= 8 )
+    {
+        if( ( option->len > 0 ) || ( ( value >> shift ) & 0xff ) )
+        {
+            option->value[ option->len++ ] = ( uint8_t ) ( value >> shift );
+        }
+    }
+}
+
+/** @brief Pull the current block from the producer and send it. */
+static int prv_send_block( void )
+{
+    size_t size = BLOCK1_SIZE( block_szx );
+    bool last = false;
+    int len;
+    int err;
+
+    len = transfer.producer( block_buffer, size, block_num * size, &last, transfer.user_data );
+
+    if( len < 0 )
+    {
+        return len;
+    }
+
+    if( ( len == 0 ) && ( block_num == 0 ) )
+    {
+        return -ENODATA;
+    }
+
+    block_more = !last && ( ( size_t ) len == size );
+
+    prv_option_uint( &block_options[ BLOCK1_OPTION_BLOCK ], COAP_OPTION_BLOCK1,
+                     ( block_num << 4 ) | ( block_more ? BIT( 3 ) : 0 ) | block_szx );
+    block_req.num_options = 1;
+
+    if( ( block_num == 0 ) && ( transfer.total_len > 0 ) )
+    {
+        prv_option_uint( &block_options[ BLOCK1_OPTION_SIZE ], COAP_OPTION_SIZE1, transfer.total_len );
+        block_req.num_options = 2;
+    }
+
+    block_req.path = transfer.path;
+    block_req.fmt = transfer.fmt;
+    block_req.payload = block_buffer;
+    block_req.len = len;
+
+    /* The CoAP client copies the block, the buffer is free once this returns */
+    err = coap_client_req( transfer_client, transfer_fd, NULL, &block_req, NULL );
+
+    if( err )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        return err;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_TX_BYTES, len );
+    NCE_NET_LOG_INF( "Block %u (%d bytes%s) sent", block_num, len, block_more ? "" : ", last" );
+
+    return 0;
+}
+
+static void prv_done_fn( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    atomic_clear( &busy );
+
+    if( transfer.done )
+    {
+        transfer.done( transfer_result, transfer.user_data );
+    }
+}
+
+/** @brief End the transfer, the completion callback runs on the I/O thread. */
+static void prv_finish( int result )
+{
+    transfer_result = result;
+
+    if( nce_net_io_submit( prv_done_fn, NULL ) )
+    {
+        prv_done_fn( NULL );
+    }
+}
+
+static void prv_next_block_fn( void * user_data )
+{
+    int err;
+
+    ARG_UNUSED( user_data );
+
+    err = prv_send_block();
+
+    if( err )
+    {
+        LOG_ERR( "Block %u not sent: %d", block_num, err );
+        prv_finish( err );
+    }
+}
+
+/** @brief Response to a block, runs on the CoAP client thread. */
+static void prv_response_cb( int16_t code,
+                             size_t offset,
+                             const uint8_t * payload,
+                             size_t len,
+                             bool last_block,
+                             void * user_data )
+{
+    ARG_UNUSED( offset );
+    ARG_UNUSED( payload );
+    ARG_UNUSED( last_block );
+    ARG_UNUSED( user_data );
+
+    if( code < 0 )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        prv_finish( code );
+        return;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_RX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_RX_BYTES, len );
+
+    if( ( code == COAP_RESPONSE_CODE_REQUEST_TOO_LARGE ) && ( block_szx > 0 ) )
+    {
+        /* Kept for later transfers, the server will not take bigger blocks */
+        block_szx--;
+        block_num = 0;
+        LOG_WRN( "Server asked for smaller blocks, restarting with %u bytes", BLOCK1_SIZE( block_szx ) );
+    }
+    else if( ( COAP_CODE_CLASS( code ) == COAP_CODE_CLASS( COAP_RESPONSE_CODE_CONTINUE ) ) && block_more )
+    {
+        /* 2.31 Continue, or any success of a server that stores blocks as they come */
+        block_num++;
+    }
+    else
+    {
+        prv_finish( code );
+        return;
+    }
+
+    if( nce_net_io_submit( prv_next_block_fn, NULL ) )
+    {
+        prv_finish( -ENOMEM );
+    }
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+size_t block1_uplink_block_size( void )
+{
+    if( block_szx < 0 )
+    {
+        block_szx = prv_szx_for_mtu();
+    }
+
+    return BLOCK1_SIZE( block_szx );
+}
+
+int block1_uplink_send( struct coap_client * client,
+                        int fd,
+                        const struct block1_uplink_request * request )
+{
+    int err;
+
+    if( !request->producer )
+    {
+        return -EINVAL;
+    }
+
+    if( atomic_set( &busy, 1 ) )
+    {
+        return -EBUSY;
+    }
+
+    ( void ) block1_uplink_block_size();
+
+    transfer = *request;
+    transfer_client = client;
+    transfer_fd = fd;
+    block_num = 0;
+
+    err = prv_send_block();
+
+    if( err )
+    {
+        atomic_clear( &busy );
+    }
+
+    return err;
+}
+
+bool block1_uplink_busy( void )
+{
+    return atomic_get( &busy ) != 0;
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * @file    block1_uplink.h
+ * @brief   Block-wise (RFC 7959 Block1) uplink streamed from a producer.
+ * @details The payload is pulled block by block from a producer callback
+ *          into a working buffer of one block, so neither the application
+ *          nor the CoAP client holds the whole payload. Every block is a CON
+ *          POST with a Block1 option; the next block is sent once the server
+ *          answered 2.31 Continue. The block size is the largest power of two
+ *          whose datagram fits NCE_BLOCK1_PATH_MTU, and it is halved when the
+ *          server answers 4.13 Request Entity Too Large.
+ *
+ *          One transfer runs at a time. Blocks are sent and the completion
+ *          callback runs on the network I/O thread.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef BLOCK1_UPLINK_H__
+#define BLOCK1_UPLINK_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/net/coap_client.h>
+
+/**
+ * @brief Produce the payload bytes starting at @p offset.
+ *
+ * Called again with offset 0 if the transfer restarts with smaller blocks,
+ * so the producer must be able to seek.
+ *
+ * @param[out] buffer    Destination of the block.
+ * @param[in]  size      Block size, fill it completely unless this is the last block.
+ * @param[in]  offset    Payload offset of the block.
+ * @param[out] last      Set to true when the payload ends with this block.
+ * @param[in]  user_data User data of the request.
+ *
+ * @return Number of bytes written, negative error code to abort the transfer.
+ */
+typedef int (* block1_uplink_producer_t)( uint8_t * buffer,
+                                          size_t size,
+                                          size_t offset,
+                                          bool * last,
+                                          void * user_data );
+
+/**
+ * @brief Completion of a transfer.
+ *
+ * @param[in] result    Response code to the last block, negative error code
+ *                      if the transfer failed before it.
+ * @param[in] user_data User data of the request.
+ */
+typedef void (* block1_uplink_done_t)( int result,
+                                       void * user_data );
+
+/** @brief Block-wise uplink request. */
+struct block1_uplink_request
+{
+    const char * path;                  /**< URI path and query, as for coap_client_req(). */
+    uint8_t fmt;                        /**< Content format. */
+    size_t total_len;                   /**< Sent as Size1 if not 0. */
+    block1_uplink_producer_t producer;  /**< Payload producer. */
+    block1_uplink_done_t done;          /**< Completion callback, may be NULL. */
+    void * user_data;                   /**< Passed to the callbacks. */
+};
+
+/**
+ * @brief Current block size in bytes.
+ */
+size_t block1_uplink_block_size( void );
+
+/**
+ * @brief Start a block-wise transfer.
+ *
+ * @param[in] client  CoAP client.
+ * @param[in] fd      Connected socket.
+ * @param[in] request Request, copied.
+ *
+ * @return 0 if the first block was sent, -EBUSY while another transfer runs,
+ *         other negative error codes on failure.
+ */
+int block1_uplink_send( struct coap_client * client,
+                        int fd,
+                        const struct block1_uplink_request * request );
+
+/**
+ * @brief Check whether a transfer is running.
+ */
+bool block1_uplink_busy( void );
+
+#endif /* BLOCK1_UPLINK_H__ */
@@ -0,0 +1,174 @@
+/******************************************************************************
+ * @file    coap_dedup.c
+ * @brief   Duplicate detection for Device Controller requests.
+ * @details See coap_dedup.h. The cache is a small array searched linearly;
+ *          with a handful of entries this is cheaper than any index and
+ *          needs no allocation.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/net/net_ip.h>
+
+#include "coap_dedup.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+
+/* RFC 7252, section 4.8.2, with the default transmission parameters */
+#define EXCHANGE_LIFETIME_MS    ( 247 * MSEC_PER_SEC )
+#define NON_LIFETIME_MS         ( 145 * MSEC_PER_SEC )
+
+/* Header, token, payload marker and the largest handler payload */
+#define DEDUP_RESPONSE_SIZE     ( 4 + COAP_TOKEN_MAX_LEN + 1 + CONFIG_NCE_COAP_ROUTER_MAX_RESPONSE_PAYLOAD )
+
+/******************************************************************************
+* Types
+******************************************************************************/
+struct dedup_entry
+{
+    int64_t expires_at; /* Uptime in ms, 0 for a free entry */
+    struct sockaddr peer;
+    bool has_peer;
+    uint16_t id;
+    uint8_t tkl;
+    uint8_t token[ COAP_TOKEN_MAX_LEN ];
+    uint16_t response_len;
+    uint8_t response[ DEDUP_RESPONSE_SIZE ];
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct dedup_entry entries[ CONFIG_NCE_COAP_DEDUP_ENTRIES ];
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Compare address and port, recvfrom() leaves the padding undefined. */
+static bool prv_peer_equal( const struct dedup_entry * entry,
+                            const struct sockaddr * peer )
+{
+    if( !peer || !entry->has_peer )
+    {
+        return !peer && !entry->has_peer;
+    }
+
+    if( entry->peer.sa_family != peer->sa_family )
+    {
+        return false;
+    }
+
+    #if defined( CONFIG_NET_IPV6 )
+    if( peer->sa_family == AF_INET6 )
+    {
+        return ( net_sin6( &entry->peer )->sin6_port == net_sin6( peer )->sin6_port ) &&
+               net_ipv6_addr_cmp( &net_sin6( &entry->peer )->sin6_addr, &net_sin6( peer )->sin6_addr );
+    }
+    #endif /* if defined( CONFIG_NET_IPV6 ) */
+
+    return ( net_sin( &entry->peer )->sin_port == net_sin( peer )->sin_port ) &&
+           ( net_sin( &entry->peer )->sin_addr.s_addr == net_sin( peer )->sin_addr.s_addr );
+}
+
+static bool prv_entry_matches( const struct dedup_entry * entry,
+                               const struct sockaddr * peer,
+                               const struct coap_request_view * request,
+                               int64_t now )
+{
+    return ( entry->expires_at > now ) &&
+           ( entry->id == request->id ) &&
+           ( entry->tkl == request->tkl ) &&
+           ( memcmp( entry->token, request->token, request->tkl ) == 0 ) &&
+           prv_peer_equal( entry, peer );
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+bool coap_dedup_check( const struct sockaddr * peer,
+                       const struct coap_request_view * request,
+                       const uint8_t ** response,
+                       size_t * response_len )
+{
+    int64_t now = k_uptime_get();
+
+    for( int i = 0; i < ARRAY_SIZE( entries ); i++ )
+    {
+        if( prv_entry_matches( &entries[ i ], peer, request, now ) )
+        {
+            *response = ( entries[ i ].response_len > 0 ) ? entries[ i ].response : NULL;
+            *response_len = entries[ i ].response_len;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void coap_dedup_store( const struct sockaddr * peer,
+                       const struct coap_request_view * request,
+                       const uint8_t * response,
+                       size_t response_len )
+{
+    int64_t now = k_uptime_get();
+    struct dedup_entry * entry = &entries[ 0 ];
+
+    /* Free or expired entry, else the one that expires first */
+    for( int i = 0; i < ARRAY_SIZE( entries ); i++ )
+    {
+        if( entries[ i ].expires_at <= now )
+        {
+            entry = &entries[ i ];
+            break;
+        }
+
+        if( entries[ i ].expires_at < entry->expires_at )
+        {
+            entry = &entries[ i ];
+        }
+    }
+
+    if( entry->expires_at > now )
+    {
+        LOG_DBG( "Dedup cache full, dropping msg ID %u early", entry->id );
+    }
+
+    entry->expires_at = now + ( ( request->type == COAP_TYPE_CON ) ? EXCHANGE_LIFETIME_MS : NON_LIFETIME_MS );
+    entry->has_peer = ( peer != NULL );
+
+    if( peer )
+    {
+        entry->peer = *peer;
+    }
+
+    entry->id = request->id;
+    entry->tkl = request->tkl;
+    memcpy( entry->token, request->token, request->tkl );
+
+    /* Only the ACK of a CON request is ever sent again */
+    if( ( request->type == COAP_TYPE_CON ) && response && ( response_len <= sizeof( entry->response ) ) )
+    {
+        memcpy( entry->response, response, response_len );
+        entry->response_len = ( uint16_t ) response_len;
+    }
+    else
+    {
+        entry->response_len = 0;
+    }
+}
@@ -0,0 +1,62 @@
+/******************************************************************************
+ * @file    coap_dedup.h
+ * @brief   Duplicate detection for Device Controller requests.
+ * @details A server retransmits a confirmable request when our ACK is lost.
+ *          Every handled request is remembered by peer, message ID and
+ *          token together with the encoded response, for EXCHANGE_LIFETIME
+ *          (247 s) after a CON and NON_LIFETIME (145 s) after a NON request
+ *          (RFC 7252, section 4.8.2). A duplicate CON is answered with the
+ *          cached ACK and a duplicate NON is dropped, the handler does not
+ *          run again. The cache holds CONFIG_NCE_COAP_DEDUP_ENTRIES
+ *          requests, when it is full the entry closest to expiry is reused.
+ *
+ *          Not thread safe, call from the network I/O thread only.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef COAP_DEDUP_H__
+#define COAP_DEDUP_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/net/socket.h>
+
+#include "coap_router.h"
+
+/**
+ * @brief Look a request up in the cache.
+ *
+ * @param[in]  peer         Sender of the request, NULL for requests carried
+ *                          by notifications of the uplink server.
+ * @param[in]  request      Parsed request.
+ * @param[out] response     Cached response to send again, NULL if there is
+ *                          none (NON request or response too large).
+ * @param[out] response_len Length of the cached response.
+ *
+ * @return true if the request is a duplicate and must not be handled again.
+ */
+bool coap_dedup_check( const struct sockaddr * peer,
+                       const struct coap_request_view * request,
+                       const uint8_t ** response,
+                       size_t * response_len );
+
+/**
+ * @brief Remember a handled request and its encoded response.
+ *
+ * @param[in] peer         Sender of the request, NULL as for coap_dedup_check().
+ * @param[in] request      Parsed request.
+ * @param[in] response     Encoded response message, may be NULL.
+ * @param[in] response_len Length of the response.
+ */
+void coap_dedup_store( const struct sockaddr * peer,
+                       const struct coap_request_view * request,
+                       const uint8_t * response,
+                       size_t response_len );
+
+#endif /* COAP_DEDUP_H__ */
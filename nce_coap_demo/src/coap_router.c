@@ -0,0 +1,334 @@
+/******************************************************************************
+ * @file    coap_router.c
+ * @brief   Method and URI-path routed dispatcher for Device Controller requests.
+ * @details See coap_router.h. Routes live in an open-addressing hash table of
+ *          2 * CONFIG_NCE_COAP_ROUTER_MAX_ROUTES slots. The key is an FNV-1a
+ *          hash over the method and the length-prefixed path segments, so the
+ *          registered "a/b" string and the received Uri-Path options hash the
+ *          same way without building a path string per request.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "coap_router.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define ROUTE_TABLE_SIZE    ( 2 * CONFIG_NCE_COAP_ROUTER_MAX_ROUTES )
+#define FNV1A_OFFSET        2166136261U
+#define FNV1A_PRIME         16777619U
+
+/******************************************************************************
+* Types
+******************************************************************************/
+struct coap_route
+{
+    const char * path;
+    coap_route_handler_t handler;
+    uint32_t hash;
+    uint8_t method;
+};
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct coap_route route_table[ ROUTE_TABLE_SIZE ];
+static size_t route_count;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static uint32_t prv_fnv1a( uint32_t hash,
+                           const uint8_t * data,
+                           size_t len )
+{
+    for( size_t i = 0; i < len; i++ )
+    {
+        hash ^= data[ i ];
+        hash *= FNV1A_PRIME;
+    }
+
+    return hash;
+}
+
+static uint32_t prv_hash_segment( uint32_t hash,
+                                  const uint8_t * segment,
+                                  size_t len )
+{
+    uint8_t len_byte = ( uint8_t ) len;
+
+    hash = prv_fnv1a( hash, &len_byte, 1 );
+    return prv_fnv1a( hash, segment, len );
+}
+
+/** @brief Return the next '/'-separated segment of @p cursor and advance it, NULL at the end. */
+static const char * prv_next_segment( const char ** cursor,
+                                      size_t * len )
+{
+    const char * start = *cursor;
+    const char * end;
+
+    while( *start == '/' )
+    {
+        start++;
+    }
+
+    if( *start == '\0' )
+    {
+        *cursor = start;
+        return NULL;
+    }
+
+    end = strchr( start, '/' );
+
+    if( end == NULL )
+    {
+        end = start + strlen( start );
+    }
+
+    *len = end - start;
+    *cursor = end;
+
+    return start;
+}
+
+static bool prv_paths_equal( const char * a,
+                             const char * b )
+{
+    const char * seg_a;
+    const char * seg_b;
+    size_t len_a;
+    size_t len_b;
+
+    do
+    {
+        seg_a = prv_next_segment( &a, &len_a );
+        seg_b = prv_next_segment( &b, &len_b );
+
+        if( ( seg_a == NULL ) || ( seg_b == NULL ) )
+        {
+            return seg_a == seg_b;
+        }
+    } while( ( len_a == len_b ) && ( memcmp( seg_a, seg_b, len_a ) == 0 ) );
+
+    return false;
+}
+
+static uint32_t prv_hash_path_string( uint8_t method,
+                                      const char * path,
+                                      size_t * segments )
+{
+    uint32_t hash = prv_fnv1a( FNV1A_OFFSET, &method, 1 );
+    const char * segment;
+    size_t len;
+
+    *segments = 0;
+
+    while( ( segment = prv_next_segment( &path, &len ) ) != NULL )
+    {
+        hash = prv_hash_segment( hash, ( const uint8_t * ) segment, len );
+        ( *segments )++;
+    }
+
+    return hash;
+}
+
+static uint32_t prv_hash_request( const struct coap_request_view * request )
+{
+    uint32_t hash = prv_fnv1a( FNV1A_OFFSET, &request->code, 1 );
+
+    for( uint8_t i = 0; i < request->path_count; i++ )
+    {
+        hash = prv_hash_segment( hash, request->path[ i ]->value, request->path[ i ]->len );
+    }
+
+    return hash;
+}
+
+static bool prv_route_matches( const struct coap_route * route,
+                               const struct coap_request_view * request )
+{
+    const char * cursor = route->path;
+    const char * segment;
+    size_t len;
+    uint8_t i = 0;
+
+    if( route->method != request->code )
+    {
+        return false;
+    }
+
+    while( ( segment = prv_next_segment( &cursor, &len ) ) != NULL )
+    {
+        if( ( i >= request->path_count ) ||
+            ( request->path[ i ]->len != len ) ||
+            ( memcmp( request->path[ i ]->value, segment, len ) != 0 ) )
+        {
+            return false;
+        }
+
+        i++;
+    }
+
+    return i == request->path_count;
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+int coap_router_register( uint8_t method,
+                          const char * path,
+                          coap_route_handler_t handler )
+{
+    size_t segments;
+    uint32_t hash;
+    size_t slot;
+
+    if( ( path == NULL ) || ( handler == NULL ) )
+    {
+        return -EINVAL;
+    }
+
+    hash = prv_hash_path_string( method, path, &segments );
+
+    if( segments > CONFIG_NCE_COAP_MAX_URI_PATH_SEGMENTS )
+    {
+        LOG_ERR( "Route %s has more than %d segments", path, CONFIG_NCE_COAP_MAX_URI_PATH_SEGMENTS );
+        return -EINVAL;
+    }
+
+    if( route_count >= CONFIG_NCE_COAP_ROUTER_MAX_ROUTES )
+    {
+        LOG_ERR( "Route table full, increase CONFIG_NCE_COAP_ROUTER_MAX_ROUTES" );
+        return -ENOMEM;
+    }
+
+    slot = hash % ROUTE_TABLE_SIZE;
+
+    /* The table is never more than half full, so an empty slot is always found */
+    while( route_table[ slot ].handler != NULL )
+    {
+        if( ( route_table[ slot ].hash == hash ) &&
+            ( route_table[ slot ].method == method ) &&
+            prv_paths_equal( route_table[ slot ].path, path ) )
+        {
+            return -EALREADY;
+        }
+
+        slot = ( slot + 1 ) % ROUTE_TABLE_SIZE;
+    }
+
+    route_table[ slot ].path = path;
+    route_table[ slot ].handler = handler;
+    route_table[ slot ].hash = hash;
+    route_table[ slot ].method = method;
+    route_count++;
+
+    LOG_DBG( "Registered route %u %s (slot %u)", method, path, slot );
+
+    return 0;
+}
+
+int coap_request_view_parse( struct coap_request_view * view,
+                             uint8_t * data,
+                             size_t len )
+{
+    int num_options;
+
+    memset( view, 0, sizeof( *view ) );
+    view->content_format = COAP_REQUEST_NO_CONTENT_FORMAT;
+
+    num_options = coap_packet_parse( &view->packet, data, len, view->options,
+                                     CONFIG_NCE_COAP_ROUTER_MAX_OPTIONS );
+
+    if( num_options < 0 )
+    {
+        return num_options;
+    }
+
+    view->type = coap_header_get_type( &view->packet );
+    view->code = coap_header_get_code( &view->packet );
+    view->id = coap_header_get_id( &view->packet );
+    view->tkl = coap_header_get_token( &view->packet, view->token );
+    view->payload = coap_packet_get_payload( &view->packet, &view->payload_len );
+
+    /* Options are stored in the order they appear on the wire */
+    for( int i = 0; i < MIN( num_options, CONFIG_NCE_COAP_ROUTER_MAX_OPTIONS ); i++ )
+    {
+        const struct coap_option * option = &view->options[ i ];
+
+        switch( option->delta )
+        {
+            case COAP_OPTION_URI_PATH:
+
+                if( view->path_count >= CONFIG_NCE_COAP_MAX_URI_PATH_SEGMENTS )
+                {
+                    return -E2BIG;
+                }
+
+                view->path[ view->path_count++ ] = option;
+                break;
+
+            case COAP_OPTION_URI_QUERY:
+
+                if( view->query_count < CONFIG_NCE_COAP_MAX_URI_QUERY_PARAMS )
+                {
+                    view->query[ view->query_count++ ] = option;
+                }
+                else
+                {
+                    LOG_WRN( "Dropping Uri-Query beyond %d parameters", CONFIG_NCE_COAP_MAX_URI_QUERY_PARAMS );
+                }
+
+                break;
+
+            case COAP_OPTION_CONTENT_FORMAT:
+                view->content_format = coap_option_value_to_int( option );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    return 0;
+}
+
+uint8_t coap_router_dispatch( const struct coap_request_view * request,
+                              uint8_t * response_payload,
+                              size_t * response_len )
+{
+    uint32_t hash = prv_hash_request( request );
+    size_t slot = hash % ROUTE_TABLE_SIZE;
+
+    while( route_table[ slot ].handler != NULL )
+    {
+        if( ( route_table[ slot ].hash == hash ) &&
+            prv_route_matches( &route_table[ slot ], request ) )
+        {
+            return route_table[ slot ].handler( request, response_payload, response_len );
+        }
+
+        slot = ( slot + 1 ) % ROUTE_TABLE_SIZE;
+    }
+
+    *response_len = 0;
+
+    return COAP_RESPONSE_CODE_NOT_FOUND;
+}
@@ -0,0 +1,109 @@
+/******************************************************************************
+ * @file    coap_router.h
+ * @brief   Method and URI-path routed dispatcher for Device Controller requests.
+ * @details A downlink is parsed once into a coap_request_view holding the
+ *          header fields, the Uri-Path and Uri-Query options, the content
+ *          format and the payload. Handlers are registered for a method and
+ *          a path and are found through a fixed-size hash table keyed on the
+ *          method and the path segments, so dispatch is O(1) and no option
+ *          is searched twice. The handler's return value is sent back as the
+ *          response code.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef COAP_ROUTER_H__
+#define COAP_ROUTER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/net/coap.h>
+
+/** @brief Content format value when the request has no Content-Format option. */
+#define COAP_REQUEST_NO_CONTENT_FORMAT    ( -1 )
+
+/**
+ * @brief Parsed view of a CoAP request.
+ *
+ * Path and query entries point into @ref options, the payload points into the
+ * receive buffer, which must outlive the view.
+ */
+struct coap_request_view
+{
+    struct coap_packet packet;
+    struct coap_option options[ CONFIG_NCE_COAP_ROUTER_MAX_OPTIONS ];
+    const struct coap_option * path[ CONFIG_NCE_COAP_MAX_URI_PATH_SEGMENTS ];
+    const struct coap_option * query[ CONFIG_NCE_COAP_MAX_URI_QUERY_PARAMS ];
+    uint8_t path_count;
+    uint8_t query_count;
+    uint8_t type;
+    uint8_t code;
+    uint16_t id;
+    uint8_t token[ COAP_TOKEN_MAX_LEN ];
+    uint8_t tkl;
+    int content_format;
+    const uint8_t * payload;
+    uint16_t payload_len;
+};
+
+/**
+ * @brief Request handler.
+ *
+ * @param[in]     request          Parsed request.
+ * @param[out]    response_payload Buffer for an optional response payload.
+ * @param[in,out] response_len     Size of @p response_payload on entry, length
+ *                                 of the response payload on return (0 if none).
+ *
+ * @return CoAP response code, e.g. COAP_RESPONSE_CODE_CHANGED.
+ */
+typedef uint8_t ( * coap_route_handler_t )( const struct coap_request_view * request,
+                                            uint8_t * response_payload,
+                                            size_t * response_len );
+
+/**
+ * @brief Register a handler for a method and a URI path.
+ *
+ * @param[in] method  CoAP method, e.g. COAP_METHOD_POST.
+ * @param[in] path    URI path such as "/example" or "led/on". The string is
+ *                    referenced, not copied, and must stay valid.
+ * @param[in] handler Handler to call.
+ *
+ * @return 0 on success, -EALREADY if the route exists, -ENOMEM if the table
+ *         is full, -EINVAL on invalid arguments.
+ */
+int coap_router_register( uint8_t method,
+                          const char * path,
+                          coap_route_handler_t handler );
+
+/**
+ * @brief Parse a received datagram into a request view.
+ *
+ * @param[out] view View to fill.
+ * @param[in]  data Received datagram.
+ * @param[in]  len  Datagram length.
+ *
+ * @return 0 on success, negative error code if the message is malformed.
+ */
+int coap_request_view_parse( struct coap_request_view * view,
+                             uint8_t * data,
+                             size_t len );
+
+/**
+ * @brief Run the handler registered for a request.
+ *
+ * @param[in]     request          Parsed request.
+ * @param[out]    response_payload Buffer for an optional response payload.
+ * @param[in,out] response_len     Size of the buffer on entry, payload length on return.
+ *
+ * @return The handler's response code, COAP_RESPONSE_CODE_NOT_FOUND if no
+ *         route matches.
+ */
+uint8_t coap_router_dispatch( const struct coap_request_view * request,
+                              uint8_t * response_payload,
+                              size_t * response_len );
+
+#endif /* COAP_ROUTER_H__ */
@@ -42,19 +42,87 @@
 #include <zephyr/net/coap_client.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/logging/log_ctrl.h>
-#include <modem/lte_lc.h>
-#include <modem/nrf_modem_lib.h>
-#include <modem/at_monitor.h>
-#include <modem/modem_info.h>
+#if defined( CONFIG_NRF_MODEM_LIB )
+    #include <modem/lte_lc.h>
+    #include <modem/nrf_modem_lib.h>
+    #include <modem/at_monitor.h>
+    #include <modem/modem_info.h>
+    #include <nrf_modem_at.h>
+#endif /* if defined( CONFIG_NRF_MODEM_LIB ) */
 
 #include "nce_iot_c_sdk.h"
 #include <network_interface_zephyr.h>
+#include <nce_coap_buf_pool.h>
+#include <nce_net_io.h>
+#include <nce_net_stats.h>
+#include <nce_retry.h>
+
+#if defined( CONFIG_NCE_DNS_CACHE )
+    #include <nce_dns_cache.h>
+#endif /* if defined( CONFIG_NCE_DNS_CACHE ) */
+
+#if defined( CONFIG_NCE_UPLINK_QUEUE )
+    #include <nce_uplink_queue.h>
+#endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+#if defined( CONFIG_NCE_RADIO_SCHED )
+    #include <nce_radio_sched.h>
+#endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+
+#if defined( CONFIG_NCE_ENERGY_ACCT )
+    #include <nce_energy_acct.h>
+#endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+
+#if defined( CONFIG_NCE_COAP_STATS )
+    #include <nce_coap_stats.h>
+#endif /* if defined( CONFIG_NCE_COAP_STATS ) */
+
+#if defined( CONFIG_NCE_COAP_RTO )
+    #include <nce_coap_rto.h>
+#endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+
+#if defined( CONFIG_NCE_UPLINK_COMPRESSION )
+    #include <nce_lz.h>
+#endif /* if defined( CONFIG_NCE_UPLINK_COMPRESSION ) */
+
+#if defined( CONFIG_NCE_UPLINK_BATCHING )
+    #include "uplink_batch.h"
+#endif /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+#if defined( CONFIG_NCE_UPLINK_BLOCK1 )
+    #include "block1_uplink.h"
+#endif /* if defined( CONFIG_NCE_UPLINK_BLOCK1 ) */
+#if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    #include "senml_cbor.h"
+#endif /* if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR ) */
+#if defined( CONFIG_DATE_TIME )
+    #include <date_time.h>
+#endif /* if defined( CONFIG_DATE_TIME ) */
+#if defined( CONFIG_NCE_UPLINK_ADAPTIVE_CONFIRM )
+    #include "uplink_confirm.h"
+#endif /* if defined( CONFIG_NCE_UPLINK_ADAPTIVE_CONFIRM ) */
+#if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN )
+    #include "nce_energy_saver_template.h"
+#endif /* if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN ) */
+#if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
+    #include "coap_router.h"
+#endif /* if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER ) */
+#if defined( CONFIG_NCE_COAP_DEDUP )
+    #include "coap_dedup.h"
+#endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
+#if defined( CONFIG_NCE_BOOT_PROFILE )
+    #include <nce_boot_profile.h>
+#endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
+#if defined( CONFIG_NCE_MODEM_DIAG )
+    #include "modem_diag.h"
+#endif /* if defined( CONFIG_NCE_MODEM_DIAG ) */
+#if defined( CONFIG_NCE_BENCH )
+    #include "bench.h"
+#endif /* if defined( CONFIG_NCE_BENCH ) */
 
 LOG_MODULE_REGISTER( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
 
 #if defined( CONFIG_NCE_ENABLE_DTLS )
     #include <modem/modem_key_mgmt.h>
-    #include <nrf_modem_at.h>
     #include <zephyr/net/tls_credentials.h>
 #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
 #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
@@ -75,28 +143,116 @@ static struct gpio_dt_spec ledBlue = GPIO_DT_SPEC_GET_OR( DT_ALIAS( led2 ), gpio
 #define L4_EVENT_MASK            ( NET_EVENT_L4_CONNECTED | NET_EVENT_L4_DISCONNECTED )
 #define CONN_LAYER_EVENT_MASK    ( NET_EVENT_CONN_IF_FATAL_ERROR )
 
-#define THREAD_PRIORITY          5
-
-
-/** @brief Kernel stack and threading configurations */
-#define UPLINK_STACK_SIZE    4096
-K_THREAD_STACK_DEFINE( uplink_thread_stack, UPLINK_STACK_SIZE );
-struct k_thread uplink_thread;
+/** @brief Uplink state, owned by the network I/O thread. */
+static struct nce_net_io_timer uplink_timer;
+static struct nce_net_io_timer uplink_connect_timer;
 static int uplink_fd = -1;
+static struct nce_retry uplink_retry;
+#if defined( CONFIG_NCE_COAP_RTO )
+static struct nce_coap_rto uplink_rto;
+static struct in_addr uplink_rto_addr;
+#endif /* if defined( CONFIG_NCE_COAP_RTO ) */
 /** @brief Construct CoAP URI path with configurable query parameter. */
 #define CONFIG_URI_PATH    "/?" CONFIG_COAP_URI_QUERY
 /** @brief CoAP Client structures. */
 struct coap_client coap_client = { 0 };
 
+/** @brief Size of a single encoded telemetry sample. */
+#if defined( CONFIG_NCE_BENCH )
+    #define SAMPLE_BUFFER_SIZE    CONFIG_NCE_BENCH_PAYLOAD_SIZE
+#elif defined( CONFIG_NCE_ENERGY_SAVER )
+    #define SAMPLE_BUFFER_SIZE    CONFIG_NCE_PAYLOAD_DATA_SIZE
+#elif defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    #define SAMPLE_BUFFER_SIZE    CONFIG_NCE_SENML_SAMPLE_BUFFER_SIZE
+#else
+    #define SAMPLE_BUFFER_SIZE    sizeof( CONFIG_PAYLOAD )
+#endif /* if defined( CONFIG_NCE_BENCH ) */
+
+/** @brief Sampling interval, milliseconds apart in the benchmark. */
+#if defined( CONFIG_NCE_BENCH )
+    #define UPLINK_INTERVAL    K_MSEC( CONFIG_NCE_BENCH_UPLINK_INTERVAL_MS )
+#else
+    #define UPLINK_INTERVAL    K_SECONDS( CONFIG_COAP_SAMPLE_REQUEST_INTERVAL_SECONDS )
+#endif /* if defined( CONFIG_NCE_BENCH ) */
+
+/** @brief Content format of uplinks, application/senml+cbor is 112 (RFC 8428). */
+#if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    #define UPLINK_CONTENT_FORMAT    112
+#else
+    #define UPLINK_CONTENT_FORMAT    COAP_CONTENT_FORMAT_TEXT_PLAIN
+#endif /* if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR ) */
+
+#if defined( CONFIG_NCE_UPLINK_QUEUE )
+/** @brief Payload of a CON uplink in flight, queued again if it is lost. */
+struct uplink_copy
+{
+    atomic_t used;
+    int64_t time_ms; /**< Time of the payload's first sample. */
+    size_t len;
+    uint8_t payload[ CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE ];
+};
+
+/* Held by direct CON uplinks only, queued uplinks are read from flash again */
+static struct uplink_copy uplink_copies[ CONFIG_NCE_UPLINK_INFLIGHT_COPIES ];
+#endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+/** @brief Uplink request in flight, passed to response_cb as user_data. */
+struct uplink_req_ctx
+{
+    atomic_t used;
+    bool confirmable;
+    uint32_t sent_ms;
+    uint32_t acct_id;
+    struct coap_transmission_parameters params;
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    struct uplink_copy * copy; /**< NULL if the uplink is not queued again. */
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+};
+
+/* The client never has more requests in flight, a free context is left whenever it accepts one */
+static struct uplink_req_ctx uplink_req_ctxs[ CONFIG_COAP_CLIENT_MAX_REQUESTS ];
+
+#if defined( CONFIG_NCE_ENERGY_ACCT )
+
+/* Datagram headers around a CoAP message, with the DTLS record if enabled */
+    #if defined( CONFIG_NCE_ENABLE_DTLS )
+        #define UPLINK_DATAGRAM_OVERHEAD    ( NCE_ENERGY_ACCT_IP_UDP_OVERHEAD + NCE_ENERGY_ACCT_DTLS_OVERHEAD )
+    #else
+        #define UPLINK_DATAGRAM_OVERHEAD    NCE_ENERGY_ACCT_IP_UDP_OVERHEAD
+    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+
+/* CoAP header, 8 byte token, Uri-Path and Uri-Query, Content-Format and payload marker */
+    #define UPLINK_COAP_OVERHEAD      ( 4 + COAP_TOKEN_MAX_LEN + sizeof( CONFIG_URI_PATH ) + 2 + 1 )
+/* Response: CoAP header, token and payload marker */
+    #define RESPONSE_COAP_OVERHEAD    ( 4 + COAP_TOKEN_MAX_LEN + 1 )
+#endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+
+#if defined( CONFIG_NCE_UPLINK_QUEUE ) && defined( CONFIG_NCE_UPLINK_BATCHING )
+BUILD_ASSERT( CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE >= CONFIG_NCE_UPLINK_BATCH_MAX_PAYLOAD_SIZE,
+              "CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE cannot hold a full batch" );
+#elif defined( CONFIG_NCE_UPLINK_QUEUE )
+BUILD_ASSERT( CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE >= SAMPLE_BUFFER_SIZE,
+              "CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE cannot hold a sample" );
+#endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) && defined( CONFIG_NCE_UPLINK_BATCHING ) */
+
+#if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN )
+BUILD_ASSERT( CONFIG_NCE_PAYLOAD_DATA_SIZE >= NCE_ES_ENERGY_SAVER_SIZE,
+              "CONFIG_NCE_PAYLOAD_DATA_SIZE is smaller than the Energy Saver template" );
+#endif /* if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN ) */
+
 
 #if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
-    #define DOWNLINK_STACK_SIZE    3072
-K_THREAD_STACK_DEFINE( downlink_thread_stack, DOWNLINK_STACK_SIZE );
-struct k_thread downlink_thread;
-static int downlink_fd = -1;
+static struct nce_net_io_timer downlink_timer;
+static struct nce_retry downlink_retry;
     #define COAP_CODE_CLASS_SIZE       32
     #define COAP_SUCCESS_CODE_CLASS    2
 #endif
+#if defined( CONFIG_NCE_DOWNLINK_LISTEN )
+static int downlink_fd = -1;
+#endif
+#if defined( CONFIG_NCE_DOWNLINK_OBSERVE )
+static void prv_observe_register( void );
+#endif
 /** @brief Macro for handling fatal errors by rebooting the device. */
 #define FATAL_ERROR()                                    \
         LOG_ERR( "Fatal error! Rebooting the device." ); \
@@ -215,6 +371,194 @@ static void wait_for_network( void )
     k_mutex_unlock( &network_connected_lock );
 }
 
+#if defined( CONFIG_NCE_BOOT_PROFILE_UPLINK )
+static uint8_t boot_profile_buffer[ 2 * NCE_BOOT_PROFILE_RECORD_MAX_SIZE ];
+
+static void prv_boot_profile_response_cb( int16_t code,
+                                          size_t offset,
+                                          const uint8_t * payload,
+                                          size_t len,
+                                          bool last_block,
+                                          void * user_data )
+{
+    ARG_UNUSED( offset );
+    ARG_UNUSED( payload );
+    ARG_UNUSED( last_block );
+    ARG_UNUSED( user_data );
+
+    if( code < 0 )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_WRN( "Boot profile not acknowledged: %d", code );
+        return;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_RX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_RX_BYTES, len );
+}
+
+static struct coap_client_request boot_profile_req =
+{
+    .method      = COAP_METHOD_POST,
+    .confirmable = true,
+    .fmt         = COAP_CONTENT_FORMAT_APP_OCTET_STREAM,
+    .cb          = prv_boot_profile_response_cb,
+    .path        = "/?" CONFIG_NCE_BOOT_PROFILE_UPLINK_QUERY,
+    .payload     = boot_profile_buffer,
+};
+
+/** @brief Send the profile of this boot, followed by the previous one if recorded. */
+static void prv_boot_profile_send( void * user_data )
+{
+    struct nce_boot_profile profile;
+    size_t total = 0;
+    int len;
+    int err;
+
+    ARG_UNUSED( user_data );
+
+    if( uplink_fd < 0 )
+    {
+        return;
+    }
+
+    ( void ) nce_boot_profile_get( false, &profile );
+    len = nce_boot_profile_encode( &profile, boot_profile_buffer, sizeof( boot_profile_buffer ) );
+    total += ( len > 0 ) ? len : 0;
+
+    if( nce_boot_profile_get( true, &profile ) )
+    {
+        len = nce_boot_profile_encode( &profile, &boot_profile_buffer[ total ], sizeof( boot_profile_buffer ) - total );
+        total += ( len > 0 ) ? len : 0;
+    }
+
+    boot_profile_req.len = total;
+    err = coap_client_req( &coap_client, uplink_fd, NULL, &boot_profile_req, NULL );
+
+    if( err )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_WRN( "Failed to send the boot profile: %d", err );
+        return;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_TX_BYTES, total );
+}
+#endif /* if defined( CONFIG_NCE_BOOT_PROFILE_UPLINK ) */
+
+/** @brief Transmission parameters of the next CON uplink, adapted to the measured round trips. */
+static void prv_uplink_params( struct coap_transmission_parameters * params )
+{
+    #if defined( CONFIG_NCE_COAP_RTO )
+    nce_coap_rto_params( &uplink_rto, params );
+    #else
+    *params = coap_get_transmission_parameters();
+    #endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+}
+
+/** @brief A CON uplink sent with @p params completed. */
+static void prv_uplink_completed( const struct coap_transmission_parameters * params,
+                                  uint32_t sent_ms,
+                                  int16_t code )
+{
+    #if defined( CONFIG_NCE_COAP_RTO )
+    if( code >= 0 )
+    {
+        nce_coap_rto_sample( &uplink_rto, params, k_uptime_get_32() - sent_ms );
+    }
+    #endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+
+    #if defined( CONFIG_NCE_COAP_STATS )
+    nce_coap_stats_response( sent_ms, code, params->ack_timeout );
+    #endif /* if defined( CONFIG_NCE_COAP_STATS ) */
+}
+
+/** @brief An uplink was acknowledged, on the CoAP client or the I/O thread. */
+static void prv_uplink_acked( void )
+{
+    #if defined( CONFIG_NCE_BOOT_PROFILE )
+    static atomic_t first_acked;
+
+    if( atomic_set( &first_acked, 1 ) == 0 )
+    {
+        nce_boot_profile_mark( NCE_BOOT_PHASE_FIRST_UPLINK );
+        #if defined( CONFIG_NCE_BOOT_PROFILE_UPLINK )
+        ( void ) nce_net_io_submit( prv_boot_profile_send, NULL );
+        #endif /* if defined( CONFIG_NCE_BOOT_PROFILE_UPLINK ) */
+    }
+    #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
+}
+
+/** @brief Free an uplink context and the payload copy it holds. */
+static void prv_uplink_ctx_free( struct uplink_req_ctx * ctx )
+{
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    if( ctx->copy )
+    {
+        atomic_clear( &ctx->copy->used );
+        ctx->copy = NULL;
+    }
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    atomic_clear( &ctx->used );
+}
+
+#if defined( CONFIG_NCE_UPLINK_QUEUE )
+static void prv_uplink_drain( void );
+
+/** @brief Store a lost CON uplink in the queue and free its context, on the I/O thread. */
+static void prv_uplink_requeue_fn( void * user_data )
+{
+    struct uplink_req_ctx * ctx = user_data;
+    int err;
+
+    err = nce_uplink_queue_push( ctx->copy->payload, ctx->copy->len, ctx->copy->time_ms );
+    prv_uplink_ctx_free( ctx );
+
+    if( err )
+    {
+        LOG_ERR( "Lost uplink not queued: %d", err );
+        return;
+    }
+
+    LOG_INF( "Lost uplink queued, %u pending", nce_uplink_queue_count() );
+    prv_uplink_drain();
+}
+#endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+/**
+ * @brief Queue the payload of a CON uplink that was sent but never acknowledged.
+ *
+ * @return true if the context was handed over and is freed once the payload is queued.
+ */
+static bool prv_uplink_requeue( struct uplink_req_ctx * ctx,
+                                int16_t code )
+{
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    if( !ctx->confirmable || ( code >= 0 ) || !ctx->copy )
+    {
+        return false;
+    }
+
+    if( nce_net_io_submit( prv_uplink_requeue_fn, ctx ) == 0 )
+    {
+        return true;
+    }
+
+    /* The I/O thread is busy, store it from here and let the next sample drain the queue */
+    if( nce_uplink_queue_push( ctx->copy->payload, ctx->copy->len, ctx->copy->time_ms ) )
+    {
+        LOG_ERR( "Lost uplink not queued" );
+    }
+    #else
+    ARG_UNUSED( ctx );
+    ARG_UNUSED( code );
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    return false;
+}
+
 static void response_cb( int16_t code,
                          size_t offset,
                          const uint8_t * payload,
@@ -222,14 +566,60 @@ static void response_cb( int16_t code,
                          bool last_block,
                          void * user_data )
 {
+    struct uplink_req_ctx * ctx = user_data;
+
     if( code >= 0 )
     {
-        LOG_INF( "CoAP response: code: 0x%x", code );
+        nce_net_stats_inc( NCE_NET_STAT_RX_MSGS );
+        nce_net_stats_add( NCE_NET_STAT_RX_BYTES, len );
+        NCE_NET_LOG_INF( "CoAP response: code: 0x%x", code );
+        prv_uplink_acked();
     }
     else
     {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
         LOG_INF( "Response received with error code: %d", code );
     }
+
+    /* Uplinks carry their context, other requests sharing the callback have none */
+    if( ctx && ( last_block || ( code < 0 ) ) )
+    {
+        #if defined( CONFIG_NCE_UPLINK_ADAPTIVE_CONFIRM )
+        if( ctx->confirmable )
+        {
+            uplink_confirm_result( code >= 0 );
+        }
+        #endif /* if defined( CONFIG_NCE_UPLINK_ADAPTIVE_CONFIRM ) */
+
+        #if defined( CONFIG_NCE_ENERGY_ACCT )
+        nce_energy_acct_done( ctx->acct_id,
+                              ( code >= 0 ) ? len + RESPONSE_COAP_OVERHEAD + UPLINK_DATAGRAM_OVERHEAD : 0,
+                              ctx->confirmable ? ctx->params.ack_timeout : 0 );
+        #endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+
+        if( ctx->confirmable )
+        {
+            prv_uplink_completed( &ctx->params, ctx->sent_ms, code );
+        }
+        #if defined( CONFIG_NCE_COAP_STATS )
+        else
+        {
+            nce_coap_stats_response( ctx->sent_ms, code, 0 );
+        }
+        #endif /* if defined( CONFIG_NCE_COAP_STATS ) */
+
+        if( !prv_uplink_requeue( ctx, code ) )
+        {
+            prv_uplink_ctx_free( ctx );
+        }
+    }
+
+    #if defined( CONFIG_NCE_BENCH )
+    if( last_block || ( code < 0 ) )
+    {
+        bench_uplink_done( code >= 0 );
+    }
+    #endif /* if defined( CONFIG_NCE_BENCH ) */
 }
 #if defined( CONFIG_NCE_ENABLE_DTLS )
 /* Store DTLS Credentials in the modem */
@@ -260,9 +650,30 @@ int store_credentials( void )
     return err;
 }
 
+/** @brief The network did not come back after LTE went offline for the credentials, reboot as a last resort. */
+static void prv_reattach_timeout_fn( struct k_work * work )
+{
+    ARG_UNUSED( work );
+
+    if( !is_connected )
+    {
+        LOG_ERR( "Network not back %d s after going offline for credentials, rebooting",
+                 CONFIG_NCE_ONBOARDING_REATTACH_TIMEOUT_SECONDS );
+        sys_arch_reboot( 0 );
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE( reattach_work, prv_reattach_timeout_fn );
+
 /**
  * @brief Onboard the device by managing DTLS credentials.
  *
+ * New credentials are written with LTE offline, then the modem reattaches
+ * and the caller continues once the network is back. The modem reattaches
+ * even if storing fails. The device reboots only if the modem cannot be
+ * brought back online, or if the network is not back within
+ * CONFIG_NCE_ONBOARDING_REATTACH_TIMEOUT_SECONDS of going offline.
+ *
  * @param[in] overwrite Whether to overwrite existing credentials, should be set to true when DTLS connecting is failing.
  * @return 0 on success, negative error code on failure.
  */
@@ -296,6 +707,7 @@ static int prv_onboard_device( bool overwrite )
 
         LOG_INF( "Disconnecting from the network to store credentials\n" );
 
+        /* The modem keystore is only writable while LTE is off */
         err = lte_lc_offline();
 
         if( err )
@@ -304,17 +716,31 @@ static int prv_onboard_device( bool overwrite )
             return err;
         }
 
+        /* From here on every path ends online or in a reboot */
+        k_work_schedule( &reattach_work, K_SECONDS( CONFIG_NCE_ONBOARDING_REATTACH_TIMEOUT_SECONDS ) );
+
+        /* The L4 event arrives later, nothing may use the network until the reattach */
+        k_mutex_lock( &network_connected_lock, K_FOREVER );
+        is_connected = false;
+        k_mutex_unlock( &network_connected_lock );
+
         err = store_credentials();
 
         if( err )
         {
-            LOG_ERR( "Failed to store credentials, err %d\n", errno );
-            return err;
+            LOG_ERR( "Failed to store credentials, err %d, reattaching with the old ones\n", err );
+        }
+        else
+        {
+            /* New sockets pick up the new PSK, reattaching is enough */
+            LOG_INF( "Credentials stored, reattaching to the network" );
         }
 
-        LOG_INF( "Rebooting to ensure changes take effect after saving credentials.." );
-
-        sys_arch_reboot( 0 );
+        if( lte_lc_normal() )
+        {
+            LOG_ERR( "Failed to reattach, rebooting" );
+            sys_arch_reboot( 0 );
+        }
     }
     else
     {
@@ -386,8 +812,67 @@ static int dtls_setup( int fd )
         return err;
     }
 
+    #if defined( CONFIG_NCE_DTLS_SESSION_CACHE )
+    /* Resume the cached session with an abbreviated handshake on reconnect */
+    int session_cache = TLS_SESSION_CACHE_ENABLED;
+
+    err = zsock_setsockopt( fd, SOL_TLS, TLS_SESSION_CACHE, &session_cache, sizeof( session_cache ) );
+
+    if( err )
+    {
+        LOG_WRN( "[WRN] Failed to enable DTLS session cache, err %d\n", errno );
+    }
+    #endif /* if defined( CONFIG_NCE_DTLS_SESSION_CACHE ) */
+
+    #if defined( CONFIG_NCE_DTLS_CID )
+    /* Use the server's CID on uplink records, which is what keeps the
+     * session alive when the NAT binding changes after PSM */
+    int cid = TLS_DTLS_CID_SUPPORTED;
+
+    err = zsock_setsockopt( fd, SOL_TLS, TLS_DTLS_CID, &cid, sizeof( cid ) );
+
+    if( err )
+    {
+        LOG_WRN( "[WRN] DTLS Connection ID not supported, err %d\n", errno );
+    }
+    #endif /* if defined( CONFIG_NCE_DTLS_CID ) */
+
     return 0;
 }
+
+#if defined( CONFIG_NCE_DTLS_CID )
+/* Log whether the server agreed to use a Connection ID */
+static void dtls_log_cid_status( int fd )
+{
+    int status;
+    socklen_t len = sizeof( status );
+
+    if( zsock_getsockopt( fd, SOL_TLS, TLS_DTLS_CID_STATUS, &status, &len ) )
+    {
+        LOG_DBG( "DTLS CID status not available, err %d", errno );
+        return;
+    }
+
+    switch( status )
+    {
+        case TLS_DTLS_CID_STATUS_BIDIRECTIONAL:
+            LOG_INF( "DTLS Connection ID in use (bidirectional)" );
+            break;
+
+        case TLS_DTLS_CID_STATUS_UPLINK:
+            LOG_INF( "DTLS Connection ID in use (uplink)" );
+            break;
+
+        case TLS_DTLS_CID_STATUS_DOWNLINK:
+            LOG_INF( "DTLS Connection ID in use (downlink)" );
+            break;
+
+        default:
+            LOG_INF( "DTLS Connection ID not negotiated by the server" );
+            break;
+    }
+}
+#endif /* if defined( CONFIG_NCE_DTLS_CID ) */
 /* Handles DTLS failure by onboarding the device with overwriting enabled  */
 static int prv_handle_dtls_failure( void )
 {
@@ -403,287 +888,1685 @@ static int prv_handle_dtls_failure( void )
 
     return err;
 }
-#endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
 
-/** @brief Starts the uplink item. */
-void uplink_thread_fn( void * p1,
-                       void * p2,
-                       void * p3 )
+/** @brief Renew the credentials on the system workqueue, onboarding blocks for seconds. */
+static void prv_onboard_work_fn( struct k_work * work )
 {
-    int err;
-    int retry_count = 0;
-    const int MAX_RETRIES = CONFIG_NCE_UPLINK_MAX_RETRIES;
-    struct addrinfo * resolved_info = NULL;
-    struct coap_client_request req =
-    {
-        .method      = COAP_METHOD_POST,
-        .confirmable = true,
-        .fmt         = COAP_CONTENT_FORMAT_TEXT_PLAIN,
-        .cb          = response_cb,
-        .path        = CONFIG_URI_PATH,
-    };
+    ARG_UNUSED( work );
 
-    LOG_INF( "Uplink thread started..." );
+    ( void ) prv_handle_dtls_failure();
+}
+
+static K_WORK_DEFINE( onboard_work, prv_onboard_work_fn );
+#endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
 
-connect_retry:
-    retry_count++;
+#if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
 
-    if( retry_count > MAX_RETRIES )
+/**
+ * @brief Encode one telemetry sample as SenML-CBOR records.
+ *
+ * Without batching the records form a complete pack. With batching they are
+ * appended to the batch pack: the first sample of a batch carries the base
+ * fields and later samples their time relative to it. The base time is set
+ * by prv_uplink_stamp() when the pack is sent.
+ *
+ * @param[out] buffer   Destination buffer.
+ * @param[in]  size     Size of the destination buffer.
+ * @param[in]  base     Write the base fields.
+ * @param[in]  offset_s Seconds since the first sample of the batch.
+ * @return Sample length in bytes, -ENOMEM if the buffer is too small.
+ */
+static int prv_build_senml( char * buffer,
+                            size_t size,
+                            bool base,
+                            uint32_t offset_s )
+{
+    struct senml_cbor_writer w;
+    const struct senml_cbor_base base_fields =
     {
-        LOG_ERR( "Max uplink retries reached. Stopping uplink thread." );
+        .name      = CONFIG_NCE_SENML_BASE_NAME,
+        .time_slot = true,
+    };
 
-        if( uplink_fd > 0 )
-        {
-            zsock_close( uplink_fd );
-            uplink_fd = -1;
-        }
+    senml_cbor_init( &w, ( uint8_t * ) buffer, size );
 
-        return;
-    }
+    #if !defined( CONFIG_NCE_UPLINK_BATCHING )
+    senml_cbor_pack_begin( &w );
+    #endif
 
-    /* DNS Resolution */
-    {
-        struct addrinfo dns_hints =
-        {
-            .ai_family   = AF_INET,
-            .ai_socktype = SOCK_DGRAM,
-        };
-        err = zsock_getaddrinfo( CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, NULL, &dns_hints, &resolved_info );
+    senml_cbor_record_begin( &w, base ? &base_fields : NULL, "battery", "%EL", offset_s );
+    senml_cbor_value_int( &w, 99 );
+    senml_cbor_record_begin( &w, NULL, "signal", NULL, offset_s );
+    senml_cbor_value_int( &w, 84 );
+    senml_cbor_record_begin( &w, NULL, "version", NULL, offset_s );
+    senml_cbor_value_string( &w, "2.2.1" );
 
-        if( ( err < 0 ) || !resolved_info || !resolved_info->ai_addr )
-        {
-            LOG_ERR( "Failed to resolve hostname '%s', errno: %d", CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, errno );
-            err = -errno;
-            goto wait_and_retry;
-        }
+    #if !defined( CONFIG_NCE_UPLINK_BATCHING )
+    senml_cbor_pack_end( &w );
+    #endif
 
-        ( ( struct sockaddr_in * ) resolved_info->ai_addr )->sin_port = htons( CONFIG_COAP_SAMPLE_SERVER_PORT );
-        LOG_INF( "DNS Resolution successful" );
-    }
-    #if defined( CONFIG_NCE_ENABLE_DTLS )
-    uplink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_DTLS_1_2 );
-    #else
-    uplink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
-    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+    return senml_cbor_len( &w );
+}
+#endif /* if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR ) */
 
-    if( uplink_fd < 0 )
+/**
+ * @brief Set the time of a payload whose first sample was taken at @p time_ms (k_uptime_get()).
+ *
+ * SenML packs get an absolute base time once date_time knows the time. Until
+ * then the base time is relative to reception, which only holds if the pack
+ * is sent now, so a queued pack is stamped again when it is sent. Other
+ * payloads carry no time.
+ */
+static void prv_uplink_stamp( uint8_t * payload,
+                              size_t len,
+                              int64_t time_ms )
+{
+    #if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    int32_t age_s;
+    int32_t base_time;
+
+    if( time_ms < 0 )
     {
-        LOG_ERR( "Failed to create CoAP Uplink socket: %d.", -errno );
-        zsock_freeaddrinfo( resolved_info );
-        goto wait_and_retry;
+        /* Queued before a reboot, keep the time it was stamped with then */
+        return;
     }
 
-    #if defined( CONFIG_NCE_ENABLE_DTLS )
-    err = dtls_setup( uplink_fd );
+    age_s = ( int32_t ) ( ( k_uptime_get() - time_ms ) / MSEC_PER_SEC );
+    base_time = -age_s;
 
-    if( err )
+    #if defined( CONFIG_DATE_TIME )
+    int64_t now_ms;
+
+    if( date_time_now( &now_ms ) == 0 )
     {
-        LOG_ERR( "DTLS setup failed, err %d\n", err );
-        goto close_and_retry;
+        base_time = ( int32_t ) ( now_ms / MSEC_PER_SEC ) - age_s;
     }
-    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
-    err = zsock_connect( uplink_fd, ( struct sockaddr * ) resolved_info->ai_addr, sizeof( struct sockaddr_in ) );
-    zsock_freeaddrinfo( resolved_info );
+    #endif /* if defined( CONFIG_DATE_TIME ) */
 
-    if( err )
+    if( senml_cbor_patch_pack_base_time( payload, len, base_time ) )
     {
-        #if defined( CONFIG_NCE_ENABLE_DTLS )
-        connection_failure_count++;
-        LOG_ERR( "Failed to Connect to Uplink CoAPs Server. (Attempt:%d)\n", connection_failure_count );
-        #else
-        LOG_ERR( "Failed to Connect Uplink to CoAP Server" );
-        #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
-
-        goto close_and_retry;
+        LOG_WRN( "SenML pack has no base time" );
     }
+    #else /* if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR ) */
+    ARG_UNUSED( payload );
+    ARG_UNUSED( len );
+    ARG_UNUSED( time_ms );
+    #endif /* if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR ) */
+}
 
-    LOG_INF( "Connected to Uplink CoAP server %s:%d", CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, CONFIG_COAP_SAMPLE_SERVER_PORT );
-
-    while( 1 )
+/**
+ * @brief Build one telemetry sample.
+ *
+ * @param[out] buffer Destination buffer.
+ * @param[in]  size   Size of the destination buffer.
+ * @return Sample length in bytes, negative error code on failure.
+ */
+static int prv_build_sample( char * buffer,
+                             size_t size )
+{
+    #if defined( CONFIG_NCE_BENCH )
+    return bench_build_payload( buffer, size );
+    #elif defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN )
+    const struct nce_es_energy_saver values =
     {
-        #if defined( CONFIG_NCE_ENERGY_SAVER )
-        int converted_bytes = 0;
-        char buffer[ CONFIG_NCE_PAYLOAD_DATA_SIZE ];
+        .battery_level    = 99,
+        .signal_strength  = 84,
+        .software_version = "2.2.1",
+    };
 
-        LOG_INF( "\nCoAP client POST (Binary Payload)\n" );
+    NCE_NET_LOG_INF( "\nCoAP client POST (Binary Payload)\n" );
 
-        Element2byte_gen_t battery_level =
-        {
-            .type            = E_INTEGER,
-            .value.i         = 99,
-            .template_length = 1
+    if( size < NCE_ES_ENERGY_SAVER_SIZE )
+    {
+        return -ENOMEM;
+    }
+
+    size = nce_es_energy_saver_encode( ( uint8_t * ) buffer, &values );
+
+    NCE_NET_LOG_HEXDUMP_INF( buffer, size, "Payload (binary):" );
+    return size;
+    #elif defined( CONFIG_NCE_ENERGY_SAVER )
+    int converted_bytes = 0;
+
+    NCE_NET_LOG_INF( "\nCoAP client POST (Binary Payload)\n" );
+
+    Element2byte_gen_t battery_level =
+    {
+        .type            = E_INTEGER,
+        .value.i         = 99,
+        .template_length = 1
+    };
+    Element2byte_gen_t signal_strength =
+    {
+        .type            = E_INTEGER,
+        .value.i         = 84,
+        .template_length = 1
+    };
+    Element2byte_gen_t software_version =
+    {
+        .type            = E_STRING,
+        .value.s         = "2.2.1",
+        .template_length = 5
+    };
+
+    converted_bytes = os_energy_save( buffer, 1, 3,
+                                      battery_level,
+                                      signal_strength,
+                                      software_version );
+
+    if( converted_bytes < 0 )
+    {
+        LOG_ERR( "Failed to save energy, %d", errno );
+        return converted_bytes;
+    }
+
+    NCE_NET_LOG_HEXDUMP_INF( buffer, size, "Payload (binary):" );
+    return converted_bytes;
+    #elif defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    /* Batched samples are re-encoded relative to their batch when added */
+    int len = prv_build_senml( buffer, size, !IS_ENABLED( CONFIG_NCE_UPLINK_BATCHING ), 0 );
+
+    NCE_NET_LOG_INF( "\nCoAP client POST (SenML-CBOR Payload)\n" );
+
+    if( len > 0 )
+    {
+        NCE_NET_LOG_HEXDUMP_INF( buffer, len, "Payload (SenML-CBOR):" );
+    }
+
+    return len;
+    #else /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
+    size_t len = strlen( CONFIG_PAYLOAD );
+
+    if( len > size )
+    {
+        return -ENOMEM;
+    }
+
+    memcpy( buffer, CONFIG_PAYLOAD, len );
+    NCE_NET_LOG_INF( "Payload: %s", CONFIG_PAYLOAD );
+    return len;
+    #endif /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
+}
+
+#if defined( CONFIG_NCE_UPLINK_COMPRESSION )
+/** @brief Compressed payload, coap_client copies it into the request when it is sent. */
+static uint8_t compress_buffer[ CONFIG_COAP_CLIENT_MESSAGE_SIZE ];
+#endif /* if defined( CONFIG_NCE_UPLINK_COMPRESSION ) */
+
+/** @brief Attach a payload to a request, compressed if that makes it smaller. */
+static void prv_set_payload( struct coap_client_request * req,
+                             const uint8_t * payload,
+                             size_t len )
+{
+    req->payload = ( uint8_t * ) payload;
+    req->len = len;
+    req->fmt = UPLINK_CONTENT_FORMAT;
+
+    #if defined( CONFIG_NCE_UPLINK_COMPRESSION )
+    int compressed_len = -ENOSPC;
+
+    if( len > 1 )
+    {
+        compressed_len = nce_lz_compress( payload, len, compress_buffer,
+                                          MIN( len - 1, sizeof( compress_buffer ) ) );
+    }
+
+    if( compressed_len > 0 )
+    {
+        req->payload = compress_buffer;
+        req->len = compressed_len;
+        req->fmt = CONFIG_NCE_UPLINK_COMPRESSION_CONTENT_FORMAT;
+
+        NCE_NET_LOG_INF( "Payload compressed from %u to %d bytes (%u%%)", len, compressed_len,
+                         ( unsigned int ) ( compressed_len * 100 / len ) );
+    }
+    #endif /* if defined( CONFIG_NCE_UPLINK_COMPRESSION ) */
+}
+
+#if defined( CONFIG_NCE_UPLINK_BLOCK1 )
+static int prv_flush_due_batch( void );
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+static bool prv_uplink_link_error( int err );
+static void prv_uplink_reconnect( void );
+    #else
+/* The transfer reads from the batch buffer, which is reset once the transfer is acknowledged */
+static bool block1_holds_batch;
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+/**
+ * @brief Payload of the running block-wise transfer: the compression buffer,
+ *        the batch buffer, or NULL while it is read from the oldest queue entry.
+ */
+static const uint8_t * block1_payload;
+static size_t block1_payload_len;
+
+static int prv_block1_produce( uint8_t * buffer,
+                               size_t size,
+                               size_t offset,
+                               bool * last,
+                               void * user_data )
+{
+    int len = 0;
+
+    ARG_UNUSED( user_data );
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    if( !block1_payload )
+    {
+        len = nce_uplink_queue_read( 0, offset, buffer, size );
+        *last = ( len >= 0 ) && ( offset + len >= block1_payload_len );
+        return len;
+    }
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    if( offset < block1_payload_len )
+    {
+        len = MIN( size, block1_payload_len - offset );
+        memcpy( buffer, &block1_payload[ offset ], len );
+    }
+
+    *last = ( offset + len >= block1_payload_len );
+
+    return len;
+}
+
+static void prv_block1_done( int result,
+                             void * user_data )
+{
+    int err;
+
+    ARG_UNUSED( user_data );
+
+    if( ( result >= 0 ) && ( result < COAP_RESPONSE_CODE_BAD_REQUEST ) )
+    {
+        LOG_INF( "Block-wise uplink of %u bytes acknowledged", block1_payload_len );
+        #if defined( CONFIG_NCE_UPLINK_QUEUE )
+        ( void ) nce_uplink_queue_pop();
+        #else
+        uplink_batch_reset();
+        #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+        prv_uplink_acked();
+    }
+    else
+    {
+        #if defined( CONFIG_NCE_UPLINK_QUEUE )
+        LOG_WRN( "Block-wise uplink failed: %d, left in the queue", result );
+        #else
+        /* Samples are batched behind it again and it is sent with them */
+        LOG_WRN( "Block-wise uplink failed: %d, retried with the next batch", result );
+        #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+    }
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    /* The drain shares the compression buffer and waits for the transfer */
+    prv_uplink_drain();
+    #else
+    block1_holds_batch = false;
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    /* A batch that became due during the transfer */
+    err = prv_flush_due_batch();
+
+    if( err )
+    {
+        LOG_WRN( "Batch not sent after block-wise uplink: %d", err );
+    }
+}
+
+/** @brief Check whether a block-wise transfer holds the compression buffer. */
+static bool prv_block1_busy( void )
+{
+    return block1_uplink_busy();
+}
+
+/** @brief Check whether a block-wise transfer reads from the batch buffer. */
+static bool prv_block1_holds_batch( void )
+{
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    return false;
+    #else
+    return block1_holds_batch;
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+}
+
+/**
+ * @brief Send a payload that does not fit one block as a Block1 transfer.
+ *
+ * @p req holds the payload as sent, @p payload the uncompressed batch. With
+ * CONFIG_NCE_UPLINK_QUEUE the batch is queued first and the transfer reads it
+ * back from flash, so the batch buffer is free for new samples and a failed
+ * transfer stays queued. Without it the transfer reads the batch buffer,
+ * which is kept until the transfer completes.
+ */
+static int prv_send_block1( const struct coap_client_request * req,
+                            const uint8_t * payload,
+                            size_t len,
+                            int64_t time_ms )
+{
+    const struct block1_uplink_request block1_req =
+    {
+        .path      = req->path,
+        .fmt       = req->fmt,
+        .total_len = req->len,
+        .producer  = prv_block1_produce,
+        .done      = prv_block1_done,
+    };
+    int err;
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    /* Direct uplinks are only sent on an empty queue, so this is the oldest entry */
+    err = nce_uplink_queue_push( payload, len, time_ms );
+
+    if( err )
+    {
+        return err;
+    }
+
+    block1_payload = ( req->payload == payload ) ? NULL : req->payload;
+    #else
+    ARG_UNUSED( payload );
+    ARG_UNUSED( len );
+    ARG_UNUSED( time_ms );
+    block1_payload = req->payload;
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+    block1_payload_len = req->len;
+
+    err = block1_uplink_send( &coap_client, uplink_fd, &block1_req );
+
+    if( err )
+    {
+        #if defined( CONFIG_NCE_UPLINK_QUEUE )
+        /* Already queued, sent from there once the uplink is back */
+        LOG_ERR( "Failed to start block-wise uplink: %d, queued", err );
+
+        if( prv_uplink_link_error( err ) )
+        {
+            prv_uplink_reconnect();
+        }
+
+        return 0;
+        #else
+        LOG_ERR( "Failed to start block-wise uplink: %d", err );
+        return err;
+        #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+    }
+
+    #if !defined( CONFIG_NCE_UPLINK_QUEUE )
+    block1_holds_batch = true;
+    #endif /* if !defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    LOG_INF( "Block-wise uplink of %u bytes in blocks of %u bytes", req->len, block1_uplink_block_size() );
+
+    return 0;
+}
+#else /* if defined( CONFIG_NCE_UPLINK_BLOCK1 ) */
+static bool prv_block1_busy( void )
+{
+    return false;
+}
+
+    #if defined( CONFIG_NCE_UPLINK_BATCHING )
+static bool prv_block1_holds_batch( void )
+{
+    return false;
+}
+    #endif /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+#endif /* if defined( CONFIG_NCE_UPLINK_BLOCK1 ) */
+
+/** @brief Send one payload as a CoAP POST on the uplink socket. */
+static int prv_send_payload( struct coap_client_request * req,
+                             const uint8_t * payload,
+                             size_t len,
+                             bool urgent,
+                             int64_t time_ms )
+{
+    int err;
+    struct uplink_req_ctx * ctx = NULL;
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    struct uplink_copy * copy = NULL;
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    /* The running transfer may still read from the compression buffer */
+    if( prv_block1_busy() )
+    {
+        return -EBUSY;
+    }
+
+    prv_set_payload( req, payload, len );
+
+    #if defined( CONFIG_NCE_UPLINK_BLOCK1 )
+    if( req->len > block1_uplink_block_size() )
+    {
+        /* Always CON, not counted by the adaptive CON/NON policy */
+        return prv_send_block1( req, payload, len, time_ms );
+    }
+    #endif /* if defined( CONFIG_NCE_UPLINK_BLOCK1 ) */
+
+    #if defined( CONFIG_NCE_UPLINK_ADAPTIVE_CONFIRM )
+    req->confirmable = uplink_confirm_next( urgent );
+    #else
+    ARG_UNUSED( urgent );
+    #endif /* if defined( CONFIG_NCE_UPLINK_ADAPTIVE_CONFIRM ) */
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    /* Kept to queue the uplink again if it is lost in flight, NON uplinks may go unanswered */
+    if( req->confirmable && ( len <= sizeof( copy->payload ) ) )
+    {
+        for( int i = 0; i < ARRAY_SIZE( uplink_copies ); i++ )
+        {
+            if( atomic_cas( &uplink_copies[ i ].used, 0, 1 ) )
+            {
+                copy = &uplink_copies[ i ];
+                break;
+            }
+        }
+
+        if( !copy )
+        {
+            /* The caller stores the uplink in the queue, which sends it from flash */
+            return -EAGAIN;
+        }
+
+        copy->time_ms = time_ms;
+        copy->len = len;
+        memcpy( copy->payload, payload, len );
+    }
+    #else
+    ARG_UNUSED( time_ms );
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    for( int i = 0; i < ARRAY_SIZE( uplink_req_ctxs ); i++ )
+    {
+        if( atomic_cas( &uplink_req_ctxs[ i ].used, 0, 1 ) )
+        {
+            ctx = &uplink_req_ctxs[ i ];
+            break;
+        }
+    }
+
+    if( !ctx )
+    {
+        #if defined( CONFIG_NCE_UPLINK_QUEUE )
+        if( copy )
+        {
+            atomic_clear( &copy->used );
+        }
+        #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+        /* Every client request slot is taken, not an error of the link */
+        LOG_WRN( "No free uplink request slot" );
+        return -EAGAIN;
+    }
+
+    /* The context has to be complete before the client copies the request */
+    ctx->confirmable = req->confirmable;
+    prv_uplink_params( &ctx->params );
+    ctx->sent_ms = k_uptime_get_32();
+    #if defined( CONFIG_NCE_ENERGY_ACCT )
+    ctx->acct_id = nce_energy_acct_tx( len, req->len + UPLINK_COAP_OVERHEAD + UPLINK_DATAGRAM_OVERHEAD );
+    #endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    ctx->copy = copy;
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+    req->user_data = ctx;
+
+    err = coap_client_req( &coap_client, uplink_fd, NULL, req, &ctx->params );
+
+    if( err )
+    {
+        #if defined( CONFIG_NCE_ENERGY_ACCT )
+        nce_energy_acct_cancel( ctx->acct_id );
+        #endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+        prv_uplink_ctx_free( ctx );
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_ERR( "Failed to send request : %d", err );
+        return err;
+    }
+
+    #if defined( CONFIG_NCE_COAP_STATS )
+    nce_coap_stats_request();
+    #endif /* if defined( CONFIG_NCE_COAP_STATS ) */
+    nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_TX_BYTES, req->len );
+    #if defined( CONFIG_NCE_BENCH )
+    bench_uplink_sent();
+    #endif /* if defined( CONFIG_NCE_BENCH ) */
+    NCE_NET_LOG_INF( "CoAP POST request (%s) sent to %s, resource: %s", req->confirmable ? "CON" : "NON",
+                     CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, req->path );
+
+    #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
+    if( ledBlue.port )
+    {
+        gpio_pin_set_dt( &ledBlue, 0 );
+    }
+
+    if( ledGreen.port )
+    {
+        gpio_pin_set_dt( &ledGreen, 100 ); /* turn on green LED even if not acknowledged (NON CON) */
+    }
+    #endif
+
+    return 0;
+}
+
+/** @brief Last sample sent, a changed sample is sent as urgent. */
+static char last_sample[ SAMPLE_BUFFER_SIZE ];
+static int last_sample_len = -1;
+static int64_t last_sample_ms;
+static bool uplink_urgent;
+static struct coap_client_request uplink_req =
+{
+    .method      = COAP_METHOD_POST,
+    .confirmable = true,
+    .fmt         = UPLINK_CONTENT_FORMAT,
+    .cb          = response_cb,
+    .path        = CONFIG_URI_PATH,
+};
+
+/** @brief Resolve the server, open the uplink socket and connect it. */
+static int prv_uplink_connect( void )
+{
+    int err;
+    struct sockaddr_in server_addr =
+    {
+        .sin_family = AF_INET,
+        .sin_port   = htons( CONFIG_COAP_SAMPLE_SERVER_PORT ),
+    };
+
+    /* DNS Resolution */
+    #if defined( CONFIG_NCE_DNS_CACHE )
+    err = nce_dns_cache_resolve( CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, &server_addr.sin_addr );
+
+    if( err )
+    {
+        LOG_ERR( "Failed to resolve hostname '%s', err: %d", CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, err );
+        return err;
+    }
+    #else /* if defined( CONFIG_NCE_DNS_CACHE ) */
+    {
+        struct addrinfo * resolved_info = NULL;
+        struct addrinfo dns_hints =
+        {
+            .ai_family   = AF_INET,
+            .ai_socktype = SOCK_DGRAM,
         };
-        Element2byte_gen_t signal_strength =
+        err = zsock_getaddrinfo( CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, NULL, &dns_hints, &resolved_info );
+
+        if( ( err < 0 ) || !resolved_info || !resolved_info->ai_addr )
+        {
+            LOG_ERR( "Failed to resolve hostname '%s', errno: %d", CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, errno );
+            return -errno;
+        }
+
+        server_addr.sin_addr = ( ( struct sockaddr_in * ) resolved_info->ai_addr )->sin_addr;
+        zsock_freeaddrinfo( resolved_info );
+    }
+    #endif /* if defined( CONFIG_NCE_DNS_CACHE ) */
+    LOG_INF( "DNS Resolution successful" );
+    #if defined( CONFIG_NCE_BOOT_PROFILE )
+    nce_boot_profile_mark( NCE_BOOT_PHASE_DNS );
+    #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
+    #if defined( CONFIG_NCE_COAP_RTO )
+    /* The round trips measured so far belong to the old server */
+    if( server_addr.sin_addr.s_addr != uplink_rto_addr.s_addr )
+    {
+        uplink_rto_addr = server_addr.sin_addr;
+        nce_coap_rto_reset( &uplink_rto );
+    }
+    #endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+
+    #if defined( CONFIG_NCE_ENABLE_DTLS ) || defined( CONFIG_NCE_BENCH_DTLS )
+    uplink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_DTLS_1_2 );
+    #else
+    uplink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
+    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+
+    if( uplink_fd < 0 )
+    {
+        LOG_ERR( "Failed to create CoAP Uplink socket: %d.", -errno );
+        return -errno;
+    }
+
+    #if defined( CONFIG_NCE_ENABLE_DTLS )
+    err = dtls_setup( uplink_fd );
+
+    if( err )
+    {
+        LOG_ERR( "DTLS setup failed, err %d\n", err );
+        return err;
+    }
+    #elif defined( CONFIG_NCE_BENCH_DTLS )
+    err = bench_dtls_setup( uplink_fd );
+
+    if( err )
+    {
+        LOG_ERR( "Benchmark DTLS setup failed, err %d", err );
+        return err;
+    }
+    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+    #if defined( CONFIG_NCE_COAP_STATS ) && defined( CONFIG_NCE_ENABLE_DTLS )
+    uint32_t handshake_start_ms = k_uptime_get_32();
+    #endif /* if defined( CONFIG_NCE_COAP_STATS ) && defined( CONFIG_NCE_ENABLE_DTLS ) */
+    err = zsock_connect( uplink_fd, ( struct sockaddr * ) &server_addr, sizeof( server_addr ) );
+    #if defined( CONFIG_NCE_COAP_STATS ) && defined( CONFIG_NCE_ENABLE_DTLS )
+    /* The handshake runs in connect() */
+    nce_coap_stats_handshake( k_uptime_get_32() - handshake_start_ms, err == 0 );
+    #endif /* if defined( CONFIG_NCE_COAP_STATS ) && defined( CONFIG_NCE_ENABLE_DTLS ) */
+
+    if( err )
+    {
+        #if defined( CONFIG_NCE_DNS_CACHE )
+        /* The cached address may be outdated, query DNS on the next attempt */
+        nce_dns_cache_invalidate( CONFIG_COAP_SAMPLE_SERVER_HOSTNAME );
+        #endif /* if defined( CONFIG_NCE_DNS_CACHE ) */
+        #if defined( CONFIG_NCE_ENABLE_DTLS )
+        connection_failure_count++;
+        LOG_ERR( "Failed to Connect to Uplink CoAPs Server. (Attempt:%d)\n", connection_failure_count );
+        #else
+        LOG_ERR( "Failed to Connect Uplink to CoAP Server" );
+        #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+
+        return -errno;
+    }
+
+    LOG_INF( "Connected to Uplink CoAP server %s:%d", CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, CONFIG_COAP_SAMPLE_SERVER_PORT );
+    #if defined( CONFIG_NCE_BOOT_PROFILE ) && defined( CONFIG_NCE_ENABLE_DTLS )
+    /* The handshake runs in connect() */
+    nce_boot_profile_mark( NCE_BOOT_PHASE_DTLS );
+    #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) && defined( CONFIG_NCE_ENABLE_DTLS ) */
+    #if defined( CONFIG_NCE_DTLS_CID )
+    dtls_log_cid_status( uplink_fd );
+    #endif /* if defined( CONFIG_NCE_DTLS_CID ) */
+
+    return 0;
+}
+
+/** @brief Close the uplink socket and renew the credentials after repeated DTLS failures. */
+static void prv_uplink_close( void )
+{
+    if( uplink_fd >= 0 )
+    {
+        #if defined( CONFIG_NCE_DOWNLINK_OBSERVE )
+        /* Frees the slot of the Observe registration, it is renewed on the next socket */
+        coap_client_cancel_requests( &coap_client );
+        #endif /* if defined( CONFIG_NCE_DOWNLINK_OBSERVE ) */
+        zsock_close( uplink_fd );
+        uplink_fd = -1;
+    }
+
+    #if defined( CONFIG_NCE_ENABLE_DTLS )
+    if( connection_failure_count >= CONFIG_NCE_MAX_DTLS_CONNECTION_ATTEMPTS )
+    {
+        connection_failure_count = 0;
+
+        /* The I/O thread keeps running, reconnects fail until the modem reattaches */
+        if( k_work_busy_get( &onboard_work ) == 0 )
+        {
+            LOG_WRN( "Max DTLS retries reached. Updating credentials..." );
+            ( void ) k_work_submit( &onboard_work );
+        }
+    }
+    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+}
+
+/**
+ * @brief Tell a broken socket or DTLS session from a transient send failure.
+ *
+ * @return true if the uplink has to be reconnected.
+ */
+static bool prv_uplink_link_error( int err )
+{
+    switch( err )
+    {
+        case -ENOTCONN:
+        case -ECONNRESET:
+        case -ECONNREFUSED:
+        case -ECONNABORTED:
+        case -EPIPE:
+        case -EBADF:
+        case -ENOTSOCK:
+        case -ENETDOWN:
+        case -ENETUNREACH:
+        case -EHOSTUNREACH:
+        case -ETIMEDOUT:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/** @brief Close the uplink socket and schedule a reconnect with the retry policy. */
+static void prv_uplink_reconnect( void )
+{
+    k_timeout_t delay;
+
+    prv_uplink_close();
+
+    if( !nce_net_io_timer_is_pending( &uplink_connect_timer ) &&
+        ( nce_retry_failed( &uplink_retry, &delay ) == 0 ) )
+    {
+        nce_net_io_timer_start( &uplink_connect_timer, delay );
+    }
+}
+
+#if defined( CONFIG_NCE_UPLINK_QUEUE )
+#define DRAIN_DEPTH    CONFIG_NCE_UPLINK_PIPELINE_DEPTH
+
+BUILD_ASSERT( DRAIN_DEPTH <= CONFIG_COAP_CLIENT_MAX_REQUESTS,
+              "CONFIG_NCE_UPLINK_PIPELINE_DEPTH exceeds CONFIG_COAP_CLIENT_MAX_REQUESTS" );
+
+/** @brief State of a pipeline slot, written by the CoAP client thread when a request completes. */
+enum drain_state
+{
+    DRAIN_FREE,
+    DRAIN_SENT,
+    DRAIN_ACKED,
+    DRAIN_LOST,
+};
+
+/** @brief Queued uplinks in flight, owned by the network I/O thread.
+ *
+ * Slot (drain_head + i) % DRAIN_DEPTH carries queue entry i for i < drain_used.
+ * Entries are removed in queue order once acknowledged. The number in flight
+ * is limited by a congestion window that grows by one after a window's worth
+ * of acknowledgements and halves on a loss.
+ */
+static uint8_t drain_buffer[ CONFIG_NCE_UPLINK_QUEUE_MAX_ENTRY_SIZE ];
+static atomic_t drain_slots[ DRAIN_DEPTH ];
+static uint32_t drain_sent_ms[ DRAIN_DEPTH ];
+static struct coap_transmission_parameters drain_params[ DRAIN_DEPTH ];
+static uint32_t drain_head;
+static uint32_t drain_used;
+static uint32_t drain_window = 1;
+static uint32_t drain_acks;
+static uint32_t drain_dropped;
+
+/**
+ * @brief Remove the acknowledged entries at the head of the queue and adapt the window.
+ *
+ * @return true if a request was lost, the entries from the first unacknowledged one are sent again later.
+ */
+static bool prv_drain_settle( void )
+{
+    struct nce_uplink_queue_stats stats;
+    bool lost = false;
+    uint32_t slot;
+
+    nce_uplink_queue_stats_get( &stats );
+
+    if( stats.dropped != drain_dropped )
+    {
+        /* The oldest entries were erased, the slots no longer match the queue */
+        drain_dropped = stats.dropped;
+        drain_used = 0;
+    }
+
+    while( ( drain_used > 0 ) && ( atomic_get( &drain_slots[ drain_head ] ) == DRAIN_ACKED ) )
+    {
+        nce_uplink_queue_pop();
+        atomic_set( &drain_slots[ drain_head ], DRAIN_FREE );
+        drain_head = ( drain_head + 1 ) % DRAIN_DEPTH;
+        drain_used--;
+
+        if( ++drain_acks >= drain_window )
+        {
+            drain_acks = 0;
+            drain_window = MIN( drain_window + 1, DRAIN_DEPTH );
+        }
+    }
+
+    for( uint32_t i = 0; i < drain_used; i++ )
+    {
+        if( atomic_get( &drain_slots[ ( drain_head + i ) % DRAIN_DEPTH ] ) == DRAIN_LOST )
+        {
+            lost = true;
+        }
+    }
+
+    if( lost )
+    {
+        /* Acknowledged entries behind the lost one are sent again, delivery stays at least once */
+        drain_window = MAX( drain_window / 2, 1U );
+        drain_acks = 0;
+        drain_used = 0;
+    }
+
+    /* Requests that no longer match the queue free their slot when they complete */
+    for( uint32_t i = drain_used; i < DRAIN_DEPTH; i++ )
+    {
+        slot = ( drain_head + i ) % DRAIN_DEPTH;
+
+        if( atomic_get( &drain_slots[ slot ] ) > DRAIN_SENT )
+        {
+            atomic_set( &drain_slots[ slot ], DRAIN_FREE );
+        }
+    }
+
+    return lost;
+}
+
+/** @brief A queued uplink completed: remove what was acknowledged and fill the window. */
+static void prv_drain_done( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    /* After a loss the queue is retried with the next sample or reconnect */
+    if( !prv_drain_settle() )
+    {
+        prv_uplink_drain();
+    }
+}
+
+static void prv_drain_response_cb( int16_t code,
+                                   size_t offset,
+                                   const uint8_t * payload,
+                                   size_t len,
+                                   bool last_block,
+                                   void * user_data )
+{
+    uint32_t index = POINTER_TO_UINT( user_data );
+    atomic_t * slot = &drain_slots[ index ];
+
+    if( last_block || ( code < 0 ) )
+    {
+        prv_uplink_completed( &drain_params[ index ], drain_sent_ms[ index ], code );
+    }
+
+    if( code < 0 )
+    {
+        /* Kept in the queue */
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_WRN( "Queued uplink not acknowledged: %d", code );
+        atomic_set( slot, DRAIN_LOST );
+    }
+    else if( last_block )
+    {
+        prv_uplink_acked();
+        atomic_set( slot, DRAIN_ACKED );
+    }
+    else
+    {
+        return;
+    }
+
+    /* If the I/O thread is busy the result is picked up by the next drain */
+    ( void ) nce_net_io_submit( prv_drain_done, NULL );
+}
+
+static struct coap_client_request drain_req =
+{
+    .method      = COAP_METHOD_POST,
+    .confirmable = true,
+    .fmt         = UPLINK_CONTENT_FORMAT,
+    .cb          = prv_drain_response_cb,
+    .path        = CONFIG_URI_PATH,
+};
+
+/** @brief Send the oldest queued uplinks as CON, up to the window, each is removed once acknowledged. */
+static void prv_uplink_drain( void )
+{
+    int64_t time_ms;
+    uint32_t slot;
+    size_t len;
+    int err;
+
+    ( void ) prv_drain_settle();
+
+    if( ( uplink_fd < 0 ) || !is_connected )
+    {
+        return;
+    }
+
+    if( prv_block1_busy() )
+    {
+        return;
+    }
+
+    while( drain_used < drain_window )
+    {
+        slot = ( drain_head + drain_used ) % DRAIN_DEPTH;
+
+        /* Still held by a request sent before a loss */
+        if( atomic_get( &drain_slots[ slot ] ) != DRAIN_FREE )
+        {
+            return;
+        }
+
+        if( nce_uplink_queue_peek_at( drain_used, drain_buffer, sizeof( drain_buffer ), &len, &time_ms ) )
+        {
+            return;
+        }
+
+        /* Stamped with the age it has now, not the one it had when queued */
+        prv_uplink_stamp( drain_buffer, len, time_ms );
+
+        /* The client copies the request and builds the message, both buffers can be reused */
+        prv_set_payload( &drain_req, drain_buffer, len );
+        drain_req.user_data = UINT_TO_POINTER( slot );
+        atomic_set( &drain_slots[ slot ], DRAIN_SENT );
+        prv_uplink_params( &drain_params[ slot ] );
+        drain_sent_ms[ slot ] = k_uptime_get_32();
+
+        err = coap_client_req( &coap_client, uplink_fd, NULL, &drain_req, &drain_params[ slot ] );
+
+        if( err )
+        {
+            atomic_set( &drain_slots[ slot ], DRAIN_FREE );
+
+            /* -EAGAIN: every client request slot is taken, continue when one completes */
+            if( err != -EAGAIN )
+            {
+                nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+                LOG_WRN( "Failed to send queued uplink: %d", err );
+            }
+
+            return;
+        }
+
+        drain_used++;
+        #if defined( CONFIG_NCE_COAP_STATS )
+        nce_coap_stats_request();
+        #endif /* if defined( CONFIG_NCE_COAP_STATS ) */
+        nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+        nce_net_stats_add( NCE_NET_STAT_TX_BYTES, drain_req.len );
+
+        NCE_NET_LOG_INF( "Queued uplink sent (%u bytes, %u in flight, %u pending)", len, drain_used,
+                         nce_uplink_queue_count() );
+    }
+}
+#endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+/**
+ * @brief Send a payload on the uplink socket. With CONFIG_NCE_UPLINK_QUEUE the
+ *        payload is stored in flash instead while the uplink is down, when
+ *        sending fails, or while older payloads are still queued.
+ *
+ * @p time_ms is the k_uptime_get() of the payload's first sample, the payload
+ * is stamped with it before it is sent and again when it is sent from the queue.
+ */
+static int prv_uplink_submit( struct coap_client_request * req,
+                              uint8_t * payload,
+                              size_t len,
+                              bool urgent,
+                              int64_t time_ms )
+{
+    int err = -ENOTCONN;
+
+    prv_uplink_stamp( payload, len, time_ms );
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    if( ( uplink_fd >= 0 ) && is_connected && ( nce_uplink_queue_count() == 0 ) )
+    #else
+    if( uplink_fd >= 0 )
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+    {
+        err = prv_send_payload( req, payload, len, urgent, time_ms );
+
+        if( prv_uplink_link_error( err ) )
         {
-            .type            = E_INTEGER,
-            .value.i         = 84,
-            .template_length = 1
-        };
-        Element2byte_gen_t software_version =
+            prv_uplink_reconnect();
+        }
+        else if( err )
         {
-            .type            = E_STRING,
-            .value.s         = "2.2.1",
-            .template_length = 5
-        };
+            /* Busy, e.g. -EAGAIN while every request slot is taken: the session is kept */
+            NCE_NET_LOG_INF( "Uplink busy: %d", err );
+        }
+    }
 
-        converted_bytes = os_energy_save( buffer, 1, 3,
-                                          battery_level,
-                                          signal_strength,
-                                          software_version );
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    if( err )
+    {
+        err = nce_uplink_queue_push( payload, len, time_ms );
 
-        if( converted_bytes < 0 )
+        if( err == 0 )
         {
-            LOG_ERR( "Failed to save energy, %d", errno );
-            goto close_and_retry;
+            LOG_INF( "Uplink stored, %u pending", nce_uplink_queue_count() );
+            prv_uplink_drain();
         }
+    }
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+
+    return err;
+}
+
+#if defined( CONFIG_NCE_UPLINK_BATCHING )
+/** @brief Send all batched samples as a single CoAP POST. */
+static int prv_flush_batch( struct coap_client_request * req,
+                            bool urgent )
+{
+    int err;
+    uint8_t * payload;
+    size_t len;
+    size_t samples = uplink_batch_count();
+
+    err = uplink_batch_finalize( &payload, &len );
+
+    if( err )
+    {
+        return 0; /* Nothing buffered */
+    }
+
+    err = prv_uplink_submit( req, payload, len, urgent, uplink_batch_time_ms() );
+
+    if( err )
+    {
+        /* Keep the batch, it is retried after reconnecting */
+        return err;
+    }
+
+    if( prv_block1_holds_batch() )
+    {
+        /* Reset by prv_block1_done() once the transfer is acknowledged */
+        return 0;
+    }
+
+    LOG_INF( "Flushed batch of %u samples (%u bytes)", samples, len );
+    uplink_batch_reset();
+
+    return 0;
+}
+
+/** @brief Append a sample to the batch, SenML samples are re-encoded for their place in it. */
+static int prv_batch_add( char * sample,
+                          size_t size,
+                          int len )
+{
+    #if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    len = prv_build_senml( sample, size, uplink_batch_count() == 0, uplink_batch_age_seconds() );
+
+    if( len < 0 )
+    {
+        return len;
+    }
+    #else
+    ARG_UNUSED( size );
+    #endif /* if defined( CONFIG_NCE_PAYLOAD_SENML_CBOR ) */
+
+    return uplink_batch_add( ( const uint8_t * ) sample, len );
+}
+#endif /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+
+#if defined( CONFIG_NCE_RADIO_SCHED )
+/** @brief Unchanged samples held back while the modem sleeps, sent by uplink_defer_timer. */
+static struct nce_net_io_timer uplink_defer_timer;
+static struct nce_radio_sched_listener uplink_radio_listener;
+static bool uplink_deferred;
+
+/** @brief Defer timer: the modem woke up, a window opened or the deferral limit passed. */
+static void prv_uplink_defer_timer_fn( struct nce_net_io_timer * timer )
+{
+    int err;
+
+    ARG_UNUSED( timer );
+
+    if( !uplink_deferred )
+    {
+        return;
+    }
+
+    uplink_deferred = false;
+
+    /* The batch stays due and is flushed when the transfer completes */
+    if( prv_block1_busy() )
+    {
+        return;
+    }
+
+    #if defined( CONFIG_NCE_UPLINK_BATCHING )
+    err = prv_flush_batch( &uplink_req, uplink_urgent );
+
+    if( err == 0 )
+    {
+        uplink_urgent = false;
+    }
+    #else
+    uint8_t payload[ SAMPLE_BUFFER_SIZE ];
+
+    /* Only unchanged samples are deferred, the last one stands for all of them. It is
+     * stamped on a copy so that the next sample is still compared against the original */
+    memcpy( payload, last_sample, last_sample_len );
+    err = prv_uplink_submit( &uplink_req, payload, last_sample_len, false, last_sample_ms );
+    #endif /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+
+    if( err )
+    {
+        LOG_WRN( "Deferred uplink not sent: %d", err );
+    }
+}
+
+static void prv_uplink_radio_window( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    if( uplink_deferred )
+    {
+        nce_net_io_timer_start( &uplink_defer_timer, K_NO_WAIT );
+    }
+}
+
+/** @brief A radio window opened early, runs in the link controller's context. */
+static void prv_uplink_radio_listener_cb( struct nce_radio_sched_listener * listener )
+{
+    ARG_UNUSED( listener );
+
+    ( void ) nce_net_io_submit( prv_uplink_radio_window, NULL );
+}
+#endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+
+/**
+ * @brief Hold a non-urgent uplink back while the modem sleeps.
+ *
+ * @return true if the uplink is deferred and must not be sent now.
+ */
+static bool prv_uplink_defer( bool urgent )
+{
+    #if defined( CONFIG_NCE_RADIO_SCHED )
+    k_timeout_t delay;
+
+    if( urgent )
+    {
+        /* Sent now with the latest data, nothing is left to defer */
+        uplink_deferred = false;
+        nce_net_io_timer_stop( &uplink_defer_timer );
+        return false;
+    }
+
+    if( uplink_deferred )
+    {
+        return true;
+    }
+
+    delay = nce_radio_sched_delay( CONFIG_NCE_UPLINK_MAX_DEFER_SECONDS * MSEC_PER_SEC );
+
+    if( K_TIMEOUT_EQ( delay, K_NO_WAIT ) )
+    {
+        return false;
+    }
+
+    uplink_deferred = true;
+    nce_net_io_timer_start( &uplink_defer_timer, delay );
+    NCE_NET_LOG_INF( "Modem asleep, uplink deferred" );
+
+    return true;
+    #else
+    ARG_UNUSED( urgent );
+
+    return false;
+    #endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+}
+
+#if defined( CONFIG_NCE_UPLINK_BATCHING )
+/** @brief Send the batch if it is due, unless a block-wise uplink runs or the modem sleeps. */
+static int prv_flush_due_batch( void )
+{
+    int err;
+
+    if( !uplink_batch_is_due() || prv_block1_busy() || prv_uplink_defer( uplink_urgent ) )
+    {
+        return 0;
+    }
+
+    err = prv_flush_batch( &uplink_req, uplink_urgent );
+
+    if( err == 0 )
+    {
+        uplink_urgent = false;
+    }
+
+    return err;
+}
+#endif /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+
+/** @brief Build one sample and send it, directly or through the batch. */
+static int prv_uplink_send_sample( void )
+{
+    int err;
+    char sample[ SAMPLE_BUFFER_SIZE ];
+    int sample_len;
+
+    sample_len = prv_build_sample( sample, sizeof( sample ) );
+
+    if( sample_len < 0 )
+    {
+        return sample_len;
+    }
+
+    last_sample_ms = k_uptime_get();
+
+    /* A changed sample is worth a confirmed uplink */
+    if( ( sample_len != last_sample_len ) || ( memcmp( sample, last_sample, sample_len ) != 0 ) )
+    {
+        memcpy( last_sample, sample, sample_len );
+        last_sample_len = sample_len;
+        uplink_urgent = true;
+    }
+
+    #if defined( CONFIG_NCE_UPLINK_BATCHING )
+    /* The running transfer reads from the batch buffer, the sample is skipped */
+    if( prv_block1_holds_batch() )
+    {
+        return -EBUSY;
+    }
 
-        req.payload = buffer;
-        req.len = converted_bytes;
-        LOG_HEXDUMP_INF( buffer, sizeof( buffer ), "Payload (binary):" );
-        #else /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
-        req.payload = CONFIG_PAYLOAD;
-        req.len = strlen( CONFIG_PAYLOAD );
-        LOG_INF( "Payload: %s", CONFIG_PAYLOAD );
-        #endif /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
-        /* Send request */
-        err = coap_client_req( &coap_client, uplink_fd, NULL, &req, NULL );
+    err = prv_batch_add( sample, sizeof( sample ), sample_len );
+
+    if( err == -ENOSPC )
+    {
+        /* Size trigger: send what is buffered and start a new batch with this sample */
+        err = prv_flush_batch( &uplink_req, uplink_urgent );
 
         if( err )
         {
-            LOG_ERR( "Failed to send request : %d", err );
-            goto close_and_retry;
+            return err;
+        }
+
+        if( prv_block1_holds_batch() )
+        {
+            return -EBUSY;
         }
 
-        LOG_INF( "CoAP POST request sent to %s, resource: %s",
-                 CONFIG_COAP_SAMPLE_SERVER_HOSTNAME, req.path );
+        err = prv_batch_add( sample, sizeof( sample ), sample_len );
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Failed to batch sample of %d bytes: %d", sample_len, err );
+    }
+    else
+    {
+        err = prv_flush_due_batch();
 
-        #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
-        if( ledBlue.port )
+        if( err )
         {
-            gpio_pin_set_dt( &ledBlue, 0 );
+            return err;
         }
 
-        if( ledGreen.port )
+        if( uplink_batch_count() > 0 )
         {
-            gpio_pin_set_dt( &ledGreen, 100 ); /* turn on green LED even if not acknowledged (NON CON) */
+            NCE_NET_LOG_INF( "Sample batched (%u/%d)", uplink_batch_count(), CONFIG_NCE_UPLINK_BATCH_MAX_SAMPLES );
         }
-        #endif
-        k_sleep( K_SECONDS( CONFIG_COAP_SAMPLE_REQUEST_INTERVAL_SECONDS ) );
+    }
+    #else /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+    if( prv_uplink_defer( uplink_urgent ) )
+    {
+        return 0;
     }
 
-close_and_retry:
+    err = prv_uplink_submit( &uplink_req, ( uint8_t * ) sample, sample_len, uplink_urgent, last_sample_ms );
+
+    if( err )
+    {
+        return err;
+    }
+
+    uplink_urgent = false;
+    #endif /* if defined( CONFIG_NCE_UPLINK_BATCHING ) */
+
+    return 0;
+}
+
+/** @brief Uplink timer: build and send one sample per interval, connected or not. */
+static void prv_uplink_timer_fn( struct nce_net_io_timer * timer )
+{
+    uint32_t start;
+    int err;
+
+    nce_net_io_timer_start( timer, UPLINK_INTERVAL );
+
+    /* CPU time of building, encoding and handing one sample to the network */
+    start = nce_net_stats_time_begin();
+    err = prv_uplink_send_sample();
+    nce_net_stats_time_end( start );
+
+    if( err )
+    {
+        LOG_WRN( "Sample not sent: %d", err );
+    }
+}
+
+/** @brief Connect timer: open the uplink socket, retried with backoff by uplink_retry. */
+static void prv_uplink_connect_timer_fn( struct nce_net_io_timer * timer )
+{
+    k_timeout_t delay;
+    int err;
+
+    if( uplink_fd >= 0 )
+    {
+        return;
+    }
+
+    err = prv_uplink_connect();
+
+    /* Sampling starts after the first connection attempt and never stops */
+    if( !nce_net_io_timer_is_pending( &uplink_timer ) )
+    {
+        nce_net_io_timer_start( &uplink_timer, K_NO_WAIT );
+    }
+
+    if( err == 0 )
+    {
+        nce_retry_succeeded( &uplink_retry );
+        #if defined( CONFIG_NCE_DOWNLINK_OBSERVE )
+        prv_observe_register();
+        #endif /* if defined( CONFIG_NCE_DOWNLINK_OBSERVE ) */
+        #if defined( CONFIG_NCE_UPLINK_QUEUE )
+        prv_uplink_drain();
+        #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+        return;
+    }
+
+    prv_uplink_close();
+    err = nce_retry_failed( &uplink_retry, &delay );
+
+    if( err == -ENETDOWN )
+    {
+        LOG_WRN( "Uplink paused until the network is back" );
+        return;
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Max uplink retries reached. Waiting for the network to reconnect." );
+        return;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_RETRIES );
+    LOG_WRN( "Retrying uplink (attempt %u)...", nce_retry_attempts( &uplink_retry ) );
+    nce_net_io_timer_start( timer, delay );
+}
 
-    if( uplink_fd > 0 )
+/** @brief Network is back: retry connecting and send what was queued while offline. */
+static void prv_uplink_network_up( void * user_data )
+{
+    k_timeout_t delay;
+
+    ARG_UNUSED( user_data );
+
+    /* Spread the reconnects of devices coming back from the same outage */
+    delay = nce_retry_resume( &uplink_retry );
+
+    if( ( uplink_fd < 0 ) && !nce_net_io_timer_is_pending( &uplink_connect_timer ) )
+    {
+        nce_net_io_timer_start( &uplink_connect_timer, delay );
+    }
+
+    #if defined( CONFIG_NCE_UPLINK_QUEUE )
+    else
+    {
+        prv_uplink_drain();
+    }
+    #endif /* if defined( CONFIG_NCE_UPLINK_QUEUE ) */
+}
+
+/** @brief Uplink retries were paused or given up and the network is back. */
+static void prv_uplink_retry_resume( struct nce_retry * retry )
+{
+    ARG_UNUSED( retry );
+
+    ( void ) nce_net_io_submit( prv_uplink_network_up, NULL );
+}
+
+
+#if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
+/** @brief Schedule the next downlink setup attempt with the retry policy. */
+static void prv_downlink_retry( void )
+{
+    k_timeout_t delay;
+    int err;
+
+    err = nce_retry_failed( &downlink_retry, &delay );
+
+    if( err == -ENETDOWN )
+    {
+        LOG_WRN( "Downlink paused until the network is back" );
+        return;
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Max downlink retries reached. Waiting for the network to reconnect." );
+        return;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_RETRIES );
+    LOG_WRN( "Retrying downlink setup (attempt %u)...", nce_retry_attempts( &downlink_retry ) );
+    nce_net_io_timer_start( &downlink_timer, delay );
+}
+
+/** @brief Network is back after the downlink retries paused or gave up. */
+static void prv_downlink_network_up( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    if( nce_net_io_timer_is_pending( &downlink_timer ) )
+    {
+        return;
+    }
+
+    #if defined( CONFIG_NCE_DOWNLINK_OBSERVE )
+    /* The registration follows the uplink connection otherwise */
+    if( uplink_fd < 0 )
+    {
+        return;
+    }
+    #else
+    if( downlink_fd >= 0 )
+    {
+        return;
+    }
+    #endif /* if defined( CONFIG_NCE_DOWNLINK_OBSERVE ) */
+
+    nce_net_io_timer_start( &downlink_timer, nce_retry_resume( &downlink_retry ) );
+}
+
+static void prv_downlink_retry_resume( struct nce_retry * retry )
+{
+    ARG_UNUSED( retry );
+
+    ( void ) nce_net_io_submit( prv_downlink_network_up, NULL );
+}
+
+/** @brief Build the response to a request: a piggybacked ACK for CON, NON otherwise. */
+static int prv_build_coap_response( struct coap_packet * rsp,
+                                    uint8_t * data,
+                                    const struct coap_request_view * request,
+                                    uint8_t code,
+                                    const uint8_t * payload,
+                                    size_t payload_len )
+{
+    int err;
+
+    if( request->type == COAP_TYPE_CON )
+    {
+        err = coap_ack_init( rsp, &request->packet, data, NCE_COAP_BUF_SIZE, code );
+    }
+    else
+    {
+        err = coap_packet_init( rsp, data, NCE_COAP_BUF_SIZE, COAP_VERSION_1, COAP_TYPE_NON_CON,
+                                request->tkl, request->token, code, coap_next_id() );
+    }
+
+    if( err < 0 )
     {
-        zsock_close( uplink_fd );
-        uplink_fd = -1;
+        LOG_ERR( "Failed to init CoAP response \n" );
+        return err;
     }
 
-    #if defined( CONFIG_NCE_ENABLE_DTLS )
-    if( connection_failure_count >= CONFIG_NCE_MAX_DTLS_CONNECTION_ATTEMPTS )
+    if( payload_len > 0 )
     {
-        LOG_WRN( "Max DTLS retries reached. Updating credentials..." );
-        connection_failure_count = 0;
-        err = prv_handle_dtls_failure();
+        err = coap_packet_append_payload_marker( rsp );
 
-        if( err )
+        if( err == 0 )
+        {
+            err = coap_packet_append_payload( rsp, payload, payload_len );
+        }
+
+        if( err < 0 )
         {
-            LOG_ERR( "Handle dtls failure, err=%d", err );
-            goto wait_and_retry;
+            LOG_ERR( "Response payload does not fit (%u bytes)", payload_len );
+            return err;
         }
     }
-    #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
 
-wait_and_retry:
+    NCE_NET_LOG_HEXDUMP_INF( rsp->data, rsp->offset, "sent response:" );
 
-    LOG_WRN( "Retrying uplink (%d/%d)...", retry_count, MAX_RETRIES );
-    k_sleep( K_SECONDS( 5 ) );
-    goto connect_retry;
+    return 0;
 }
 
-
-#if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
-/** @brief Initialize and send a CoAP acknowledgment. */
-static int send_coap_ack( int sock,
-                          struct coap_packet * packet,
-                          struct sockaddr * addr,
-                          socklen_t addr_len )
+#if defined( CONFIG_NCE_DOWNLINK_LISTEN )
+/** @brief Send the response to a request received on the listening socket. */
+static int send_coap_response( int sock,
+                               const struct coap_request_view * request,
+                               uint8_t code,
+                               const uint8_t * payload,
+                               size_t payload_len,
+                               struct sockaddr * addr,
+                               socklen_t addr_len )
 {
     int err;
-    struct coap_packet ack;
+    struct coap_packet rsp;
     uint8_t * data;
 
-    data = ( uint8_t * ) k_malloc( MAX_COAP_MSG_LEN );
+    data = nce_coap_buf_alloc( K_NO_WAIT );
 
     if( !data )
     {
         return -ENOMEM;
     }
 
-    err = coap_ack_init( &ack, packet, data, MAX_COAP_MSG_LEN, COAP_RESPONSE_CODE_CHANGED );
+    err = prv_build_coap_response( &rsp, data, request, code, payload, payload_len );
 
     if( err < 0 )
     {
-        LOG_ERR( "Failed to init CoAP ACK \n" );
         goto end;
     }
 
-    LOG_HEXDUMP_INF( ack.data, ack.offset, "sent ack:" );
-    err = zsock_sendto( sock, ack.data, ack.offset, 0, addr, addr_len );
+    #if defined( CONFIG_NCE_COAP_DEDUP )
+    /* Stored before sending: if the send fails, a retransmission gets the response without running the handler again */
+    coap_dedup_store( addr, request, rsp.data, rsp.offset );
+    #endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
+
+    err = zsock_sendto( sock, rsp.data, rsp.offset, 0, addr, addr_len );
 
     if( err < 0 )
     {
-        LOG_ERR( "Failed to init CoAP ACK (msg ID: %u, errno: %d)", coap_header_get_id( packet ), errno );
+        LOG_ERR( "Failed to send CoAP response (msg ID: %u, errno: %d)", request->id, errno );
         goto end;
     }
 
 end:
-    k_free( data );
+    nce_coap_buf_free( data );
     return err;
 }
-/** @brief Print CoAP message details. */
-void print_coap_options( struct coap_packet * packet )
+
+/** @brief Reject a CON message that is not a request (e.g. a CoAP ping). */
+static int send_coap_reset( int sock,
+                            const struct coap_request_view * request,
+                            struct sockaddr * addr,
+                            socklen_t addr_len )
 {
-    LOG_INF( "CoAP Options:" );
-    /* Create a coap_option array to hold the found options */
-    struct coap_option option_data[ CONFIG_NCE_COAP_MAX_URI_PATH_SEGMENTS ];
-    int num_options = coap_find_options( packet, COAP_OPTION_URI_PATH, option_data, CONFIG_NCE_COAP_MAX_URI_PATH_SEGMENTS );
+    int err;
+    struct coap_packet rst;
+    uint8_t * data;
+
+    data = nce_coap_buf_alloc( K_NO_WAIT );
+
+    if( !data )
+    {
+        return -ENOMEM;
+    }
 
-    /* If the Uri-Path option exists, extract and print the path */
-    if( num_options > 0 )
+    err = coap_rst_init( &rst, &request->packet, data, NCE_COAP_BUF_SIZE );
+
+    if( err == 0 )
     {
-        LOG_INF( "Complete Path: " );
+        err = zsock_sendto( sock, rst.data, rst.offset, 0, addr, addr_len );
+    }
 
-        for(int i = 0; i < num_options; i++)
-        {
-            struct coap_option * uri_path_opt = &option_data[ i ];
-            LOG_INF( "/%.*s\n", uri_path_opt->len, uri_path_opt->value );
-        }
+    nce_coap_buf_free( data );
+    return err;
+}
+#endif /* if defined( CONFIG_NCE_DOWNLINK_LISTEN ) */
+
+/** @brief Example handler: POST /example logs the command payload. */
+static uint8_t prv_handle_example( const struct coap_request_view * request,
+                                   uint8_t * response_payload,
+                                   size_t * response_len )
+{
+    ARG_UNUSED( response_payload );
+
+    if( request->payload_len == 0 )
+    {
+        *response_len = 0;
+        return COAP_RESPONSE_CODE_BAD_REQUEST;
     }
 
-    /* Create a coap_option array to hold the found Uri-Query options */
-    struct coap_option options_query[ CONFIG_NCE_COAP_MAX_URI_QUERY_PARAMS ];
+    LOG_INF( "Command received on /example (%u bytes)", request->payload_len );
+    *response_len = 0;
+
+    return COAP_RESPONSE_CODE_CHANGED;
+}
+
+/** @brief Example handler: GET /status reports uptime and connectivity. */
+static uint8_t prv_handle_status( const struct coap_request_view * request,
+                                  uint8_t * response_payload,
+                                  size_t * response_len )
+{
+    int len;
+
+    ARG_UNUSED( request );
+
+    #if defined( CONFIG_NCE_MODEM_DIAG )
+    struct modem_diag_info diag;
 
-    /* Find the Uri-Query options (option number 15) */
-    int num_query_options = coap_find_options( packet, COAP_OPTION_URI_QUERY, options_query, CONFIG_NCE_COAP_MAX_URI_QUERY_PARAMS );
+    /* Cached values only, the modem is not queried from the CoAP client thread */
+    modem_diag_get( &diag );
 
-    /* If the Uri-Query options exist, extract and print the query */
-    if( num_query_options > 0 )
+    if( diag.valid && ( diag.rsrp != MODEM_DIAG_RSRP_UNKNOWN ) )
+    {
+        len = snprintk( ( char * ) response_payload, *response_len,
+                        "{\"uptime\":%lld,\"connected\":%s,\"rsrp\":%d,\"rsrq\":%d}",
+                        k_uptime_get() / MSEC_PER_SEC, is_connected ? "true" : "false",
+                        diag.rsrp, diag.rsrq );
+    }
+    else
+    #endif /* if defined( CONFIG_NCE_MODEM_DIAG ) */
     {
-        LOG_INF( "Query: " );
+        len = snprintk( ( char * ) response_payload, *response_len, "{\"uptime\":%lld,\"connected\":%s}",
+                        k_uptime_get() / MSEC_PER_SEC, is_connected ? "true" : "false" );
+    }
 
-        for(int i = 0; i < num_query_options; i++)
-        {
-            struct coap_option * uri_query_opt = &options_query[ i ];
-            LOG_INF( "%.*s", uri_query_opt->len, uri_query_opt->value );
+    if( ( len < 0 ) || ( ( size_t ) len >= *response_len ) )
+    {
+        *response_len = 0;
+        return COAP_RESPONSE_CODE_INTERNAL_ERROR;
+    }
 
-            if( i < num_query_options - 1 )
-            {
-                LOG_INF( "&" );
-            }
-        }
+    *response_len = len;
+
+    return COAP_RESPONSE_CODE_CONTENT;
+}
+
+/** @brief Register the Device Controller routes. Add application commands here. */
+static void prv_register_routes( void )
+{
+    int err;
+
+    err = coap_router_register( COAP_METHOD_POST, "/example", prv_handle_example );
+
+    if( err == 0 )
+    {
+        err = coap_router_register( COAP_METHOD_GET, "/status", prv_handle_status );
+    }
+
+    if( err < 0 )
+    {
+        LOG_ERR( "Failed to register Device Controller routes: %d", err );
     }
 }
+
 static const char *coap_method_to_string( uint8_t code )
 {
     switch( code )
@@ -711,45 +2594,46 @@ static const char *coap_method_to_string( uint8_t code )
     }
 }
 
-void check_and_print_coap_response_code( struct coap_packet * packet )
+/** @brief Print CoAP message details from the parsed request view. */
+void print_coap_message( const struct coap_request_view * request )
 {
-    uint8_t code = coap_header_get_code( packet );
-    uint8_t code_class = code / COAP_CODE_CLASS_SIZE;
-    uint8_t code_detail = code % COAP_CODE_CLASS_SIZE;
+    uint8_t code_class = request->code / COAP_CODE_CLASS_SIZE;
+    uint8_t code_detail = request->code % COAP_CODE_CLASS_SIZE;
+    bool printable = true;
+
+    LOG_INF( "CoAP Header:" );
+    LOG_INF( "Version: %d", coap_header_get_version( &request->packet ) );
+    LOG_INF( "Type: %s", request->type == COAP_TYPE_CON ? "CON" : "NON" );
 
     if( code_class == 0 )
     {
-        const char * method_str = coap_method_to_string( code );
-        LOG_INF( "CoAP Request Method: %s (%d.%02d)", method_str, code_class, code_detail );
+        LOG_INF( "CoAP Request Method: %s (%d.%02d)", coap_method_to_string( request->code ), code_class, code_detail );
     }
     else
     {
         LOG_WRN( "Not a request (code class = %d.%02d)", code_class, code_detail );
     }
-}
-void print_coap_payload( struct coap_packet * packet )
-{
-    uint16_t payload_len;
 
-    if( !packet )
+    LOG_INF( "Message ID: %u", request->id );
+
+    for( uint8_t i = 0; i < request->path_count; i++ )
     {
-        LOG_ERR( "Null packet passed to CoAP print function" );
-        return;
+        LOG_INF( "Path: /%.*s", request->path[ i ]->len, request->path[ i ]->value );
     }
 
-    const uint8_t * payload = coap_packet_get_payload( packet, &payload_len );
+    for( uint8_t i = 0; i < request->query_count; i++ )
+    {
+        LOG_INF( "Query: %.*s", request->query[ i ]->len, request->query[ i ]->value );
+    }
 
-    if( !payload )
+    if( request->payload == NULL )
     {
-        LOG_WRN( "No Payload to be printed" );
         return;
     }
 
-    bool printable = true;
-
-    for(int i = 0; i < payload_len; i++)
+    for( int i = 0; i < request->payload_len; i++ )
     {
-        if( ( payload[ i ] < 32 ) || ( payload[ i ] > 126 ) )
+        if( ( request->payload[ i ] < 32 ) || ( request->payload[ i ] > 126 ) )
         {
             printable = false;
             break;
@@ -758,168 +2642,389 @@ void print_coap_payload( struct coap_packet * packet )
 
     if( printable )
     {
-        LOG_INF( "CoAP Payload: %.*s\n", payload_len, payload );
+        LOG_INF( "CoAP Payload: %.*s\n", request->payload_len, request->payload );
     }
     else
     {
-        LOG_HEXDUMP_INF( payload, payload_len, "CoAP Payload (binary):" );
+        LOG_HEXDUMP_INF( request->payload, request->payload_len, "CoAP Payload (binary):" );
     }
 }
-void print_coap_header( struct coap_packet * packet )
+#if defined( CONFIG_NCE_DOWNLINK_LISTEN )
+/** @brief Downlink socket callback: handle one incoming CoAP message. */
+static void prv_downlink_recv_cb( int fd,
+                                  int revents,
+                                  void * user_data )
 {
-    if( !packet )
+    int err;
+    static struct coap_request_view request;
+    static uint8_t buffer[ CONFIG_NCE_RECEIVE_BUFFER_SIZE ];
+    static uint8_t response_payload[ CONFIG_NCE_COAP_ROUTER_MAX_RESPONSE_PAYLOAD ];
+    size_t response_len;
+    uint8_t code;
+    struct sockaddr sender_addr;
+    socklen_t sender_addr_len = sizeof( sender_addr );
+    ssize_t received_bytes;
+
+    #if defined( CONFIG_NCE_COAP_DEDUP )
+    const uint8_t * cached_response;
+    #endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
+
+    ARG_UNUSED( revents );
+    ARG_UNUSED( user_data );
+
+    received_bytes = zsock_recvfrom( fd, buffer, sizeof( buffer ) - 1, ZSOCK_MSG_DONTWAIT,
+                                     ( struct sockaddr * ) &sender_addr, &sender_addr_len );
+
+    if( received_bytes < 0 )
     {
-        LOG_ERR( "Null packet passed to CoAP print function" );
+        if( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) )
+        {
+            return;
+        }
+
+        nce_net_stats_inc( NCE_NET_STAT_RX_ERRORS );
+        LOG_ERR( "recvfrom() failed, errno: %d", errno );
+        nce_net_io_socket_remove( fd );
+        zsock_close( fd );
+        downlink_fd = -1;
+        prv_downlink_retry();
         return;
     }
 
-    LOG_INF( "CoAP Header:" );
-    LOG_INF( "Version: %d", coap_header_get_version( packet ) );
-    LOG_INF( "Type: %s", coap_header_get_type( packet ) == COAP_TYPE_CON ? "CON" : "NON" );
-    check_and_print_coap_response_code( packet );
-    LOG_INF( "Message ID: %u", coap_header_get_id( packet ) );
-}
-void print_coap_message( struct coap_packet * packet )
-{
-    if( !packet )
+    buffer[ received_bytes ] = '\0';
+    nce_net_stats_inc( NCE_NET_STAT_RX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_RX_BYTES, received_bytes );
+    NCE_NET_LOG_INF( "Received %d bytes from server", received_bytes );
+    NCE_NET_LOG_HEXDUMP_INF( buffer, received_bytes, "Received raw data:" );
+
+    /* Parse the CoAP message once, handlers only use the view */
+    err = coap_request_view_parse( &request, buffer, received_bytes );
+
+    if( err < 0 )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_RX_ERRORS );
+        LOG_ERR( "coap_request_view_parse() failed: %d", err );
+        return;
+    }
+
+    if( NCE_NET_LOG_VERBOSE_ENABLED() )
+    {
+        print_coap_message( &request );
+    }
+
+    if( ( request.code == COAP_CODE_EMPTY ) || ( request.code / COAP_CODE_CLASS_SIZE != 0 ) )
+    {
+        if( request.type == COAP_TYPE_CON )
+        {
+            send_coap_reset( fd, &request, &sender_addr, sender_addr_len );
+        }
+
+        return;
+    }
+
+    #if defined( CONFIG_NCE_COAP_DEDUP )
+    /* Our ACK was lost and the server retransmitted: answer again, do not run the handler twice */
+    if( coap_dedup_check( &sender_addr, &request, &cached_response, &response_len ) )
     {
-        LOG_ERR( "Null packet passed to CoAP print function" );
+        nce_net_stats_inc( NCE_NET_STAT_RX_DUPS );
+        NCE_NET_LOG_INF( "Duplicate request (msg ID: %u)", request.id );
+
+        if( cached_response &&
+            ( zsock_sendto( fd, cached_response, response_len, 0, &sender_addr, sender_addr_len ) < 0 ) )
+        {
+            nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+            LOG_ERR( "Failed to resend CoAP response (msg ID: %u, errno: %d)", request.id, errno );
+        }
+
         return;
     }
+    #endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
 
-    print_coap_header( packet );
-    print_coap_options( packet );
-    print_coap_payload( packet );
+    response_len = sizeof( response_payload );
+    code = coap_router_dispatch( &request, response_payload, &response_len );
+
+    NCE_NET_LOG_INF( "Request handled with %d.%02d", code / COAP_CODE_CLASS_SIZE, code % COAP_CODE_CLASS_SIZE );
+
+    err = send_coap_response( fd, &request, code, response_payload, response_len,
+                              &sender_addr, sender_addr_len );
+
+    if( err < 0 )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_ERR( "send_coap_response() failed: %d\n", err );
+    }
+    else
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+        nce_net_stats_add( NCE_NET_STAT_TX_BYTES, err );
+        NCE_NET_LOG_INF( "CoAP response sent successfully" );
+    }
 }
-/** @brief Downlink function: Listens for incoming CoAP messages */
-void downlink_thread_fn( void * p1,
-                         void * p2,
-                         void * p3 )
+
+/** @brief Downlink timer: open the listening socket and hand it to the I/O thread. */
+static void prv_downlink_timer_fn( struct nce_net_io_timer * timer )
 {
-    int err;
-    const int MAX_RETRIES = CONFIG_NCE_DOWNLINK_MAX_RETRIES;
-    int retry_count = 0;
-    struct coap_packet response;
-    char buffer[ CONFIG_NCE_RECEIVE_BUFFER_SIZE ];
-    /* struct coap_packet response; */
     struct sockaddr_in my_addr =
     {
         .sin_family      = AF_INET,
         .sin_addr.s_addr = htonl( INADDR_ANY ),
         .sin_port        = htons( CONFIG_NCE_RECV_PORT )
     };
-    struct sockaddr sender_addr;
-    socklen_t sender_addr_len = sizeof( sender_addr );
 
-    LOG_INF( "Downlink thread started..." );
-retry_downlink:
+    ARG_UNUSED( timer );
 
     downlink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
 
     if( downlink_fd < 0 )
     {
         LOG_ERR( "Failed to create downlink socket, errno: %d", errno );
-        goto wait_and_retry;
+        goto retry;
     }
 
     /* Bind to the set port and IP */
     if( zsock_bind( downlink_fd, ( struct sockaddr * ) &my_addr, sizeof( struct sockaddr_in ) ) < 0 )
     {
         LOG_ERR( "Bind failed on port %d, errno: %d", CONFIG_NCE_RECV_PORT, errno );
-        zsock_close( downlink_fd );
-        downlink_fd = -1;
-        goto wait_and_retry;
+        goto close_and_retry;
+    }
+
+    if( nce_net_io_socket_add( downlink_fd, ZSOCK_POLLIN, prv_downlink_recv_cb, NULL ) )
+    {
+        goto close_and_retry;
     }
 
     LOG_INF( "Listening on port: %d\n", CONFIG_NCE_RECV_PORT );
+    nce_retry_succeeded( &downlink_retry );
+
+    return;
+
+close_and_retry:
+    zsock_close( downlink_fd );
+    downlink_fd = -1;
+
+retry:
+    prv_downlink_retry();
+}
+#endif /* if defined( CONFIG_NCE_DOWNLINK_LISTEN ) */
+
+#if defined( CONFIG_NCE_DOWNLINK_OBSERVE )
+/** @brief Last notification, handed from the CoAP client thread to the I/O thread. */
+static uint8_t observe_buffer[ CONFIG_NCE_RECEIVE_BUFFER_SIZE ];
+static size_t observe_len;
+static atomic_t observe_busy;
+static atomic_t observe_registered;
+
+static void prv_observe_response_cb( int16_t code,
+                                     size_t offset,
+                                     const uint8_t * payload,
+                                     size_t len,
+                                     bool last_block,
+                                     void * user_data );
+
+static struct coap_client_option observe_option =
+{
+    .code = COAP_OPTION_OBSERVE,
+    .len  = 0, /* Register (0) */
+};
+
+static struct coap_client_request observe_req =
+{
+    .method      = COAP_METHOD_GET,
+    .confirmable = true,
+    .path        = CONFIG_NCE_DOWNLINK_OBSERVE_PATH,
+    .fmt         = COAP_CONTENT_FORMAT_TEXT_PLAIN,
+    .cb          = prv_observe_response_cb,
+    .options     = &observe_option,
+    .num_options = 1,
+};
+
+static struct coap_client_request command_response_req =
+{
+    .method      = COAP_METHOD_POST,
+    .confirmable = false,
+    .path        = CONFIG_NCE_DOWNLINK_OBSERVE_PATH,
+    .fmt         = COAP_CONTENT_FORMAT_APP_OCTET_STREAM,
+    .cb          = response_cb,
+};
 
-    /* Set the timeout value */
-    struct timeval timeout;
-    timeout.tv_sec = 60;
-    timeout.tv_usec = 0;
+/** @brief Handle the request carried by a notification and post back the response. */
+static void prv_observe_notification( void * user_data )
+{
+    int err;
+    static struct coap_request_view request;
+    static uint8_t response_payload[ CONFIG_NCE_COAP_ROUTER_MAX_RESPONSE_PAYLOAD ];
+    size_t response_len;
+    struct coap_packet rsp;
+    uint8_t * data;
+    uint8_t code;
+
+    #if defined( CONFIG_NCE_COAP_DEDUP )
+    const uint8_t * cached_response;
+    #endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
 
-    if( zsock_setsockopt( downlink_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) ) < 0 )
+    ARG_UNUSED( user_data );
+
+    nce_net_stats_inc( NCE_NET_STAT_RX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_RX_BYTES, observe_len );
+    NCE_NET_LOG_HEXDUMP_INF( observe_buffer, observe_len, "Received notification:" );
+
+    err = coap_request_view_parse( &request, observe_buffer, observe_len );
+
+    if( ( err < 0 ) || ( request.code == COAP_CODE_EMPTY ) || ( request.code / COAP_CODE_CLASS_SIZE != 0 ) )
     {
-        LOG_ERR( "Failed to set socket timeout, errno: %d", errno );
-        zsock_close( downlink_fd );
-        downlink_fd = -1;
-        goto wait_and_retry;
+        nce_net_stats_inc( NCE_NET_STAT_RX_ERRORS );
+        LOG_ERR( "Notification does not carry a CoAP request: %d", err );
+        goto end;
     }
 
-    retry_count = 0;
+    if( NCE_NET_LOG_VERBOSE_ENABLED() )
+    {
+        print_coap_message( &request );
+    }
 
-    while( 1 )
+    #if defined( CONFIG_NCE_COAP_DEDUP )
+    /* The same command in a repeated notification, its response was already posted */
+    if( coap_dedup_check( NULL, &request, &cached_response, &response_len ) )
     {
-        ssize_t received_bytes = zsock_recvfrom( downlink_fd, buffer, sizeof( buffer ) - 1, 0,
-                                                 ( struct sockaddr * ) &sender_addr, &sender_addr_len );
+        nce_net_stats_inc( NCE_NET_STAT_RX_DUPS );
+        NCE_NET_LOG_INF( "Duplicate request (msg ID: %u)", request.id );
+        goto end;
+    }
+    #endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
 
-        if( received_bytes < 0 )
-        {
-            if( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) )
-            {
-                LOG_WRN( "No message received within timeout" );
-                k_msleep( 100 );
-                continue; /* keep listening */
-            }
-            else
-            {
-                LOG_ERR( "recvfrom() failed, errno: %d", errno );
-                zsock_close( downlink_fd );
-                downlink_fd = -1;
-                goto wait_and_retry;
-            }
-        }
+    response_len = sizeof( response_payload );
+    code = coap_router_dispatch( &request, response_payload, &response_len );
 
-        buffer[ received_bytes ] = '\0';
-        LOG_INF( "Received %d bytes from server", received_bytes );
-        LOG_HEXDUMP_INF( buffer, received_bytes, "Received raw data:" );
+    NCE_NET_LOG_INF( "Request handled with %d.%02d", code / COAP_CODE_CLASS_SIZE, code % COAP_CODE_CLASS_SIZE );
 
-        /* Parse CoAP message */
-        err = coap_packet_parse( &response, buffer, received_bytes, NULL, 0 );
+    #if defined( CONFIG_NCE_COAP_DEDUP )
+    coap_dedup_store( NULL, &request, NULL, 0 );
+    #endif /* if defined( CONFIG_NCE_COAP_DEDUP ) */
 
-        if( err < 0 )
-        {
-            LOG_ERR( "coap_packet_parse() failed: %d", err );
-            continue;
-        }
+    data = nce_coap_buf_alloc( K_NO_WAIT );
 
-        print_coap_message( &response );
+    if( !data )
+    {
+        LOG_ERR( "No buffer for the response" );
+        goto end;
+    }
 
-        /* Reply with CoAP ACK */
-        err = send_coap_ack( downlink_fd, &response, &sender_addr, sender_addr_len );
+    err = prv_build_coap_response( &rsp, data, &request, code, response_payload, response_len );
 
-        if( err < 0 )
-        {
-            LOG_ERR( "send_coap_ack() failed: %d\n", err );
-        }
-        else
-        {
-            LOG_INF( "CoAP ACK sent successfully" );
-        }
+    if( ( err == 0 ) && ( uplink_fd >= 0 ) )
+    {
+        /* The CoAP client copies the payload into its own request buffer */
+        command_response_req.payload = rsp.data;
+        command_response_req.len = rsp.offset;
+        err = coap_client_req( &coap_client, uplink_fd, NULL, &command_response_req, NULL );
     }
 
-wait_and_retry:
-    retry_count++;
-
-    if( retry_count < MAX_RETRIES )
+    if( err )
     {
-        LOG_WRN( "Retrying downlink socket setup (%d/%d)...", retry_count, MAX_RETRIES );
-        k_sleep( K_SECONDS( 5 ) );
-        goto retry_downlink;
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_ERR( "Failed to post the response: %d", err );
     }
     else
     {
-        LOG_ERR( "Max downlink retries reached. Stopping thread." );
+        nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+        nce_net_stats_add( NCE_NET_STAT_TX_BYTES, command_response_req.len );
+    }
 
-        if( downlink_fd > 0 )
-        {
-            zsock_close( downlink_fd );
-            downlink_fd = -1;
-        }
+    nce_coap_buf_free( data );
+
+end:
+    atomic_clear( &observe_busy );
+}
+
+/** @brief Registration failed or ended: register again while the uplink is open. */
+static void prv_observe_lost( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    if( ( uplink_fd >= 0 ) && !nce_net_io_timer_is_pending( &downlink_timer ) )
+    {
+        prv_downlink_retry();
+    }
+}
+
+/** @brief Observe callback, runs on the CoAP client thread. */
+static void prv_observe_response_cb( int16_t code,
+                                     size_t offset,
+                                     const uint8_t * payload,
+                                     size_t len,
+                                     bool last_block,
+                                     void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    if( ( code < 0 ) || ( code / COAP_CODE_CLASS_SIZE != COAP_SUCCESS_CODE_CLASS ) )
+    {
+        LOG_WRN( "Observe of %s ended: %d", CONFIG_NCE_DOWNLINK_OBSERVE_PATH, code );
+        atomic_clear( &observe_registered );
+        ( void ) nce_net_io_submit( prv_observe_lost, NULL );
+        return;
+    }
+
+    /* The registration response carries the current state, not a new command */
+    if( !atomic_set( &observe_registered, 1 ) )
+    {
+        nce_retry_succeeded( &downlink_retry );
+        LOG_INF( "Observing %s", CONFIG_NCE_DOWNLINK_OBSERVE_PATH );
+        return;
+    }
+
+    if( ( offset != 0 ) || !last_block || ( len == 0 ) || ( len > sizeof( observe_buffer ) ) )
+    {
+        LOG_WRN( "Notification of %u bytes ignored", len );
+        return;
+    }
+
+    if( atomic_set( &observe_busy, 1 ) )
+    {
+        LOG_WRN( "Notification dropped, the previous one is still handled" );
+        return;
+    }
+
+    memcpy( observe_buffer, payload, len );
+    observe_len = len;
+
+    if( nce_net_io_submit( prv_observe_notification, NULL ) )
+    {
+        atomic_clear( &observe_busy );
+    }
+}
+
+/** @brief Register the Observe relationship on the uplink socket. */
+static void prv_observe_register( void )
+{
+    int err;
+
+    if( uplink_fd < 0 )
+    {
+        return;
+    }
 
+    atomic_clear( &observe_registered );
+    err = coap_client_req( &coap_client, uplink_fd, NULL, &observe_req, NULL );
+
+    if( err )
+    {
+        LOG_WRN( "Observe registration not sent: %d", err );
+        prv_downlink_retry();
         return;
     }
+
+    LOG_INF( "Observe registration sent for %s", CONFIG_NCE_DOWNLINK_OBSERVE_PATH );
+}
+
+/** @brief Downlink timer: retry the Observe registration. */
+static void prv_observe_timer_fn( struct nce_net_io_timer * timer )
+{
+    ARG_UNUSED( timer );
+
+    prv_observe_register();
 }
+#endif /* if defined( CONFIG_NCE_DOWNLINK_OBSERVE ) */
 #endif /* if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER ) */
 
 static void l4_event_handler( struct net_mgmt_event_callback * cb,
@@ -934,6 +3039,10 @@ static void l4_event_handler( struct net_mgmt_event_callback * cb,
             is_connected = true;
             k_condvar_signal( &network_connected );
             k_mutex_unlock( &network_connected_lock );
+            #if defined( CONFIG_NCE_ENABLE_DTLS )
+            ( void ) k_work_cancel_delayable( &reattach_work );
+            #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
+            ( void ) nce_net_io_submit( prv_uplink_network_up, NULL );
             break;
 
         case NET_EVENT_L4_DISCONNECTED:
@@ -961,11 +3070,19 @@ static void connectivity_event_handler( struct net_mgmt_event_callback * cb,
 }
 int main( void )
 {
+    struct nce_retry_config uplink_retry_config = NCE_RETRY_CONFIG_DEFAULT;
+    #if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
+    struct nce_retry_config downlink_retry_config = NCE_RETRY_CONFIG_DEFAULT;
+    #endif /* if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER ) */
     int err;
 
     #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
     configureLeds();
-    k_sleep( K_SECONDS( 10 ) );
+
+    if( CONFIG_NCE_STARTUP_DELAY_SECONDS > 0 )
+    {
+        k_sleep( K_SECONDS( CONFIG_NCE_STARTUP_DELAY_SECONDS ) );
+    }
 
     if( ledRed.port )
     {
@@ -979,6 +3096,11 @@ int main( void )
     net_mgmt_init_event_callback( &conn_cb, connectivity_event_handler, CONN_LAYER_EVENT_MASK );
     net_mgmt_add_event_callback( &conn_cb );
 
+    #if defined( CONFIG_NCE_MODEM_DIAG )
+    /* Queried in the background after registration, the uplink does not wait */
+    modem_diag_start();
+    #endif /* if defined( CONFIG_NCE_MODEM_DIAG ) */
+
     /* Bring all network interfaces up.
      * Wi-Fi or LTE depending on the board that the sample was built for.
      */
@@ -1015,65 +3137,14 @@ int main( void )
 
     wait_for_network();
 
+    #if defined( CONFIG_NCE_BENCH )
+    err = bench_start();
 
-    static char response[128];
-    /* --- ICCID --- */
-    memset(response, 0, sizeof(response));
-    err = nrf_modem_at_cmd(response, sizeof(response), "AT%%XICCID");
-    if (err) {
-        printk("Failed to read ICCID, err %d\n", err);
-    } else {
-        /* Typical response: "+XICCID: 894450XXXXXXXXXXXX" */
-        char *p = strstr(response, ": ");
-        if (p) {
-            p += 2;  /* skip ": " */
-            for (int i = 0; p[i]; i++) {
-                if (p[i] == '\r' || p[i] == '\n') {
-                    p[i] = '\0';
-                    break;
-                }
-            }
-            printk("ICCID: %s\n", p);
-        } else {
-            printk("Unexpected ICCID response: %s\n", response);
-        }
-    }
-    
-    /* --- PSM Status (AT+CPSMS?) --- */
-    memset(response, 0, sizeof(response));
-    err = nrf_modem_at_cmd(response, sizeof(response), "AT+CPSMS");
-    if (err) {
-        printk("Failed to read PSM status, err %d\n", err);
-    } else {
-        printk("PSM Status: %s\n", response);
-    }
-
-    /* --- eDRX Settings (AT+CEDRXS?) --- */
-    memset(response, 0, sizeof(response));
-    err = nrf_modem_at_cmd(response, sizeof(response), "AT+CEDRXS?");
-    if (err) {
-        printk("Failed to read eDRX settings, err %d\n", err);
-    } else {
-        printk("eDRX Settings: %s\n", response);
-    }
-
-    /* --- Attach Status (AT+CGATT?) --- */
-    memset(response, 0, sizeof(response));
-    err = nrf_modem_at_cmd(response, sizeof(response), "AT+CGATT?");
-    if (err) {
-        printk("Failed to read attach status, err %d\n", err);
-    } else {
-        printk("Attach Status: %s\n", response);
-    }
-
-    /* --- Signal Quality (AT+CESQ) --- */
-    memset(response, 0, sizeof(response));
-    err = nrf_modem_at_cmd(response, sizeof(response), "AT+CESQ");
-    if (err) {
-        printk("Failed to read signal quality, err %d\n", err);
-    } else {
-        printk("Signal Quality: %s\n", response);
+    if( err )
+    {
+        return err;
     }
+    #endif /* if defined( CONFIG_NCE_BENCH ) */
 
 //    err = lte_lc_psm_req(true);
 //    if (err) {
@@ -1091,6 +3162,9 @@ int main( void )
         LOG_ERR( "Device onboarding failed, err %d\n", err );
         return err;
     }
+
+    /* Returns at once unless new credentials were stored and the modem reattaches */
+    wait_for_network();
     LOG_INF( "Device onboarded successfully \n" );
     #endif /* if defined( CONFIG_NCE_ENABLE_DTLS ) */
     LOG_INF( "1NCE CoAP Demo started" );
@@ -1103,24 +3177,43 @@ int main( void )
         return err;
     }
 
-    k_tid_t uplink_tid = k_thread_create( &uplink_thread, uplink_thread_stack,
-                                          K_THREAD_STACK_SIZEOF( uplink_thread_stack ),
-                                          uplink_thread_fn,
-                                          NULL, NULL, NULL,
-                                          THREAD_PRIORITY, 0, K_NO_WAIT );
-    k_thread_name_set( uplink_tid, "uplink_thread" );
+    /* Uplink and downlink run as callbacks of the single network I/O thread */
+    uplink_retry_config.max_attempts = CONFIG_NCE_UPLINK_MAX_RETRIES;
+    nce_retry_init( &uplink_retry, "uplink", &uplink_retry_config, prv_uplink_retry_resume );
+    #if defined( CONFIG_NCE_COAP_RTO )
+    nce_coap_rto_init( &uplink_rto, "uplink" );
+    #endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+    nce_net_io_timer_init( &uplink_timer, prv_uplink_timer_fn );
+    nce_net_io_timer_init( &uplink_connect_timer, prv_uplink_connect_timer_fn );
+    nce_net_io_timer_start( &uplink_connect_timer, K_NO_WAIT );
+
+    #if defined( CONFIG_NCE_RADIO_SCHED )
+    nce_net_io_timer_init( &uplink_defer_timer, prv_uplink_defer_timer_fn );
+    uplink_radio_listener.window = prv_uplink_radio_listener_cb;
+    nce_radio_sched_listen( &uplink_radio_listener );
+    #endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
 
     #if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
-    k_tid_t downlink_tid = k_thread_create( &downlink_thread, downlink_thread_stack,
-                                            K_THREAD_STACK_SIZEOF( downlink_thread_stack ),
-                                            downlink_thread_fn,
-                                            NULL, NULL, NULL,
-                                            THREAD_PRIORITY, 0, K_NO_WAIT );
-    k_thread_name_set( downlink_tid, "downlink_thread" );
+    prv_register_routes();
+    downlink_retry_config.max_attempts = CONFIG_NCE_DOWNLINK_MAX_RETRIES;
+    nce_retry_init( &downlink_retry, "downlink", &downlink_retry_config, prv_downlink_retry_resume );
+
+    #if defined( CONFIG_NCE_DOWNLINK_OBSERVE )
+    /* Registered on the uplink socket once it is connected */
+    nce_net_io_timer_init( &downlink_timer, prv_observe_timer_fn );
+    #else
+    nce_net_io_timer_init( &downlink_timer, prv_downlink_timer_fn );
+    nce_net_io_timer_start( &downlink_timer, K_NO_WAIT );
+    #endif /* if defined( CONFIG_NCE_DOWNLINK_OBSERVE ) */
     #endif
 
-    /* Delay or wait for the threads to complete */
-    k_sleep( K_SECONDS( 2 ) );
+    err = nce_net_io_start();
+
+    if( err )
+    {
+        LOG_ERR( "Failed to start the network I/O thread: %d", err );
+        return err;
+    }
 
     return 0;
 }
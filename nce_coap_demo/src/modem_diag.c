@@ -0,0 +1,189 @@
+/******************************************************************************
+ * @file    modem_diag.c
+ * @brief   Modem diagnostics collected in the background and cached.
+ * @details See modem_diag.h. The AT queries run on their own work queue below
+ *          the application threads, so a slow modem response delays neither
+ *          the network I/O thread nor the system work queue.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+#include <modem/lte_lc.h>
+#include <nrf_modem_at.h>
+
+#include "modem_diag.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define CESQ_UNKNOWN          255
+#define CESQ_RSRP_OFFSET      140
+#define CESQ_RSRQ_OFFSET_X2   39
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static K_THREAD_STACK_DEFINE( diag_stack, CONFIG_NCE_MODEM_DIAG_STACK_SIZE );
+static struct k_work_q diag_work_q;
+static struct k_work diag_work;
+static atomic_t started;
+
+static K_MUTEX_DEFINE( diag_lock );
+static struct modem_diag_info diag =
+{
+    .psm_tau         = -1,
+    .psm_active_time = -1,
+    .rsrp            = MODEM_DIAG_RSRP_UNKNOWN,
+};
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+
+/** @brief Run the AT queries, on the diagnostics work queue. */
+static void prv_diag_work_fn( struct k_work * work )
+{
+    char iccid[ MODEM_DIAG_ICCID_LEN + 1 ] = { 0 };
+    int attached = 0;
+    int psm = 0;
+    int edrx_mode = 0;
+    int rsrq = CESQ_UNKNOWN;
+    int rsrp = CESQ_UNKNOWN;
+    struct modem_diag_info info;
+
+    ARG_UNUSED( work );
+
+    /* Each query takes the AT interface for itself, answers are parsed in place */
+    ( void ) nrf_modem_at_scanf( "AT%XICCID", "%%XICCID: %22s", iccid );
+    ( void ) nrf_modem_at_scanf( "AT+CGATT?", "+CGATT: %d", &attached );
+    ( void ) nrf_modem_at_scanf( "AT+CPSMS?", "+CPSMS: %d", &psm );
+
+    /* One line per enabled access technology, none when eDRX is off */
+    if( nrf_modem_at_scanf( "AT+CEDRXS?", "+CEDRXS: %d", &edrx_mode ) != 1 )
+    {
+        edrx_mode = 0;
+    }
+
+    ( void ) nrf_modem_at_scanf( "AT+CESQ", "+CESQ: %*d,%*d,%*d,%*d,%d,%d", &rsrq, &rsrp );
+
+    k_mutex_lock( &diag_lock, K_FOREVER );
+
+    if( iccid[ 0 ] != '\0' )
+    {
+        memcpy( diag.iccid, iccid, sizeof( diag.iccid ) );
+    }
+
+    diag.attached = ( attached == 1 );
+    diag.psm_requested = ( psm == 1 );
+    diag.edrx_requested = ( edrx_mode != 0 );
+    diag.rsrp = ( rsrp == CESQ_UNKNOWN ) ? MODEM_DIAG_RSRP_UNKNOWN : ( int16_t ) ( rsrp - CESQ_RSRP_OFFSET );
+    diag.rsrq = ( rsrq == CESQ_UNKNOWN ) ? 0 : ( int16_t ) ( ( rsrq - CESQ_RSRQ_OFFSET_X2 ) >> 1 );
+    diag.updated = k_uptime_get();
+    diag.valid = true;
+    info = diag;
+
+    k_mutex_unlock( &diag_lock );
+
+    LOG_INF( "ICCID: %s, attached: %s, PSM: %s, eDRX: %s",
+             info.iccid[ 0 ] ? info.iccid : "unknown",
+             info.attached ? "yes" : "no",
+             info.psm_requested ? "requested" : "off",
+             info.edrx_requested ? "requested" : "off" );
+
+    if( info.rsrp != MODEM_DIAG_RSRP_UNKNOWN )
+    {
+        LOG_INF( "Signal quality: RSRP %d dBm, RSRQ %d dB", info.rsrp, info.rsrq );
+    }
+    else
+    {
+        LOG_INF( "Signal quality: unknown" );
+    }
+}
+
+/** @brief Link controller notifications, on the link controller's context. */
+static void prv_lte_handler( const struct lte_lc_evt * const evt )
+{
+    bool registered;
+
+    switch( evt->type )
+    {
+        case LTE_LC_EVT_NW_REG_STATUS:
+            registered = ( evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_HOME ) ||
+                         ( evt->nw_reg_status == LTE_LC_NW_REG_REGISTERED_ROAMING );
+
+            k_mutex_lock( &diag_lock, K_FOREVER );
+            diag.registered = registered;
+            k_mutex_unlock( &diag_lock );
+
+            if( registered )
+            {
+                modem_diag_refresh();
+            }
+
+            break;
+
+        case LTE_LC_EVT_PSM_UPDATE:
+            k_mutex_lock( &diag_lock, K_FOREVER );
+            diag.psm_tau = evt->psm_cfg.tau;
+            diag.psm_active_time = evt->psm_cfg.active_time;
+            k_mutex_unlock( &diag_lock );
+            break;
+
+        case LTE_LC_EVT_EDRX_UPDATE:
+            k_mutex_lock( &diag_lock, K_FOREVER );
+            diag.edrx_cycle = evt->edrx_cfg.edrx;
+            k_mutex_unlock( &diag_lock );
+            break;
+
+        default:
+            break;
+    }
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void modem_diag_start( void )
+{
+    if( atomic_set( &started, 1 ) )
+    {
+        return;
+    }
+
+    k_work_init( &diag_work, prv_diag_work_fn );
+    k_work_queue_start( &diag_work_q, diag_stack, K_THREAD_STACK_SIZEOF( diag_stack ),
+                        CONFIG_NCE_MODEM_DIAG_PRIORITY, NULL );
+    k_thread_name_set( &diag_work_q.thread, "modem_diag" );
+
+    /* The modem may not be up yet, the queries wait for the registration */
+    lte_lc_register_handler( prv_lte_handler );
+}
+
+void modem_diag_refresh( void )
+{
+    if( atomic_get( &started ) )
+    {
+        ( void ) k_work_submit_to_queue( &diag_work_q, &diag_work );
+    }
+}
+
+void modem_diag_get( struct modem_diag_info * info )
+{
+    k_mutex_lock( &diag_lock, K_FOREVER );
+    *info = diag;
+    k_mutex_unlock( &diag_lock );
+}
@@ -0,0 +1,64 @@
+/******************************************************************************
+ * @file    modem_diag.h
+ * @brief   Modem diagnostics collected in the background and cached.
+ * @details The ICCID, attach state, requested PSM and eDRX modes and the
+ *          signal quality are read with AT commands on a low-priority work
+ *          queue once the modem is registered, so they never hold up the
+ *          first uplink. The network-granted PSM and eDRX parameters and the
+ *          registration state follow the LTE link controller notifications.
+ *          Reads return the cached values and never block on the modem.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef MODEM_DIAG_H__
+#define MODEM_DIAG_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define MODEM_DIAG_ICCID_LEN         22
+#define MODEM_DIAG_RSRP_UNKNOWN      INT16_MIN
+
+/** @brief Cached diagnostics. */
+struct modem_diag_info
+{
+    bool valid;                                  /**< The AT queries ran at least once. */
+    char iccid[ MODEM_DIAG_ICCID_LEN + 1 ];      /**< SIM ICCID, empty if unread. */
+    bool registered;                             /**< Registered, home or roaming. */
+    bool attached;                               /**< Packet domain attached (AT+CGATT). */
+    bool psm_requested;                          /**< PSM requested (AT+CPSMS). */
+    bool edrx_requested;                         /**< eDRX requested for LTE-M or NB-IoT (AT+CEDRXS). */
+    int32_t psm_tau;                             /**< Granted periodic TAU in seconds, -1 if unknown. */
+    int32_t psm_active_time;                     /**< Granted active time in seconds, -1 if PSM is off. */
+    float edrx_cycle;                            /**< Granted eDRX cycle in seconds, 0 if unknown. */
+    int16_t rsrp;                                /**< RSRP in dBm, MODEM_DIAG_RSRP_UNKNOWN if unknown. */
+    int16_t rsrq;                                /**< RSRQ in dB, rounded down. */
+    int64_t updated;                             /**< Uptime of the last AT query in milliseconds. */
+};
+
+/**
+ * @brief Start collecting diagnostics.
+ *
+ * Registers for link controller notifications. The AT queries are scheduled
+ * on every network registration. Call before bringing the network up.
+ */
+void modem_diag_start( void );
+
+/**
+ * @brief Schedule a refresh of the AT queried values.
+ */
+void modem_diag_refresh( void );
+
+/**
+ * @brief Read the cached diagnostics.
+ *
+ * @param[out] info Copy of the cache.
+ */
+void modem_diag_get( struct modem_diag_info * info );
+
+#endif /* MODEM_DIAG_H__ */
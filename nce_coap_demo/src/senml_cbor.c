@@ -0,0 +1,294 @@
+/******************************************************************************
+ * @file    senml_cbor.c
+ * @brief   Allocation-free SenML-CBOR (RFC 8428) encoder.
+ * @details See senml_cbor.h. Integers use the shortest CBOR encoding except
+ *          for the base time slot, which always takes a 4-byte argument so
+ *          it can be overwritten in place.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "senml_cbor.h"
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+/* CBOR major types (RFC 8949 section 3.1) */
+#define CBOR_MAJOR_UINT           0x00
+#define CBOR_MAJOR_NINT           0x20
+#define CBOR_MAJOR_TEXT           0x60
+#define CBOR_MAJOR_MAP            0xa0
+#define CBOR_ARG_UINT8            24
+#define CBOR_ARG_UINT16           25
+#define CBOR_ARG_UINT32           26
+#define CBOR_ARG_UINT64           27
+#define CBOR_ARRAY_INDEFINITE     0x9f
+#define CBOR_FALSE                0xf4
+#define CBOR_TRUE                 0xf5
+#define CBOR_FLOAT32              0xfa
+#define CBOR_BREAK                0xff
+
+/* SenML labels (RFC 8428 section 6), all encode as a single byte */
+#define SENML_LABEL_BASE_NAME     0x21 /* -2 */
+#define SENML_LABEL_BASE_TIME     0x22 /* -3 */
+#define SENML_LABEL_NAME          0x00
+#define SENML_LABEL_UNIT          0x01
+#define SENML_LABEL_VALUE         0x02
+#define SENML_LABEL_STRING_VALUE  0x03
+#define SENML_LABEL_BOOL_VALUE    0x04
+#define SENML_LABEL_TIME          0x06
+
+/* Map header, base time label, 4-byte integer */
+#define BASE_TIME_SLOT_LEN        ( 2 + 1 + sizeof( uint32_t ) )
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static void prv_put( struct senml_cbor_writer * w,
+                     const void * data,
+                     size_t len )
+{
+    if( w->overflow || ( len > w->size - w->len ) )
+    {
+        w->overflow = true;
+        return;
+    }
+
+    memcpy( &w->buf[ w->len ], data, len );
+    w->len += len;
+}
+
+static void prv_put_byte( struct senml_cbor_writer * w,
+                          uint8_t byte )
+{
+    prv_put( w, &byte, 1 );
+}
+
+/** @brief Write a CBOR head with the shortest argument encoding. */
+static void prv_put_head( struct senml_cbor_writer * w,
+                          uint8_t major,
+                          uint64_t arg )
+{
+    uint8_t head[ 9 ];
+    size_t len;
+
+    if( arg < CBOR_ARG_UINT8 )
+    {
+        head[ 0 ] = major | ( uint8_t ) arg;
+        len = 1;
+    }
+    else if( arg <= UINT8_MAX )
+    {
+        head[ 0 ] = major | CBOR_ARG_UINT8;
+        head[ 1 ] = ( uint8_t ) arg;
+        len = 2;
+    }
+    else if( arg <= UINT16_MAX )
+    {
+        head[ 0 ] = major | CBOR_ARG_UINT16;
+        sys_put_be16( ( uint16_t ) arg, &head[ 1 ] );
+        len = 3;
+    }
+    else if( arg <= UINT32_MAX )
+    {
+        head[ 0 ] = major | CBOR_ARG_UINT32;
+        sys_put_be32( ( uint32_t ) arg, &head[ 1 ] );
+        len = 5;
+    }
+    else
+    {
+        head[ 0 ] = major | CBOR_ARG_UINT64;
+        sys_put_be64( arg, &head[ 1 ] );
+        len = 9;
+    }
+
+    prv_put( w, head, len );
+}
+
+static void prv_put_int( struct senml_cbor_writer * w,
+                         int64_t value )
+{
+    if( value >= 0 )
+    {
+        prv_put_head( w, CBOR_MAJOR_UINT, ( uint64_t ) value );
+    }
+    else
+    {
+        prv_put_head( w, CBOR_MAJOR_NINT, ( uint64_t ) ( -1 - value ) );
+    }
+}
+
+static void prv_put_text( struct senml_cbor_writer * w,
+                          const char * text )
+{
+    size_t len = strlen( text );
+
+    prv_put_head( w, CBOR_MAJOR_TEXT, len );
+    prv_put( w, text, len );
+}
+
+/** @brief Encode a 32-bit integer with a fixed 4-byte argument. */
+static void prv_encode_int32_fixed( uint8_t * out,
+                                    int32_t value )
+{
+    if( value >= 0 )
+    {
+        out[ 0 ] = CBOR_MAJOR_UINT | CBOR_ARG_UINT32;
+        sys_put_be32( ( uint32_t ) value, &out[ 1 ] );
+    }
+    else
+    {
+        out[ 0 ] = CBOR_MAJOR_NINT | CBOR_ARG_UINT32;
+        sys_put_be32( ( uint32_t ) ( -1 - ( int64_t ) value ), &out[ 1 ] );
+    }
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void senml_cbor_init( struct senml_cbor_writer * w,
+                      uint8_t * buf,
+                      size_t size )
+{
+    w->buf = buf;
+    w->size = size;
+    w->len = 0;
+    w->overflow = false;
+}
+
+void senml_cbor_pack_begin( struct senml_cbor_writer * w )
+{
+    prv_put_byte( w, CBOR_ARRAY_INDEFINITE );
+}
+
+void senml_cbor_pack_end( struct senml_cbor_writer * w )
+{
+    prv_put_byte( w, CBOR_BREAK );
+}
+
+void senml_cbor_record_begin( struct senml_cbor_writer * w,
+                              const struct senml_cbor_base * base,
+                              const char * name,
+                              const char * unit,
+                              int32_t time )
+{
+    bool has_base_name = ( base != NULL ) && ( base->name != NULL );
+    bool has_base_time = ( base != NULL ) && base->time_slot;
+    uint8_t pairs = 2; /* Name and value */
+
+    pairs += has_base_name + has_base_time + ( unit != NULL ) + ( time != 0 );
+    prv_put_head( w, CBOR_MAJOR_MAP, pairs );
+
+    /* The base time comes first so senml_cbor_patch_base_time() finds it */
+    if( has_base_time )
+    {
+        uint8_t slot[ 1 + sizeof( uint32_t ) ];
+
+        prv_put_byte( w, SENML_LABEL_BASE_TIME );
+        prv_encode_int32_fixed( slot, 0 );
+        prv_put( w, slot, sizeof( slot ) );
+    }
+
+    if( has_base_name )
+    {
+        prv_put_byte( w, SENML_LABEL_BASE_NAME );
+        prv_put_text( w, base->name );
+    }
+
+    prv_put_byte( w, SENML_LABEL_NAME );
+    prv_put_text( w, name );
+
+    if( unit != NULL )
+    {
+        prv_put_byte( w, SENML_LABEL_UNIT );
+        prv_put_text( w, unit );
+    }
+
+    if( time != 0 )
+    {
+        prv_put_byte( w, SENML_LABEL_TIME );
+        prv_put_int( w, time );
+    }
+}
+
+void senml_cbor_value_int( struct senml_cbor_writer * w,
+                           int64_t value )
+{
+    prv_put_byte( w, SENML_LABEL_VALUE );
+    prv_put_int( w, value );
+}
+
+void senml_cbor_value_float( struct senml_cbor_writer * w,
+                             float value )
+{
+    uint8_t out[ 1 + sizeof( uint32_t ) ];
+    uint32_t bits;
+
+    memcpy( &bits, &value, sizeof( bits ) );
+    out[ 0 ] = CBOR_FLOAT32;
+    sys_put_be32( bits, &out[ 1 ] );
+
+    prv_put_byte( w, SENML_LABEL_VALUE );
+    prv_put( w, out, sizeof( out ) );
+}
+
+void senml_cbor_value_string( struct senml_cbor_writer * w,
+                              const char * value )
+{
+    prv_put_byte( w, SENML_LABEL_STRING_VALUE );
+    prv_put_text( w, value );
+}
+
+void senml_cbor_value_bool( struct senml_cbor_writer * w,
+                            bool value )
+{
+    prv_put_byte( w, SENML_LABEL_BOOL_VALUE );
+    prv_put_byte( w, value ? CBOR_TRUE : CBOR_FALSE );
+}
+
+int senml_cbor_len( const struct senml_cbor_writer * w )
+{
+    return w->overflow ? -ENOMEM : ( int ) w->len;
+}
+
+int senml_cbor_patch_base_time( uint8_t * record,
+                                size_t len,
+                                int32_t time )
+{
+    if( ( len < BASE_TIME_SLOT_LEN ) ||
+        ( ( record[ 0 ] & 0xe0 ) != CBOR_MAJOR_MAP ) ||
+        ( record[ 1 ] != SENML_LABEL_BASE_TIME ) ||
+        ( ( record[ 2 ] & 0x1f ) != CBOR_ARG_UINT32 ) )
+    {
+        return -EINVAL;
+    }
+
+    prv_encode_int32_fixed( &record[ 2 ], time );
+
+    return 0;
+}
+
+int senml_cbor_patch_pack_base_time( uint8_t * pack,
+                                     size_t len,
+                                     int32_t time )
+{
+    if( ( len < 1 ) || ( pack[ 0 ] != CBOR_ARRAY_INDEFINITE ) )
+    {
+        return -EINVAL;
+    }
+
+    return senml_cbor_patch_base_time( &pack[ 1 ], len - 1, time );
+}
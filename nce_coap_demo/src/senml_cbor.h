@@ -0,0 +1,126 @@
+/******************************************************************************
+ * @file    senml_cbor.h
+ * @brief   Allocation-free SenML-CBOR (RFC 8428) encoder.
+ * @details Records are written straight into a caller-provided buffer using
+ *          the integer labels of RFC 8428 section 6. A pack is an
+ *          indefinite-length CBOR array, so records can be appended without
+ *          knowing their number in advance. Running out of space is sticky
+ *          and reported once by senml_cbor_len().
+ *
+ *          The base time of a record started with a base time slot is
+ *          encoded with a fixed width and can be set later with
+ *          senml_cbor_patch_base_time(), e.g. when a batch is sent.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef SENML_CBOR_H__
+#define SENML_CBOR_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Encoder state. */
+struct senml_cbor_writer
+{
+    uint8_t * buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+};
+
+/** @brief Base fields written in the first record of a pack. */
+struct senml_cbor_base
+{
+    const char * name; /**< Base name (bn), NULL to omit. */
+    bool time_slot;    /**< Reserve a base time (bt) to patch later. */
+};
+
+/**
+ * @brief Start encoding into a buffer.
+ *
+ * @param[out] w    Encoder.
+ * @param[in]  buf  Destination buffer.
+ * @param[in]  size Size of the destination buffer.
+ */
+void senml_cbor_init( struct senml_cbor_writer * w,
+                      uint8_t * buf,
+                      size_t size );
+
+/** @brief Open a pack (indefinite-length array). */
+void senml_cbor_pack_begin( struct senml_cbor_writer * w );
+
+/** @brief Close a pack. */
+void senml_cbor_pack_end( struct senml_cbor_writer * w );
+
+/**
+ * @brief Start a record. Must be followed by exactly one value.
+ *
+ * @param[in] w    Encoder.
+ * @param[in] base Base fields, NULL for none.
+ * @param[in] name Name (n), appended to the base name by the receiver.
+ * @param[in] unit Unit (u), NULL to omit.
+ * @param[in] time Time (t) relative to the base time in seconds, 0 to omit.
+ */
+void senml_cbor_record_begin( struct senml_cbor_writer * w,
+                              const struct senml_cbor_base * base,
+                              const char * name,
+                              const char * unit,
+                              int32_t time );
+
+/** @brief Numeric value (v) as an integer. */
+void senml_cbor_value_int( struct senml_cbor_writer * w,
+                           int64_t value );
+
+/** @brief Numeric value (v) as a single precision float. */
+void senml_cbor_value_float( struct senml_cbor_writer * w,
+                             float value );
+
+/** @brief String value (vs). */
+void senml_cbor_value_string( struct senml_cbor_writer * w,
+                              const char * value );
+
+/** @brief Boolean value (vb). */
+void senml_cbor_value_bool( struct senml_cbor_writer * w,
+                            bool value );
+
+/**
+ * @brief Get the encoded length.
+ *
+ * @return Number of bytes written, -ENOMEM if the buffer was too small.
+ */
+int senml_cbor_len( const struct senml_cbor_writer * w );
+
+/**
+ * @brief Set the base time of a record started with a base time slot.
+ *
+ * @param[in,out] record Start of the record.
+ * @param[in]     len    Bytes available from @p record.
+ * @param[in]     time   Base time in seconds. Values below 2^28 are
+ *                       relative to the time the pack is received.
+ *
+ * @return 0 on success, -EINVAL if @p record has no base time slot.
+ */
+int senml_cbor_patch_base_time( uint8_t * record,
+                                size_t len,
+                                int32_t time );
+
+/**
+ * @brief Set the base time of a pack whose first record has a base time slot.
+ *
+ * @param[in,out] pack Start of the pack.
+ * @param[in]     len  Length of the pack.
+ * @param[in]     time Base time, see senml_cbor_patch_base_time().
+ *
+ * @return 0 on success, -EINVAL if the pack does not start with a base time slot.
+ */
+int senml_cbor_patch_pack_base_time( uint8_t * pack,
+                                     size_t len,
+                                     int32_t time );
+
+#endif /* SENML_CBOR_H__ */
@@ -0,0 +1,167 @@
+/******************************************************************************
+ * @file    uplink_batch.c
+ * @brief   Bounded in-RAM batching of uplink samples.
+ * @details See uplink_batch.h. Without Energy Saver the samples are JSON
+ *          objects and the batch is framed as a JSON array; with Energy Saver
+ *          the fixed-size binary records are simply concatenated. SenML-CBOR
+ *          records are framed as an indefinite-length CBOR array, the sender
+ *          sets the base time of the first record.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "uplink_batch.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#if defined( CONFIG_NCE_ENERGY_SAVER )
+    #define BATCH_OPEN_LEN     0
+    #define BATCH_SEP_LEN      0
+    #define BATCH_CLOSE_LEN    0
+#elif defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+    #define BATCH_OPEN         0x9f /* Indefinite-length array */
+    #define BATCH_CLOSE        0xff /* Break */
+    #define BATCH_OPEN_LEN     1
+    #define BATCH_SEP_LEN      0
+    #define BATCH_CLOSE_LEN    1
+#else
+    #define BATCH_OPEN         '['
+    #define BATCH_SEP          ','
+    #define BATCH_CLOSE        ']'
+    #define BATCH_OPEN_LEN     1
+    #define BATCH_SEP_LEN      1
+    #define BATCH_CLOSE_LEN    1
+#endif /* if defined( CONFIG_NCE_ENERGY_SAVER ) */
+
+#define BATCH_BUFFER_SIZE      CONFIG_NCE_UPLINK_BATCH_MAX_PAYLOAD_SIZE
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static uint8_t batch_buffer[ BATCH_BUFFER_SIZE ];
+static size_t batch_len;
+static size_t batch_samples;
+static int64_t batch_first_sample_ms;
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+void uplink_batch_reset( void )
+{
+    batch_len = 0;
+    batch_samples = 0;
+    batch_first_sample_ms = 0;
+}
+
+int uplink_batch_add( const uint8_t * sample,
+                      size_t len )
+{
+    size_t needed = len + BATCH_CLOSE_LEN;
+
+    if( ( len == 0 ) || ( len + BATCH_OPEN_LEN + BATCH_CLOSE_LEN > BATCH_BUFFER_SIZE ) )
+    {
+        return -EMSGSIZE;
+    }
+
+    needed += ( batch_samples == 0 ) ? BATCH_OPEN_LEN : BATCH_SEP_LEN;
+
+    if( batch_len + needed > BATCH_BUFFER_SIZE )
+    {
+        return -ENOSPC;
+    }
+
+    if( batch_samples == 0 )
+    {
+        batch_first_sample_ms = k_uptime_get();
+        #if !defined( CONFIG_NCE_ENERGY_SAVER )
+        batch_buffer[ batch_len++ ] = BATCH_OPEN;
+        #endif
+    }
+    else
+    {
+        #if !defined( CONFIG_NCE_ENERGY_SAVER ) && !defined( CONFIG_NCE_PAYLOAD_SENML_CBOR )
+        batch_buffer[ batch_len++ ] = BATCH_SEP;
+        #endif
+    }
+
+    memcpy( &batch_buffer[ batch_len ], sample, len );
+    batch_len += len;
+    batch_samples++;
+
+    LOG_DBG( "Batched sample %u/%d (%u/%d bytes)", batch_samples,
+             CONFIG_NCE_UPLINK_BATCH_MAX_SAMPLES, batch_len, BATCH_BUFFER_SIZE );
+
+    return 0;
+}
+
+bool uplink_batch_is_due( void )
+{
+    if( batch_samples == 0 )
+    {
+        return false;
+    }
+
+    if( batch_samples >= CONFIG_NCE_UPLINK_BATCH_MAX_SAMPLES )
+    {
+        return true;
+    }
+
+    return ( k_uptime_get() - batch_first_sample_ms ) >=
+           ( ( int64_t ) CONFIG_NCE_UPLINK_BATCH_MAX_AGE_SECONDS * MSEC_PER_SEC );
+}
+
+size_t uplink_batch_count( void )
+{
+    return batch_samples;
+}
+
+uint32_t uplink_batch_age_seconds( void )
+{
+    if( batch_samples == 0 )
+    {
+        return 0;
+    }
+
+    return ( uint32_t ) ( ( k_uptime_get() - batch_first_sample_ms ) / MSEC_PER_SEC );
+}
+
+int64_t uplink_batch_time_ms( void )
+{
+    return batch_first_sample_ms;
+}
+
+int uplink_batch_finalize( uint8_t ** payload,
+                           size_t * len )
+{
+    if( batch_samples == 0 )
+    {
+        return -ENODATA;
+    }
+
+    /* The closing byte was reserved by uplink_batch_add(), it is written past
+     * batch_len so finalizing twice does not change the batch. */
+    #if !defined( CONFIG_NCE_ENERGY_SAVER )
+    batch_buffer[ batch_len ] = BATCH_CLOSE;
+    #endif
+
+    *payload = batch_buffer;
+    *len = batch_len + BATCH_CLOSE_LEN;
+
+    return 0;
+}
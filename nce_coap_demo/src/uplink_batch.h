@@ -0,0 +1,74 @@
+/******************************************************************************
+ * @file    uplink_batch.h
+ * @brief   Bounded in-RAM batching of uplink samples.
+ * @details Samples are appended to a single statically sized payload buffer in
+ *          their final on-air framing (a JSON array, a SenML-CBOR pack or
+ *          back-to-back Energy Saver records), so a flush is a single CoAP POST without any copy.
+ *          A batch is due once it holds the configured number of samples or
+ *          its oldest sample reaches the configured age. The size trigger is
+ *          reported by uplink_batch_add() returning -ENOSPC.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef UPLINK_BATCH_H__
+#define UPLINK_BATCH_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Drop all buffered samples and start an empty batch.
+ */
+void uplink_batch_reset( void );
+
+/**
+ * @brief Append one sample to the current batch.
+ *
+ * @param[in] sample Encoded sample (JSON object, SenML-CBOR records or
+ *                   Energy Saver record).
+ * @param[in] len    Length of the sample in bytes.
+ *
+ * @return 0 on success, -ENOSPC if the sample does not fit in the remaining
+ *         space (flush and retry), -EMSGSIZE if it can never fit.
+ */
+int uplink_batch_add( const uint8_t * sample,
+                      size_t len );
+
+/**
+ * @brief Check the count and age flush triggers.
+ *
+ * @return true if the batch should be sent now.
+ */
+bool uplink_batch_is_due( void );
+
+/** @brief Number of samples currently buffered. */
+size_t uplink_batch_count( void );
+
+/** @brief Seconds since the first buffered sample, 0 if the batch is empty. */
+uint32_t uplink_batch_age_seconds( void );
+
+/** @brief k_uptime_get() time of the first buffered sample, 0 if the batch is empty. */
+int64_t uplink_batch_time_ms( void );
+
+/**
+ * @brief Close the batch framing and expose the payload to send.
+ *
+ * Can be called repeatedly (e.g. after a failed send); the batch is only
+ * cleared by uplink_batch_reset(). The base time slot of a SenML-CBOR batch
+ * is left to the sender, see uplink_batch_time_ms().
+ *
+ * @param[out] payload Pointer to the framed payload.
+ * @param[out] len     Length of the framed payload.
+ *
+ * @return 0 on success, -ENODATA if the batch is empty.
+ */
+int uplink_batch_finalize( uint8_t ** payload,
+                           size_t * len );
+
+#endif /* UPLINK_BATCH_H__ */
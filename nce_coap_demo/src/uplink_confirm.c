@@ -0,0 +1,127 @@
+/******************************************************************************
+ * @file    uplink_confirm.c
+ * @brief   Adaptive confirmable/non-confirmable policy for uplink messages.
+ * @details See uplink_confirm.h. The loss estimate is kept in 1/1000 units:
+ *          loss += weight * ( sample - loss ), with sample 1000 for a lost
+ *          CON and 0 for an acknowledged one. The CON interval is
+ *          interpolated linearly between the configured maximum at 0 loss
+ *          and 1 at the loss threshold.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+/******************************************************************************
+* Includes
+******************************************************************************/
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/atomic.h>
+
+#include "uplink_confirm.h"
+
+LOG_MODULE_DECLARE( NCE_COAP_DEMO, CONFIG_COAP_CLIENT_SAMPLE_LOG_LEVEL );
+
+/******************************************************************************
+* Macros and Constants
+******************************************************************************/
+#define LOSS_SCALE             1000
+#define LOSS_THRESHOLD         ( CONFIG_NCE_UPLINK_CONFIRM_LOSS_THRESHOLD_PERCENT * 10 )
+#define MAX_CON_INTERVAL       CONFIG_NCE_UPLINK_CONFIRM_MAX_INTERVAL
+#define EWMA_WEIGHT_PERCENT    CONFIG_NCE_UPLINK_CONFIRM_EWMA_WEIGHT_PERCENT
+
+/******************************************************************************
+* Static Variables
+******************************************************************************/
+static struct k_spinlock confirm_lock;
+static struct uplink_confirm_stats confirm_stats = { .interval = MAX_CON_INTERVAL };
+/* Start at the interval so the first message after boot is confirmed */
+static uint16_t since_last_con = MAX_CON_INTERVAL;
+static atomic_t con_requested;
+
+/******************************************************************************
+* Static Function Definitions
+******************************************************************************/
+static uint16_t prv_interval_for_loss( uint16_t loss )
+{
+    if( loss >= LOSS_THRESHOLD )
+    {
+        return 1;
+    }
+
+    return MAX_CON_INTERVAL - ( ( MAX_CON_INTERVAL - 1 ) * loss ) / LOSS_THRESHOLD;
+}
+
+/******************************************************************************
+* Functions
+******************************************************************************/
+bool uplink_confirm_next( bool urgent )
+{
+    bool confirmable;
+    k_spinlock_key_t key;
+
+    urgent |= atomic_clear( &con_requested ) != 0;
+
+    key = k_spin_lock( &confirm_lock );
+
+    since_last_con++;
+    confirmable = urgent || ( since_last_con >= confirm_stats.interval );
+
+    if( confirmable )
+    {
+        since_last_con = 0;
+        confirm_stats.con_sent++;
+    }
+    else
+    {
+        confirm_stats.non_sent++;
+    }
+
+    k_spin_unlock( &confirm_lock, key );
+
+    return confirmable;
+}
+
+void uplink_confirm_request( void )
+{
+    atomic_set( &con_requested, 1 );
+}
+
+void uplink_confirm_result( bool acked )
+{
+    struct uplink_confirm_stats snapshot;
+    k_spinlock_key_t key = k_spin_lock( &confirm_lock );
+    int32_t sample = acked ? 0 : LOSS_SCALE;
+    int32_t loss = confirm_stats.loss_permille;
+
+    loss += ( EWMA_WEIGHT_PERCENT * ( sample - loss ) ) / 100;
+    confirm_stats.loss_permille = CLAMP( loss, 0, LOSS_SCALE );
+    confirm_stats.interval = prv_interval_for_loss( confirm_stats.loss_permille );
+
+    if( acked )
+    {
+        confirm_stats.acked++;
+    }
+    else
+    {
+        confirm_stats.lost++;
+    }
+
+    snapshot = confirm_stats;
+    k_spin_unlock( &confirm_lock, key );
+
+    LOG_INF( "CON %s, loss %u.%u%%, 1 CON every %u uplinks (CON %u, NON %u, acked %u, lost %u)",
+             acked ? "acked" : "lost", snapshot.loss_permille / 10, snapshot.loss_permille % 10,
+             snapshot.interval, snapshot.con_sent, snapshot.non_sent, snapshot.acked, snapshot.lost );
+}
+
+void uplink_confirm_stats_get( struct uplink_confirm_stats * stats )
+{
+    k_spinlock_key_t key = k_spin_lock( &confirm_lock );
+
+    *stats = confirm_stats;
+    k_spin_unlock( &confirm_lock, key );
+}
@@ -0,0 +1,69 @@
+/******************************************************************************
+ * @file    uplink_confirm.h
+ * @brief   Adaptive confirmable/non-confirmable policy for uplink messages.
+ * @details Routine samples are sent as NON and only every Nth message, or a
+ *          message flagged as urgent (changed value or alarm), is sent as
+ *          CON. The outcome of every CON exchange feeds an exponentially
+ *          weighted loss estimate, and N shrinks from the configured maximum
+ *          down to 1 (all CON) as the loss rate approaches the configured
+ *          threshold.
+ *
+ * @copyright
+ *     Copyright (c) 1NCE GmbH 2026
+ * @date       2026-10
+ ******************************************************************************/
+
+// SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+#ifndef UPLINK_CONFIRM_H__
+#define UPLINK_CONFIRM_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Delivery statistics.
+ */
+struct uplink_confirm_stats
+{
+    uint32_t con_sent;      /**< Messages sent as CON. */
+    uint32_t non_sent;      /**< Messages sent as NON. */
+    uint32_t acked;         /**< CON messages that got a response. */
+    uint32_t lost;          /**< CON messages that timed out or failed. */
+    uint16_t loss_permille; /**< Smoothed CON loss rate in 1/1000. */
+    uint16_t interval;      /**< Current N, one CON every N messages. */
+};
+
+/**
+ * @brief Decide whether the next uplink is sent as CON.
+ *
+ * Counts the message as sent in the returned mode.
+ *
+ * @param[in] urgent Force CON, e.g. because the sample changed.
+ *
+ * @return true for CON, false for NON.
+ */
+bool uplink_confirm_next( bool urgent );
+
+/**
+ * @brief Force the next uplink to be sent as CON, e.g. on an alarm.
+ *
+ * Safe to call from any context.
+ */
+void uplink_confirm_request( void );
+
+/**
+ * @brief Report the outcome of a CON uplink.
+ *
+ * @param[in] acked true if a response was received, false on timeout or error.
+ */
+void uplink_confirm_result( bool acked );
+
+/**
+ * @brief Read the delivery statistics.
+ *
+ * @param[out] stats Statistics snapshot.
+ */
+void uplink_confirm_stats_get( struct uplink_confirm_stats * stats );
+
+#endif /* UPLINK_CONFIRM_H__ */
@@ -38,6 +38,9 @@ LOG_MODULE_REGISTER( app_lwm2m_client, CONFIG_APP_LOG_LEVEL );
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <modem/modem_key_mgmt.h>
+#if defined( CONFIG_NCE_BOOT_PROFILE )
+    #include <nce_boot_profile.h>
+#endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
 
 #if defined( CONFIG_LWM2M_CLIENT_UTILS_LOCATION_ASSISTANCE )
     #include "ui_input.h"
@@ -458,6 +461,10 @@ static void rd_client_event( struct lwm2m_ctx * client,
 
         case LWM2M_RD_CLIENT_EVENT_REGISTRATION_COMPLETE:
             LOG_DBG( "Registration complete" );
+            #if defined( CONFIG_NCE_BOOT_PROFILE )
+            /* DNS and the DTLS handshake run inside the LwM2M engine */
+            nce_boot_profile_mark( NCE_BOOT_PHASE_FIRST_UPLINK );
+            #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
             #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
             if( ledBlue.port )
             {
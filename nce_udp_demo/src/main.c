@@ -19,10 +19,29 @@
 
 #include <zephyr/kernel.h>
 #include <stdio.h>
+#include <string.h>
 #include <modem/lte_lc.h>
 #include <modem/nrf_modem_lib.h>
 #include <zephyr/net/socket.h>
 #include <nce_iot_c_sdk.h>
+#include <nce_net_io.h>
+#include <nce_net_stats.h>
+#include <nce_retry.h>
+#if defined( CONFIG_NCE_BOOT_PROFILE )
+    #include <nce_boot_profile.h>
+#endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
+#if defined( CONFIG_NCE_UPLINK_COMPRESSION )
+    #include <nce_lz.h>
+#endif /* if defined( CONFIG_NCE_UPLINK_COMPRESSION ) */
+#if defined( CONFIG_NCE_RADIO_SCHED )
+    #include <nce_radio_sched.h>
+#endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+#if defined( CONFIG_NCE_ENERGY_ACCT )
+    #include <nce_energy_acct.h>
+#endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+#if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN )
+    #include "nce_energy_saver_template.h"
+#endif /* if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN ) */
 #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
     #include <zephyr/drivers/gpio.h>
 
@@ -44,24 +63,35 @@ static struct gpio_dt_spec ledBlue = GPIO_DT_SPEC_GET_OR( DT_ALIAS( led2 ), gpio
 /* LOG Macros */
 LOG_MODULE_REGISTER( NCE_UDP_DEMO, CONFIG_LOG_DEFAULT_LEVEL );
 #define UDP_IP_HEADER_SIZE    28
-#define UPLINK_STACK_SIZE     2048
-#define THREAD_PRIORITY       5
+
+/* First byte of an uplink datagram with CONFIG_NCE_UPLINK_COMPRESSION */
+#define UPLINK_HEADER_RAW     0x00
+#define UPLINK_HEADER_LZ      0x01
+
+#if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN )
+BUILD_ASSERT( CONFIG_PAYLOAD_DATA_SIZE - 1 >= NCE_ES_ENERGY_SAVER_SIZE,
+              "CONFIG_PAYLOAD_DATA_SIZE is smaller than the Energy Saver template" );
+#endif /* if defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN ) */
 
 /******************************************************************************
 * Static Variables
 ******************************************************************************/
 
-/** @brief Kernel stack and threading configurations */
-K_THREAD_STACK_DEFINE( uplink_thread_stack, UPLINK_STACK_SIZE );
-struct k_thread uplink_thread;
+/** @brief Uplink and downlink state, owned by the network I/O thread */
+static struct nce_net_io_timer uplink_timer;
 static int uplink_fd = -1;
+static struct nce_retry uplink_retry;
 static K_SEM_DEFINE( lte_connected_sem, 0, 1 );
 
+#if defined( CONFIG_NCE_RADIO_SCHED )
+static struct nce_radio_sched_listener uplink_radio_listener;
+static bool uplink_deferred;
+#endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+
 #if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
-    #define DOWNLINK_STACK_SIZE    1024
-K_THREAD_STACK_DEFINE( downlink_thread_stack, DOWNLINK_STACK_SIZE );
-struct k_thread downlink_thread;
+static struct nce_net_io_timer downlink_timer;
 static int downlink_fd = -1;
+static struct nce_retry downlink_retry;
 #endif
 
 /******************************************************************************
@@ -194,15 +224,11 @@ static void lte_handler( const struct lte_lc_evt *const evt )
 }
 
 /**
- * @brief Thread function handling outgoing UDP packets.
+ * @brief Resolve the server, open the uplink socket and connect it.
  */
-void uplink_thread_fn( void * p1,
-                       void * p2,
-                       void * p3 )
+static int prv_uplink_connect( void )
 {
     int err;
-    const int MAX_RETRIES = 5;
-    int retry_count = 0;
     struct addrinfo * res;
     struct addrinfo hints =
     {
@@ -210,18 +236,19 @@ void uplink_thread_fn( void * p1,
         .ai_socktype = SOCK_DGRAM,
     };
 
-    LOG_INF( "Uplink thread started..." );
-connect_retry:
     err = zsock_getaddrinfo( CONFIG_UDP_SERVER_HOSTNAME, NULL, &hints, &res );
 
     if( err < 0 )
     {
         LOG_ERR( "Failed to resolve hostname '%s' with getaddrinfo(), errno: %d (%s)",
                  CONFIG_UDP_SERVER_HOSTNAME, errno, strerror( errno ) );
-        err = -errno;
-        goto wait_and_retry;
+        return -errno;
     }
 
+    #if defined( CONFIG_NCE_BOOT_PROFILE )
+    nce_boot_profile_mark( NCE_BOOT_PHASE_DNS );
+    #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
+
     ( ( struct sockaddr_in * ) res->ai_addr )->sin_port = htons( CONFIG_UDP_SERVER_PORT );
     uplink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
 
@@ -229,8 +256,7 @@ connect_retry:
     {
         LOG_ERR( "Failed to create UDP socket: %d", errno );
         zsock_freeaddrinfo( res );
-        err = -errno;
-        goto wait_and_retry;
+        return -errno;
     }
 
     err = zsock_connect( uplink_fd, ( struct sockaddr * ) res->ai_addr,
@@ -240,192 +266,389 @@ connect_retry:
     if( err < 0 )
     {
         LOG_ERR( "Uplink connect failed : %d", errno );
+        err = -errno;
         zsock_close( uplink_fd );
         uplink_fd = -1;
-        goto wait_and_retry;
+        return err;
     }
 
     LOG_INF( "Hostname %s, port number %d",
              CONFIG_UDP_SERVER_HOSTNAME,
              CONFIG_UDP_SERVER_PORT );
-    retry_count = 0;
 
-    while( 1 )
+    return 0;
+}
+
+#if defined( CONFIG_NCE_UPLINK_COMPRESSION )
+
+/**
+ * @brief Frame a payload behind the compression header byte, compressed if
+ *        that makes it smaller.
+ *
+ * @param[out] frame   Destination buffer, at least @p len + 1 bytes.
+ * @param[in]  size    Size of the destination buffer.
+ * @param[in]  payload Payload.
+ * @param[in]  len     Payload length.
+ * @return Frame length in bytes.
+ */
+static size_t prv_compress_frame( uint8_t * frame,
+                                  size_t size,
+                                  const uint8_t * payload,
+                                  size_t len )
+{
+    int compressed_len = -ENOSPC;
+
+    if( len > 1 )
+    {
+        compressed_len = nce_lz_compress( payload, len, &frame[ 1 ], MIN( len - 1, size - 1 ) );
+    }
+
+    if( compressed_len > 0 )
     {
-        #if !defined( CONFIG_NCE_ENERGY_SAVER )
-        char buffer[] = CONFIG_PAYLOAD;
-        LOG_INF( "Payload (string): %s", buffer );
-        #else
-        char buffer[ CONFIG_PAYLOAD_DATA_SIZE ];
+        NCE_NET_LOG_INF( "Payload compressed from %u to %d bytes (%u%%)", len, compressed_len,
+                         ( unsigned int ) ( compressed_len * 100 / len ) );
+        frame[ 0 ] = UPLINK_HEADER_LZ;
+        return compressed_len + 1;
+    }
 
-        Element2byte_gen_t battery_level = { .type = E_INTEGER, .value.i = 99, .template_length = 1 };
-        Element2byte_gen_t signal_strength = { .type = E_INTEGER, .value.i = 84, .template_length = 1 };
-        Element2byte_gen_t software_version = { .type = E_STRING, .value.s = "2.2.1", .template_length = 5 };
-        err = os_energy_save( buffer, 1, 3, battery_level, signal_strength, software_version );
+    frame[ 0 ] = UPLINK_HEADER_RAW;
+    memcpy( &frame[ 1 ], payload, len );
+    return len + 1;
+}
+#endif /* if defined( CONFIG_NCE_UPLINK_COMPRESSION ) */
 
-        if( err < 0 )
-        {
-            LOG_ERR( "Failed to save energy, %d", errno );
-        }
+/**
+ * @brief Build one payload and send it on the uplink socket.
+ */
+static int prv_uplink_send( void )
+{
+    int err;
 
-        LOG_INF( "Transmitting UDP/IP payload of %d bytes to the server %s:%d",
-                 CONFIG_PAYLOAD_DATA_SIZE + UDP_IP_HEADER_SIZE, CONFIG_UDP_SERVER_HOSTNAME, CONFIG_UDP_SERVER_PORT );
-        LOG_HEXDUMP_INF( buffer, sizeof( buffer ), "Payload (binary):" );
-        #endif /* if !defined( CONFIG_NCE_ENERGY_SAVER ) */
-        err = zsock_send( uplink_fd, buffer, sizeof( buffer ) - 1, 0 );
+    #if !defined( CONFIG_NCE_ENERGY_SAVER )
+    char buffer[] = CONFIG_PAYLOAD;
+    size_t payload_len = sizeof( buffer ) - 1;
+    NCE_NET_LOG_INF( "Payload (string): %s", buffer );
+    #elif defined( CONFIG_NCE_ENERGY_SAVER_CODEGEN )
+    /* Same datagram length as the os_energy_save() path, the bytes after the record are zero */
+    uint8_t buffer[ CONFIG_PAYLOAD_DATA_SIZE ] = { 0 };
+    size_t payload_len = sizeof( buffer ) - 1;
+    const struct nce_es_energy_saver values =
+    {
+        .battery_level    = 99,
+        .signal_strength  = 84,
+        .software_version = "2.2.1",
+    };
 
-        if( err < 0 )
-        {
-            LOG_ERR( "Send failed (errno: %d), reconnecting...", errno );
-            zsock_close( uplink_fd );
-            uplink_fd = -1;
-            goto wait_and_retry;
-        }
-        else
-        {
-            LOG_INF( "UDP packet sent (%d bytes)", err );
-            #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
-            if( ledBlue.port )
-            {
-                gpio_pin_set_dt( &ledBlue, 0 );
-            }
+    ( void ) nce_es_energy_saver_encode( buffer, &values );
 
-            if( ledGreen.port )
-            {
-                gpio_pin_set_dt( &ledGreen, 100 );
-            }
-            #endif
-        }
+    NCE_NET_LOG_INF( "Transmitting UDP/IP payload of %d bytes to the server %s:%d",
+                     payload_len + UDP_IP_HEADER_SIZE, CONFIG_UDP_SERVER_HOSTNAME, CONFIG_UDP_SERVER_PORT );
+    NCE_NET_LOG_HEXDUMP_INF( buffer, payload_len, "Payload (binary):" );
+    #else
+    char buffer[ CONFIG_PAYLOAD_DATA_SIZE ];
+    size_t payload_len = sizeof( buffer ) - 1;
+
+    Element2byte_gen_t battery_level = { .type = E_INTEGER, .value.i = 99, .template_length = 1 };
+    Element2byte_gen_t signal_strength = { .type = E_INTEGER, .value.i = 84, .template_length = 1 };
+    Element2byte_gen_t software_version = { .type = E_STRING, .value.s = "2.2.1", .template_length = 5 };
+    err = os_energy_save( buffer, 1, 3, battery_level, signal_strength, software_version );
+
+    if( err < 0 )
+    {
+        LOG_ERR( "Failed to save energy, %d", errno );
+    }
+
+    NCE_NET_LOG_INF( "Transmitting UDP/IP payload of %d bytes to the server %s:%d",
+                     CONFIG_PAYLOAD_DATA_SIZE + UDP_IP_HEADER_SIZE, CONFIG_UDP_SERVER_HOSTNAME, CONFIG_UDP_SERVER_PORT );
+    NCE_NET_LOG_HEXDUMP_INF( buffer, sizeof( buffer ), "Payload (binary):" );
+    #endif /* if !defined( CONFIG_NCE_ENERGY_SAVER ) */
+    #if defined( CONFIG_NCE_UPLINK_COMPRESSION )
+    uint8_t frame[ sizeof( buffer ) + 1 ];
+    size_t frame_len = prv_compress_frame( frame, sizeof( frame ), ( const uint8_t * ) buffer, payload_len );
+
+    err = zsock_send( uplink_fd, frame, frame_len, 0 );
+    #else
+    err = zsock_send( uplink_fd, buffer, payload_len, 0 );
+    #endif /* if defined( CONFIG_NCE_UPLINK_COMPRESSION ) */
 
-        k_sleep( K_SECONDS( CONFIG_UDP_DATA_UPLOAD_FREQUENCY_SECONDS ) );
+    if( err < 0 )
+    {
+        nce_net_stats_inc( NCE_NET_STAT_TX_ERRORS );
+        LOG_ERR( "Send failed (errno: %d), reconnecting...", errno );
+        return -errno;
     }
 
-wait_and_retry:
-    retry_count++;
+    nce_net_stats_inc( NCE_NET_STAT_TX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_TX_BYTES, err );
+    NCE_NET_LOG_INF( "UDP packet sent (%d bytes)", err );
+    #if defined( CONFIG_NCE_ENERGY_ACCT )
+    /* No response and no retransmission, the message is done once sent */
+    nce_energy_acct_done( nce_energy_acct_tx( payload_len, err + NCE_ENERGY_ACCT_IP_UDP_OVERHEAD ), 0, 0 );
+    #endif /* if defined( CONFIG_NCE_ENERGY_ACCT ) */
+    #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
+    if( ledBlue.port )
+    {
+        gpio_pin_set_dt( &ledBlue, 0 );
+    }
 
-    if( retry_count < MAX_RETRIES )
+    if( ledGreen.port )
     {
-        LOG_WRN( "Retrying uplink (%d/%d)...", retry_count, MAX_RETRIES );
-        k_sleep( K_SECONDS( 5 ) );
-        goto connect_retry;
+        gpio_pin_set_dt( &ledGreen, 100 );
     }
-    else
+    #endif
+
+    return 0;
+}
+
+/**
+ * @brief Uplink timer: connect when needed, send one payload and schedule the next one.
+ */
+static void prv_uplink_timer_fn( struct nce_net_io_timer * timer )
+{
+    k_timeout_t delay;
+    uint32_t start;
+    int err = -ENOTCONN;
+
+    #if defined( CONFIG_NCE_RADIO_SCHED )
+    /* Wait for the modem to wake up instead of waking it, retries are not held back */
+    if( !uplink_deferred && ( nce_retry_attempts( &uplink_retry ) == 0 ) )
     {
-        LOG_ERR( " Max uplink retries reached. Stopping thread." );
+        delay = nce_radio_sched_delay( CONFIG_NCE_UPLINK_MAX_DEFER_SECONDS * MSEC_PER_SEC );
 
-        if( uplink_fd > 0 )
+        if( !K_TIMEOUT_EQ( delay, K_NO_WAIT ) )
         {
-            zsock_close( uplink_fd );
-            uplink_fd = -1;
+            NCE_NET_LOG_INF( "Modem asleep, uplink deferred" );
+            uplink_deferred = true;
+            nce_net_io_timer_start( timer, delay );
+            return;
         }
+    }
+
+    uplink_deferred = false;
+    #endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+
+    if( uplink_fd < 0 )
+    {
+        ( void ) prv_uplink_connect();
+    }
+
+    if( uplink_fd >= 0 )
+    {
+        /* CPU time of building, encoding and handing one payload to the network */
+        start = nce_net_stats_time_begin();
+        err = prv_uplink_send();
+        nce_net_stats_time_end( start );
+    }
+
+    if( err == 0 )
+    {
+        nce_retry_succeeded( &uplink_retry );
+        #if defined( CONFIG_NCE_BOOT_PROFILE )
+        /* UDP is not acknowledged, the phase ends when the datagram is sent */
+        nce_boot_profile_mark( NCE_BOOT_PHASE_FIRST_UPLINK );
+        #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
+        nce_net_io_timer_start( timer, K_SECONDS( CONFIG_UDP_DATA_UPLOAD_FREQUENCY_SECONDS ) );
+        return;
+    }
+
+    if( uplink_fd >= 0 )
+    {
+        zsock_close( uplink_fd );
+        uplink_fd = -1;
+    }
+
+    err = nce_retry_failed( &uplink_retry, &delay );
+
+    if( err == -ENETDOWN )
+    {
+        LOG_WRN( "Uplink paused until the network is back" );
+        return;
+    }
 
+    if( err )
+    {
+        LOG_ERR( "Max uplink retries reached. Waiting for the network to reconnect." );
         return;
     }
+
+    nce_net_stats_inc( NCE_NET_STAT_RETRIES );
+    LOG_WRN( "Retrying uplink (attempt %u)...", nce_retry_attempts( &uplink_retry ) );
+    nce_net_io_timer_start( timer, delay );
+}
+
+/**
+ * @brief Network is back after the uplink retries paused or gave up.
+ */
+static void prv_uplink_network_up( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    nce_net_io_timer_start( &uplink_timer, nce_retry_resume( &uplink_retry ) );
 }
 
+static void prv_uplink_retry_resume( struct nce_retry * retry )
+{
+    ARG_UNUSED( retry );
+
+    ( void ) nce_net_io_submit( prv_uplink_network_up, NULL );
+}
+
+#if defined( CONFIG_NCE_RADIO_SCHED )
+/**
+ * @brief A radio window opened early, send the deferred payload with it.
+ */
+static void prv_uplink_radio_window( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    if( uplink_deferred )
+    {
+        nce_net_io_timer_start( &uplink_timer, K_NO_WAIT );
+    }
+}
+
+static void prv_uplink_radio_listener_cb( struct nce_radio_sched_listener * listener )
+{
+    ARG_UNUSED( listener );
+
+    ( void ) nce_net_io_submit( prv_uplink_radio_window, NULL );
+}
+#endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
+
 #if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
 
 /**
- * @brief Thread function handling incoming messages.
+ * @brief Schedule the next downlink socket setup with the retry policy.
+ */
+static void prv_downlink_retry( void )
+{
+    k_timeout_t delay;
+    int err;
+
+    err = nce_retry_failed( &downlink_retry, &delay );
+
+    if( err == -ENETDOWN )
+    {
+        LOG_WRN( "Downlink paused until the network is back" );
+        return;
+    }
+
+    if( err )
+    {
+        LOG_ERR( "Max downlink retries reached. Waiting for the network to reconnect." );
+        return;
+    }
+
+    nce_net_stats_inc( NCE_NET_STAT_RETRIES );
+    LOG_WRN( "Retrying downlink socket init (attempt %u)...", nce_retry_attempts( &downlink_retry ) );
+    nce_net_io_timer_start( &downlink_timer, delay );
+}
+
+/**
+ * @brief Network is back after the downlink retries paused or gave up.
+ */
+static void prv_downlink_network_up( void * user_data )
+{
+    ARG_UNUSED( user_data );
+
+    if( ( downlink_fd < 0 ) && !nce_net_io_timer_is_pending( &downlink_timer ) )
+    {
+        nce_net_io_timer_start( &downlink_timer, nce_retry_resume( &downlink_retry ) );
+    }
+}
+
+static void prv_downlink_retry_resume( struct nce_retry * retry )
+{
+    ARG_UNUSED( retry );
+
+    ( void ) nce_net_io_submit( prv_downlink_network_up, NULL );
+}
+
+/**
+ * @brief Downlink socket callback: log one incoming message.
  */
-void downlink_thread_fn( void * p1,
-                         void * p2,
-                         void * p3 )
+static void prv_downlink_recv_cb( int fd,
+                                  int revents,
+                                  void * user_data )
+{
+    static char buffer[ 256 ];
+    struct sockaddr_in sender_addr;
+    socklen_t sender_addr_len = sizeof( sender_addr );
+    ssize_t received_bytes;
+
+    ARG_UNUSED( revents );
+    ARG_UNUSED( user_data );
+
+    received_bytes = zsock_recvfrom( fd, buffer, sizeof( buffer ) - 1, ZSOCK_MSG_DONTWAIT,
+                                     ( struct sockaddr * ) &sender_addr, &sender_addr_len );
+
+    if( received_bytes < 0 )
+    {
+        if( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) )
+        {
+            return;
+        }
+
+        nce_net_stats_inc( NCE_NET_STAT_RX_ERRORS );
+        LOG_ERR( "recvfrom() failed, errno: %d", errno );
+        nce_net_io_socket_remove( fd );
+        zsock_close( fd );
+        downlink_fd = -1;
+        prv_downlink_retry();
+        return;
+    }
+
+    buffer[ received_bytes ] = '\0';
+    nce_net_stats_inc( NCE_NET_STAT_RX_MSGS );
+    nce_net_stats_add( NCE_NET_STAT_RX_BYTES, received_bytes );
+    NCE_NET_LOG_INF( "Received message: %s", buffer );
+}
+
+/**
+ * @brief Downlink timer: open the listening socket and hand it to the I/O thread.
+ */
+static void prv_downlink_timer_fn( struct nce_net_io_timer * timer )
 {
-    char buffer[ 256 ];
     struct sockaddr_in my_addr =
     {
         .sin_family      = AF_INET,
         .sin_addr.s_addr = htonl( INADDR_ANY ),
         .sin_port        = htons( CONFIG_NCE_RECV_PORT )
     };
-    struct sockaddr_in sender_addr;
-    socklen_t sender_addr_len = sizeof( sender_addr );
-    const int MAX_RETRIES = 5;
-    int retry_count = 0;
 
-    LOG_INF( "Downlink thread started..." );
-retry_downlink:
+    ARG_UNUSED( timer );
+
     /* Create socket */
     downlink_fd = zsock_socket( AF_INET, SOCK_DGRAM, IPPROTO_UDP );
 
     if( downlink_fd < 0 )
     {
         LOG_ERR( "Failed to create downlink socket, errno: %d", errno );
-        goto wait_and_retry;
+        goto retry;
     }
 
     if( zsock_bind( downlink_fd, ( struct sockaddr * ) &my_addr, sizeof( struct sockaddr_in ) ) < 0 )
     {
         LOG_ERR( "Bind failed on port %d, errno: %d", CONFIG_NCE_RECV_PORT, errno );
-        zsock_close( downlink_fd );
-        downlink_fd = -1;
-        goto wait_and_retry;
+        goto close_and_retry;
     }
 
-    LOG_INF( "Listening on port: %d", CONFIG_NCE_RECV_PORT );
-    struct timeval timeout =
-    {
-        .tv_sec  = 60,
-        .tv_usec = 0
-    };
-
-    if( zsock_setsockopt( downlink_fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) ) < 0 )
+    if( nce_net_io_socket_add( downlink_fd, ZSOCK_POLLIN, prv_downlink_recv_cb, NULL ) )
     {
-        LOG_ERR( "Failed to set socket timeout, errno: %d", errno );
-        zsock_close( downlink_fd );
-        downlink_fd = -1;
-        goto wait_and_retry;
+        goto close_and_retry;
     }
 
-    retry_count = 0;
-
-    while( 1 )
-    {
-        ssize_t received_bytes = zsock_recvfrom( downlink_fd, buffer, sizeof( buffer ) - 1, 0,
-                                                 ( struct sockaddr * ) &sender_addr, &sender_addr_len );
-
-        if( received_bytes < 0 )
-        {
-            if( ( errno == EAGAIN ) || ( errno == EWOULDBLOCK ) )
-            {
-                LOG_WRN( "No message received within timeout" );
-                continue; /* keep listening */
-            }
-            else
-            {
-                LOG_ERR( "recvfrom() failed, errno: %d", errno );
-                zsock_close( downlink_fd );
-                downlink_fd = -1;
-                goto wait_and_retry;
-            }
-        }
-
-        buffer[ received_bytes ] = '\0';
-        LOG_INF( "Received message: %s", buffer );
-    }
+    LOG_INF( "Listening on port: %d", CONFIG_NCE_RECV_PORT );
+    nce_retry_succeeded( &downlink_retry );
 
-wait_and_retry:
-    retry_count++;
+    return;
 
-    if( retry_count < MAX_RETRIES )
-    {
-        LOG_WRN( "Retrying downlink socket init (%d/%d)...", retry_count, MAX_RETRIES );
-        k_sleep( K_SECONDS( 5 ) );
-        goto retry_downlink;
-    }
-    else
-    {
-        LOG_ERR( "Max downlink retries reached. Stopping thread." );
+close_and_retry:
+    zsock_close( downlink_fd );
+    downlink_fd = -1;
 
-        if( downlink_fd > 0 )
-        {
-            zsock_close( downlink_fd );
-            downlink_fd = -1;
-        }
-
-        return;
-    }
+retry:
+    prv_downlink_retry();
 }
 #endif /* if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER ) */
 
@@ -434,6 +657,7 @@ wait_and_retry:
 ******************************************************************************/
 int main( void )
 {
+    const struct nce_retry_config retry_config = NCE_RETRY_CONFIG_DEFAULT;
     int err;
 
     #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
@@ -474,21 +698,26 @@ int main( void )
     }
     #endif
     LOG_INF( "1NCE UDP sample started" );
+    /* Uplink and downlink run as callbacks of the single network I/O thread */
+    nce_retry_init( &uplink_retry, "uplink", &retry_config, prv_uplink_retry_resume );
+    nce_net_io_timer_init( &uplink_timer, prv_uplink_timer_fn );
+    nce_net_io_timer_start( &uplink_timer, K_NO_WAIT );
+    #if defined( CONFIG_NCE_RADIO_SCHED )
+    uplink_radio_listener.window = prv_uplink_radio_listener_cb;
+    nce_radio_sched_listen( &uplink_radio_listener );
+    #endif /* if defined( CONFIG_NCE_RADIO_SCHED ) */
     #if defined( CONFIG_NCE_ENABLE_DEVICE_CONTROLLER )
-    k_tid_t downlink_tid = k_thread_create( &downlink_thread, downlink_thread_stack,
-                                            K_THREAD_STACK_SIZEOF( downlink_thread_stack ),
-                                            downlink_thread_fn,
-                                            NULL, NULL, NULL,
-                                            THREAD_PRIORITY, 0, K_NO_WAIT );
-    k_thread_name_set( downlink_tid, "downlink_thread" );
+    nce_retry_init( &downlink_retry, "downlink", &retry_config, prv_downlink_retry_resume );
+    nce_net_io_timer_init( &downlink_timer, prv_downlink_timer_fn );
+    nce_net_io_timer_start( &downlink_timer, K_NO_WAIT );
     #endif
-    k_tid_t uplink_tid = k_thread_create( &uplink_thread, uplink_thread_stack,
-                                          K_THREAD_STACK_SIZEOF( uplink_thread_stack ),
-                                          uplink_thread_fn,
-                                          NULL, NULL, NULL,
-                                          THREAD_PRIORITY, 0, K_NO_WAIT );
-    k_thread_name_set( uplink_tid, "uplink_thread" );
-    /* Delay or wait for the threads to complete */
-    k_sleep( K_SECONDS( 2 ) );
+    err = nce_net_io_start();
+
+    if( err )
+    {
+        LOG_ERR( "Failed to start the network I/O thread: %d", err );
+        return err;
+    }
+
     return 0;
 }
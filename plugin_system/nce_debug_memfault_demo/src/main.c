@@ -35,6 +35,9 @@
 #include <nce_iot_c_sdk.h>
 #include <network_interface_zephyr.h>
 #include <memfault_interface_zephyr.h>
+#if defined( CONFIG_NCE_BOOT_PROFILE )
+    #include <nce_boot_profile.h>
+#endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
 
 
 #if defined( CONFIG_NCE_MEMFAULT_DEMO_ENABLE_DTLS )
@@ -433,8 +436,13 @@ int store_credentials( void )
 /**
  * @brief Onboard the device by managing DTLS credentials.
  *
+ * New credentials are written with LTE offline, then the modem reattaches
+ * without a reboot. The device only reboots if the modem cannot be brought
+ * back online.
+ *
  * @param[in] overwrite Whether to overwrite existing credentials, should be set to true when DTLS connecting is failing.
- * @return 0 on success, negative error code on failure.
+ * @return 0 on success, -EINPROGRESS if new credentials were stored and the
+ *         modem reattaches, negative error code on failure.
  */
 static int prv_onboard_device( bool overwrite )
 {
@@ -484,9 +492,18 @@ static int prv_onboard_device( bool overwrite )
             return err;
         }
 
-        LOG_INF( "Rebooting to ensure changes take effect after saving credentials.." );
+        /* New sockets pick up the new PSK, reattaching is enough */
+        LOG_INF( "Credentials stored, reattaching to the network" );
+        err = lte_lc_normal();
+
+        if( err )
+        {
+            LOG_ERR( "Failed to reattach, err %d, rebooting", err );
+            sys_arch_reboot( 0 );
+        }
 
-        sys_arch_reboot( 0 );
+        /* on_connect() runs again once the registration is back */
+        return -EINPROGRESS;
     }
     else
     {
@@ -504,7 +521,7 @@ static int prv_handle_dtls_failure( void )
     /* Onboard the device with overwrtiting enabled */
     err = prv_onboard_device( true );
 
-    if( err )
+    if( err && ( err != -EINPROGRESS ) )
     {
         LOG_ERR( "Device onboarding failed, err %d\n", err );
     }
@@ -553,6 +570,9 @@ static void prv_handle_memfault_send_result( int res )
     {
         LOG_INF( "Successfully synchronized Memfault data via 1NCE CoAP Proxy\n\n" );
         LOG_INF( "SYNC_SUCCESS" );
+        #if defined( CONFIG_NCE_BOOT_PROFILE )
+        nce_boot_profile_mark( NCE_BOOT_PHASE_FIRST_UPLINK );
+        #endif /* if defined( CONFIG_NCE_BOOT_PROFILE ) */
         #if defined( CONFIG_NCE_MEMFAULT_DEMO_COAP_SYNC_METRICS )
         MEMFAULT_METRIC_ADD( sync_memfault_successful, 1 );
         #endif
@@ -639,6 +659,12 @@ static void on_connect( void )
     /* Onboard the device */
     int err = prv_onboard_device( false );
 
+    if( err == -EINPROGRESS )
+    {
+        LOG_INF( "Continuing after the reattach" );
+        return;
+    }
+
     if( err )
     {
         LOG_ERR( "Device onboarding failed, err %d\n", err );
@@ -31,8 +31,15 @@
 #include "update.h"
 #include "nce_mender_client.h"
 #include "led_control.h"
+#include <nce_coap_buf_pool.h>
+#include <nce_retry.h>
 #include <zephyr/logging/log.h>
 
+#if defined( CONFIG_NCE_COAP_RTO )
+    #include <nce_coap_rto.h>
+    #include <zephyr/random/random.h>
+#endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+
 #if defined( CONFIG_NCE_ENABLE_DTLS )
     #include <modem/modem_key_mgmt.h>
     #include <nrf_modem_at.h>
@@ -46,6 +53,15 @@ LOG_MODULE_REGISTER( NCE_MENDER_DEMO, CONFIG_LOG_DEFAULT_LEVEL );
 #define DEPLOYMENT_ID           1
 #define ARTIFACT_NAME_ID        2
 
+#if defined( CONFIG_COAP_ACK_RANDOM_PERCENT )
+    #define ACK_RANDOM_PERCENT    CONFIG_COAP_ACK_RANDOM_PERCENT
+#else
+    #define ACK_RANDOM_PERCENT    150 /* RFC 7252 ACK_RANDOM_FACTOR */
+#endif /* if defined( CONFIG_COAP_ACK_RANDOM_PERCENT ) */
+
+BUILD_ASSERT( NCE_COAP_BUF_SIZE >= MAX_COAP_MSG_LEN,
+              "CONFIG_NCE_COAP_BUF_POOL_BLOCK_SIZE is smaller than a Mender CoAP request" );
+
 #if defined( CONFIG_BOARD_THINGY91_NRF9160_NS )
     #define NVS_PARTITION       custom_nvs_storage
 #else
@@ -76,6 +92,10 @@ struct addrinfo hints =
 };
 
 static struct k_work_delayable nce_mender_work;
+static struct nce_retry mender_retry;
+#if defined( CONFIG_NCE_COAP_RTO )
+static struct nce_coap_rto mender_rto;
+#endif /* if defined( CONFIG_NCE_COAP_RTO ) */
 
 struct coap_packet response, request;
 
@@ -157,8 +177,8 @@ static int connect_to_coap_server( int sock,
                                    char * hostname,
                                    int port );
 static void print_coap_payload( struct coap_packet * packet );
-static uint8_t handle_confirmable_response( int sock,
-                                            struct coap_packet * response );
+static int handle_confirmable_response( int sock,
+                                        struct coap_packet * response );
 static void nce_mender_work_fn( struct k_work * work );
 /* Mender communication via 1NCE CoAP Proxy */
 static int nce_mender_auth( int fd,
@@ -381,6 +401,59 @@ static int connect_to_coap_server( int fd,
     return 0;
 }
 
+#if defined( CONFIG_NCE_COAP_RTO )
+/* Retransmit a CON request until its response is readable, with the timeouts of mender_rto */
+static int coap_await_response( int fd,
+                                const struct coap_packet * request )
+{
+    struct coap_transmission_parameters params;
+    struct zsock_pollfd pfd =
+    {
+        .fd     = fd,
+        .events = ZSOCK_POLLIN,
+    };
+    uint32_t sent_ms = k_uptime_get_32();
+    uint32_t timeout_ms;
+    int r;
+
+    nce_coap_rto_params( &mender_rto, &params );
+
+    /* Dither the first timeout within the ACK random factor, as the CoAP client does */
+    timeout_ms = params.ack_timeout +
+                 sys_rand32_get() % ( params.ack_timeout * ( ACK_RANDOM_PERCENT - 100 ) / 100 + 1 );
+
+    for( int retransmission = 0; ; retransmission++ )
+    {
+        r = zsock_poll( &pfd, 1, timeout_ms );
+
+        if( r > 0 )
+        {
+            nce_coap_rto_sample( &mender_rto, &params, k_uptime_get_32() - sent_ms );
+            return 0;
+        }
+
+        if( r < 0 )
+        {
+            return -errno;
+        }
+
+        if( retransmission == params.max_retransmission )
+        {
+            return -ETIMEDOUT;
+        }
+
+        LOG_WRN( "No CoAP response after %u ms, retransmitting", timeout_ms );
+
+        if( zsock_send( fd, request->data, request->offset, 0 ) < 0 )
+        {
+            return -errno;
+        }
+
+        timeout_ms = timeout_ms * params.coap_backoff_percent / 100;
+    }
+}
+#endif /* if defined( CONFIG_NCE_COAP_RTO ) */
+
 /* Send a CoAP request using the connected socket */
 static int coap_request( int fd,
                          struct coap_packet request,
@@ -396,11 +469,11 @@ static int coap_request( int fd,
     /* Implementation for CoAP request */
     uint8_t * data;
 
-    data = ( uint8_t * ) k_malloc( MAX_COAP_MSG_LEN );
+    data = nce_coap_buf_alloc( K_NO_WAIT );
 
     if( !data )
     {
-        LOG_ERR( "Memory allocation for CoAP buffer failed" );
+        LOG_ERR( "No CoAP buffer available" );
         return -ENOMEM;
     }
 
@@ -480,8 +553,18 @@ static int coap_request( int fd,
     }
 
     LOG_DBG( "CoAP request sent successfully" );
+
+    #if defined( CONFIG_NCE_COAP_RTO )
+    /* Keeps the request for retransmissions, handle_confirmable_response() reads the response */
+    r = coap_await_response( fd, &request );
+
+    if( r < 0 )
+    {
+        LOG_ERR( "No CoAP response received (err: %d)", r );
+    }
+    #endif /* if defined( CONFIG_NCE_COAP_RTO ) */
 end:
-    k_free( data );
+    nce_coap_buf_free( data );
     return r;
 }
 
@@ -526,9 +609,9 @@ static void print_coap_payload( struct coap_packet * packet )
     free( filename1 );
 }
 
-/* Handle the confirmable CoAP response received from the connected socket */
-static uint8_t handle_confirmable_response( int sock,
-                                            struct coap_packet * response )
+/* Handle the confirmable CoAP response received from the connected socket, negative error code if none arrived */
+static int handle_confirmable_response( int sock,
+                                        struct coap_packet * response )
 {
     uint8_t buffer[ MAX_COAP_MSG_LEN ];
     uint8_t response_code = 0;
@@ -537,7 +620,7 @@ static uint8_t handle_confirmable_response( int sock,
     if( bytes_received <= 0 )
     {
         LOG_WRN( "No CoAP response received from server" );
-        return 0;
+        return ( bytes_received < 0 ) ? -errno : -ENODATA;
     }
     else
     {
@@ -709,10 +792,18 @@ static int nce_mender_report_status( int fd,
     return response_code;
 }
 
+/* Network is back after the Mender requests paused or gave up */
+static void nce_mender_retry_resume( struct nce_retry * retry )
+{
+    k_work_reschedule( &nce_mender_work, nce_retry_resume( retry ) );
+}
+
 /* Communicate with Mender using 1NCE CoAP proxy and update/handle device status */
 static void nce_mender_work_fn( struct k_work * work )
 {
     int response_code = 0;
+    bool cycle_done = false;
+    k_timeout_t delay = K_SECONDS( WORK_DELAY_SECONDS );
 
     if( device_status == UNAUTHORIZED )
     {
@@ -721,23 +812,13 @@ static void nce_mender_work_fn( struct k_work * work )
         response_code = nce_mender_auth( mender_socket, request, &response );
     }
 
-    if( response_code < 0 )
-    {
-        LOG_ERR( "CoAP error occurred during communication (err: %d)", err );
-    }
-    else
+    if( response_code >= 0 )
     {
         switch( device_status )
         {
             case UNAUTHORIZED:
-
-                if( response_code != COAP_RESPONSE_CODE_CONTENT )
-                {
-                    LOG_WRN( "Device is still unauthorized. Awaiting approval in your Mender UI..." );
-                    k_work_schedule( &nce_mender_work,
-                                     K_SECONDS( CONFIG_MENDER_AUTH_CHECK_FREQUENCY_SECONDS ) );
-                }
-
+                LOG_WRN( "Device is still unauthorized. Awaiting approval in your Mender UI..." );
+                delay = K_SECONDS( CONFIG_MENDER_AUTH_CHECK_FREQUENCY_SECONDS );
                 break;
 
             case AUTHORIZED:
@@ -745,21 +826,19 @@ static void nce_mender_work_fn( struct k_work * work )
                 LOG_INF( "Device is authorized. Sending inventory update..." );
                 response_code = nce_mender_update_inventory( mender_socket, request, &response );
 
-                if( response_code != COAP_RESPONSE_CODE_UNAUTHORIZED )
+                if( ( response_code >= 0 ) && ( response_code != COAP_RESPONSE_CODE_UNAUTHORIZED ) )
                 {
                     device_status = INV_UPDATED;
                 }
 
-                k_work_schedule( &nce_mender_work,
-                                 K_SECONDS( WORK_DELAY_SECONDS ) );
                 break;
 
             case INV_UPDATED:
-                /* Check for updates */
+                /* Check for updates, the end of a cycle */
                 LOG_INF( "Inventory updated. Checking for firmware updates..." );
                 response_code = nce_mender_check_for_updates( mender_socket, request, &response );
-                k_work_schedule( &nce_mender_work,
-                                 K_SECONDS( CONFIG_MENDER_FW_UPDATE_CHECK_FREQUENCY_SECONDS ) );
+                cycle_done = true;
+                delay = K_SECONDS( CONFIG_MENDER_FW_UPDATE_CHECK_FREQUENCY_SECONDS );
                 break;
 
             case UPDATE_AVAILABLE:
@@ -768,14 +847,10 @@ static void nce_mender_work_fn( struct k_work * work )
                 fota_start();
                 /* Report Downloading status to Mender */
                 response_code = nce_mender_report_status( mender_socket, request, &response, STATUS_DOWNLOADING, false );
-                k_work_schedule( &nce_mender_work,
-                                 K_SECONDS( WORK_DELAY_SECONDS ) );
                 break;
 
             case UPDATE_DOWNLOADING:
                 LOG_DBG( "Firmware download in progress..." );
-                k_work_schedule( &nce_mender_work,
-                                 K_SECONDS( WORK_DELAY_SECONDS ) );
                 break;
 
             case UPDATE_FAILED:
@@ -786,21 +861,38 @@ static void nce_mender_work_fn( struct k_work * work )
                 k_sleep( K_SECONDS( 10 ) );
                 device_status = INV_UPDATED;
                 long_led_pattern( LED_IDLE );
-                k_work_schedule( &nce_mender_work,
-                                 K_SECONDS( WORK_DELAY_SECONDS ) );
                 break;
 
             case UPDATE_DOWNLOADED:
                 LOG_INF( "Firmware update downloaded. Awaiting installation..." );
-                k_work_schedule( &nce_mender_work, K_SECONDS( WORK_DELAY_SECONDS ) );
                 break;
 
             default:
                 LOG_INF( "Device status idle or in transition. Continuing monitoring..." );
-                k_work_schedule( &nce_mender_work, K_SECONDS( WORK_DELAY_SECONDS ) );
                 break;
         }
     }
+
+    if( response_code < 0 )
+    {
+        LOG_ERR( "CoAP error occurred during communication (err: %d)", response_code );
+
+        /* Back off and try again, or wait for the network to come back */
+        if( nce_retry_failed( &mender_retry, &delay ) == 0 )
+        {
+            k_work_schedule( &nce_mender_work, delay );
+        }
+
+        return;
+    }
+
+    /* Only a full cycle up to the update check counts as success */
+    if( cycle_done )
+    {
+        nce_retry_succeeded( &mender_retry );
+    }
+
+    k_work_schedule( &nce_mender_work, delay );
 }
 
 /* Connect to Mender via 1NCE CoAP proxy using DTLS and check active deployment status from NVS (if exists)  */
@@ -859,6 +951,7 @@ void nce_mender_application()
 /* Initialize and start the application */
 int fota_init( struct fota_init_params * params )
 {
+    const struct nce_retry_config retry_config = NCE_RETRY_CONFIG_DEFAULT;
     int err;
 
     struct flash_pages_info info;
@@ -907,6 +1000,10 @@ int fota_init( struct fota_init_params * params )
 
     k_work_init_delayable( &nce_mender_work,
                            nce_mender_work_fn );
+    nce_retry_init( &mender_retry, "mender", &retry_config, nce_mender_retry_resume );
+    #if defined( CONFIG_NCE_COAP_RTO )
+    nce_coap_rto_init( &mender_rto, "mender" );
+    #endif /* if defined( CONFIG_NCE_COAP_RTO ) */
     update_start = params->update_start;
 
     LOG_INF( "Initializing modem and network connection..." );
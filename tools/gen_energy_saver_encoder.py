@@ -0,0 +1,356 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 1NCE GmbH 2026
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+#
+"""Generate a specialized Energy Saver encoder from a 1NCE OS translation template.
+
+The template is the same JSON document that is uploaded to the 1NCE OS portal.
+For every `case` of the template (or for the whole template if it has no
+`switch`), a C header is generated with:
+
+  - offset/length macros for every field,
+  - a value struct holding the typed field values,
+  - a packed wire struct whose layout is checked with BUILD_ASSERT against
+    the offset macros,
+  - an inline, branch-free encoder writing every field through the wire
+    struct with compile-time lengths and byte order.
+
+Any inconsistency (unknown type, overlapping fields, missing byte order on a
+multi-byte number, ...) fails the build, so the device encoder cannot drift
+away from the template used to decode it in the cloud.
+"""
+
+import argparse
+import json
+import os
+import re
+import sys
+
+INT_TYPES = ("int", "integer")
+UINT_TYPES = ("uint", "unsigned")
+FLOAT_TYPES = ("float", "double")
+BOOL_TYPES = ("bool", "boolean")
+STRING_TYPES = ("string",)
+
+
+class TemplateError(Exception):
+    pass
+
+
+def c_identifier(name):
+    ident = re.sub(r"[^0-9a-zA-Z]+", "_", str(name)).strip("_").lower()
+
+    if not ident:
+        raise TemplateError(f"cannot derive a C identifier from '{name}'")
+
+    if ident[0].isdigit():
+        ident = "f_" + ident
+
+    return ident
+
+
+def c_uint_type(length):
+    for bits in (8, 16, 32, 64):
+        if length * 8 <= bits:
+            return f"uint{bits}_t"
+
+    raise TemplateError(f"numeric fields are limited to 8 bytes, got {length}")
+
+
+def c_int_type(length):
+    return c_uint_type(length)[1:]
+
+
+class Field:
+    def __init__(self, name, spec, where):
+        try:
+            self.offset = int(spec["byte"])
+            self.length = int(spec["bytelength"])
+            self.type = str(spec["type"]).lower()
+        except (KeyError, TypeError, ValueError) as e:
+            raise TemplateError(f"{where}: incomplete field description ({e})")
+
+        self.name = name
+        self.byteorder = spec.get("byteorder")
+
+        if self.offset < 0 or self.length <= 0:
+            raise TemplateError(f"{where}: invalid byte/bytelength")
+
+        if self.type in INT_TYPES + UINT_TYPES + BOOL_TYPES:
+            if self.length > 8:
+                raise TemplateError(f"{where}: numeric fields are limited to 8 bytes")
+        elif self.type in FLOAT_TYPES:
+            if self.length not in (4, 8):
+                raise TemplateError(f"{where}: floating point fields must be 4 or 8 bytes")
+        elif self.type not in STRING_TYPES:
+            raise TemplateError(f"{where}: unsupported type '{self.type}'")
+
+        if self.type not in STRING_TYPES and self.length > 1:
+            if self.byteorder not in ("little", "big"):
+                raise TemplateError(f"{where}: multi-byte numbers need byteorder 'little' or 'big'")
+
+    @property
+    def end(self):
+        return self.offset + self.length
+
+    def c_member(self):
+        if self.type in STRING_TYPES:
+            return f"char {self.name}[ {self.length} ];"
+
+        if self.type in FLOAT_TYPES:
+            return f"{'float' if self.length == 4 else 'double'} {self.name};"
+
+        if self.type in INT_TYPES:
+            return f"{c_int_type(self.length)} {self.name};"
+
+        if self.type in BOOL_TYPES:
+            return f"bool {self.name};"
+
+        return f"{c_uint_type(self.length)} {self.name};"
+
+    def c_stores(self, value):
+        """Return C statements writing `value` into the field of the wire struct."""
+        member = f"wire->{self.name}"
+
+        if self.type in STRING_TYPES:
+            return [f"memcpy( {member}, {value}, sizeof( {member} ) );"]
+
+        raw_type = c_uint_type(self.length)
+        stmts = []
+
+        if self.type in FLOAT_TYPES:
+            stmts.append(f"{raw_type} {self.name}_raw;")
+            stmts.append(f"memcpy( &{self.name}_raw, &{value}, sizeof( {self.name}_raw ) );")
+            raw = f"{self.name}_raw"
+        else:
+            raw = f"( {raw_type} ) {value}"
+
+        for i in range(self.length):
+            shift = 8 * (i if self.byteorder != "big" else self.length - 1 - i)
+            expr = f"( {raw} )" if shift == 0 else f"( ( {raw} ) >> {shift} )"
+            stmts.append(f"{member}[ {i} ] = ( uint8_t ) {expr};")
+
+        return stmts
+
+
+class Layout:
+    def __init__(self, name, comment, case_value, switch, fields):
+        self.name = name
+        self.comment = comment
+        self.case_value = case_value
+        self.switch = switch
+        self.fields = fields
+
+        placed = sorted(([switch] if switch else []) + fields, key=lambda f: f.offset)
+
+        for a, b in zip(placed, placed[1:]):
+            if b.offset < a.end:
+                raise TemplateError(f"{name}: fields '{a.name}' and '{b.name}' overlap")
+
+        self.placed = placed
+        self.size = max(f.end for f in placed)
+
+
+def parse_fields(actions, where):
+    fields = []
+    seen = set()
+
+    for action in actions:
+        value = action.get("value")
+
+        if not isinstance(value, dict):
+            # Constant assets are added by the cloud and are not on the wire
+            continue
+
+        name = c_identifier(action.get("asset", ""))
+
+        if name in seen:
+            raise TemplateError(f"{where}: duplicate asset '{name}'")
+
+        seen.add(name)
+        fields.append(Field(name, value, f"{where}/{name}"))
+
+    if not fields:
+        raise TemplateError(f"{where}: no fields on the wire")
+
+    return fields
+
+
+def parse_template(template):
+    layouts = []
+
+    for index, sense in enumerate(template.get("sense", [])):
+        if "switch" in sense:
+            switch = Field("id", sense["switch"], f"sense[{index}]/switch")
+
+            if switch.type not in INT_TYPES + UINT_TYPES:
+                raise TemplateError(f"sense[{index}]/switch: must be an integer")
+
+            for case in sense.get("on", []):
+                case_value = int(case["case"])
+                comment = case.get("comment", f"case {case_value}")
+                name = c_identifier(case.get("comment", f"case_{case_value}"))
+                fields = parse_fields(case.get("do", []), f"case {case_value}")
+                layouts.append(Layout(name, comment, case_value, switch, fields))
+        else:
+            fields = parse_fields([sense], f"sense[{index}]")
+
+            if layouts and layouts[-1].switch is None:
+                # Flat templates list one asset per sense entry
+                prev = layouts.pop()
+                fields = prev.fields + fields
+
+            layouts.append(Layout("record", "record", None, None, fields))
+
+    if not layouts:
+        raise TemplateError("template has no 'sense' entries")
+
+    names = [layout.name for layout in layouts]
+
+    if len(names) != len(set(names)):
+        raise TemplateError("case comments must be unique to name the generated encoders")
+
+    return layouts
+
+
+def generate(layouts, template_path):
+    out = []
+    guard = "NCE_ENERGY_SAVER_TEMPLATE_H__"
+    w = out.append
+
+    w("/******************************************************************************")
+    w(" * @file    nce_energy_saver_template.h")
+    w(" * @brief   Energy Saver encoder specialized for the translation template.")
+    w(f" * @details Generated by tools/gen_energy_saver_encoder.py from")
+    w(f" *          {os.path.basename(os.path.dirname(template_path))}/{os.path.basename(template_path)}. Do not edit.")
+    w(" ******************************************************************************/")
+    w("")
+    w(f"#ifndef {guard}")
+    w(f"#define {guard}")
+    w("")
+    w("#include <stdbool.h>")
+    w("#include <stddef.h>")
+    w("#include <stdint.h>")
+    w("#include <string.h>")
+    w("#include <zephyr/sys/util.h>")
+    w("#include <zephyr/toolchain.h>")
+
+    for layout in layouts:
+        prefix = f"NCE_ES_{layout.name.upper()}"
+        struct = f"nce_es_{layout.name}"
+        w("")
+        w(f"/* {layout.comment} */")
+
+        if layout.case_value is not None:
+            w(f"#define {prefix}_ID    {layout.case_value}")
+
+        w(f"#define {prefix}_SIZE    {layout.size}")
+
+        for f in layout.fields:
+            w(f"#define {prefix}_{f.name.upper()}_OFFSET    {f.offset}")
+            w(f"#define {prefix}_{f.name.upper()}_LEN       {f.length}")
+
+        w("")
+        w(f"/** @brief Field values of the '{layout.comment}' record. */")
+        w(f"struct {struct}")
+        w("{")
+
+        for f in layout.fields:
+            order = f", {f.byteorder} endian" if f.byteorder and f.type not in STRING_TYPES else ""
+            w(f"    {f.c_member()} /**< {f.type}, {f.length} byte(s) at offset {f.offset}{order} */")
+
+        w("};")
+        w("")
+        w(f"/** @brief On-air layout of the '{layout.comment}' record. */")
+        w(f"struct {struct}_wire")
+        w("{")
+
+        cursor = 0
+
+        for f in layout.placed:
+            if f.offset > cursor:
+                w(f"    uint8_t reserved_{cursor}[ {f.offset - cursor} ];")
+
+            w(f"    uint8_t {f.name}[ {f.length} ];")
+            cursor = f.end
+
+        w("} __packed;")
+        w("")
+        w(f"BUILD_ASSERT( sizeof( struct {struct}_wire ) == {prefix}_SIZE );")
+
+        for f in layout.fields:
+            w(f"BUILD_ASSERT( offsetof( struct {struct}_wire, {f.name} ) == {prefix}_{f.name.upper()}_OFFSET );")
+            w(f"BUILD_ASSERT( SIZEOF_FIELD( struct {struct}_wire, {f.name} ) == {prefix}_{f.name.upper()}_LEN );")
+
+        w("")
+        w("/**")
+        w(f" * @brief Encode a '{layout.comment}' record.")
+        w(" *")
+        w(f" * @param[out] buf    Destination, at least {prefix}_SIZE bytes.")
+        w(" * @param[in]  values Field values.")
+        w(" * @return Number of bytes written.")
+        w(" */")
+        w(f"static inline size_t {struct}_encode( uint8_t * buf,")
+        w(f"{' ' * len(f'static inline size_t {struct}_encode( ')}const struct {struct} * values )")
+        w("{")
+        w(f"    struct {struct}_wire * wire = ( struct {struct}_wire * ) buf;")
+        w("")
+
+        cursor = 0
+
+        for f in layout.placed:
+            if f.offset > cursor:
+                w(f"    memset( wire->reserved_{cursor}, 0, sizeof( wire->reserved_{cursor} ) );")
+
+            if f is layout.switch:
+                stmts = f.c_stores(f"{prefix}_ID")
+            else:
+                stmts = f.c_stores(f"values->{f.name}")
+
+            for stmt in stmts:
+                w(f"    {stmt}")
+
+            cursor = f.end
+
+        w("")
+        w(f"    return sizeof( *wire );")
+        w("}")
+
+    w("")
+    w(f"#endif /* {guard} */")
+    w("")
+
+    return "\n".join(out)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--template", required=True, help="Energy Saver template JSON")
+    parser.add_argument("--output", required=True, help="Generated C header")
+    args = parser.parse_args()
+
+    try:
+        with open(args.template, encoding="utf-8") as f:
+            layouts = parse_template(json.load(f))
+    except (OSError, ValueError, TemplateError) as e:
+        sys.exit(f"{args.template}: {e}")
+
+    header = generate(layouts, args.template)
+    os.makedirs(os.path.dirname(os.path.abspath(args.output)), exist_ok=True)
+
+    # Only touch the output when it changes to avoid needless rebuilds
+    try:
+        with open(args.output, encoding="utf-8") as f:
+            if f.read() == header:
+                return
+    except OSError:
+        pass
+
+    with open(args.output, "w", encoding="utf-8") as f:
+        f.write(header)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,27 @@
+#
+# Copyright (c) 1NCE GmbH 2026
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+#
+
+# Generate nce_energy_saver_template.h from an Energy Saver translation
+# template and make it available to the application.
+function(nce_energy_saver_codegen template)
+  set(generator ${CMAKE_CURRENT_FUNCTION_LIST_DIR}/gen_energy_saver_encoder.py)
+  set(gen_dir ${CMAKE_CURRENT_BINARY_DIR}/nce_energy_saver)
+  set(gen_header ${gen_dir}/nce_energy_saver_template.h)
+
+  add_custom_command(
+    OUTPUT ${gen_header}
+    COMMAND ${PYTHON_EXECUTABLE} ${generator}
+            --template ${template}
+            --output ${gen_header}
+    DEPENDS ${template} ${generator}
+    COMMENT "Generating Energy Saver encoder from ${template}"
+    VERBATIM
+  )
+
+  add_custom_target(nce_energy_saver_template DEPENDS ${gen_header})
+  add_dependencies(app nce_energy_saver_template)
+  target_include_directories(app PRIVATE ${gen_dir})
+endfunction()